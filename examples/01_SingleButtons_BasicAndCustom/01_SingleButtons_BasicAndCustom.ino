@@ -86,12 +86,13 @@ void customOneButtonDecaClick() { Serial.println("custom one button deca click."
 // cd4067을 쓰는 경우 for문을 돌며 각 버튼들의 반환값을 받아놨다가 한번에 구동할 수도 있겠고.
 // 버튼 두 개 조합키를 쓰는 경우 조합 동작으로 판정되면 그에 맞는 doIt() 함수를 따로 구동할 수 있다.
 // 원하면 파라미터를 넣어서 쓰자.
-void doIt(int8_t a) {
+// repeat은 MANYPRESS일 때 지난번 이후 지나간 반복 간격 수. button.getRepeatCount()를 넘겨준다.
+void doIt(int8_t a, uint8_t repeat = 1) {
   if (a != NO_ACTION) {
     switch (a) {
       case NO_ACTION: break;
       case LONGPRESS: customOneButtonLongPress(); break;
-      case MANYPRESS: customOneButtonManyPress(); break;
+      case MANYPRESS: for (uint8_t i = 0; i < repeat; i++) customOneButtonManyPress(); break; // 루프가 늦었으면 밀린 반복 횟수만큼.
       case CLICK: customOneButtonClick(); break;
       case DOUBLECLICK: customOneButtonDoubleClick(); break;
         // case TRIPLECLICK: customOneButtonTripleClick(); break;
@@ -149,6 +150,9 @@ void setup() {
   // button1.onNonaClick = oneButtonNonaClick;
   // button1.onDecaClick = oneButtonDecaClick;
 
+  // 연속 누름 가속. 누르고 있을수록 반복 간격이 MANY_REPRESS_TIME에서 5ms까지 2초 동안 점점 짧아진다.
+  // button1.setManyPressAcceleration(5, 2000);
+
   // button2.onLongPress = oneButtonLongPress;
   // button2.onManyPress = oneButtonManyPress;
   // button2.onClick = oneButtonClick;
@@ -188,8 +192,10 @@ void buttonCheckAndExecute() {
     event1 = button1.event(); // 버튼1의 이벤트 감지.
     event2 = button2.event(); // 버튼2의 이벤트 감지.
 
-    if(event1) { button1.doIt(event1); } // 버튼1의 이벤트에 따른 등록된 기본 동작 수행.
-    if(event2) { doIt(event2); } // 버튼2의 이벤트에 따른 커스텀 동작 수행.
+    // MANYPRESS는 지난번 이후 반복 간격이 몇 번 지나갔는지를 getRepeatCount()로 함께 알려준다.
+    // 이렇게 넘겨주면 루프가 느리게 돌아도 반복 동작이 그 횟수만큼 정확히 수행된다. 그냥 button1.doIt(event1);은 한 번만 수행.
+    if(event1) { button1.doIt(event1, button1.getRepeatCount()); } // 버튼1의 이벤트에 따른 등록된 기본 동작 수행.
+    if(event2) { doIt(event2, button2.getRepeatCount()); } // 버튼2의 이벤트에 따른 커스텀 동작 수행.
   }
 }
 
@@ -103,12 +103,13 @@ void customOneButtonDecaClick() { Serial.println("custom one button deca click."
 // cd4067을 쓰는 경우 for문을 돌며 각 버튼들의 반환값을 받아놨다가 한번에 구동할 수도 있겠고.
 // 버튼 두 개 조합키를 쓰는 경우 조합 동작으로 판정되면 그에 맞는 doIt() 함수를 따로 구동할 수 있다.
 // 원하면 파라미터를 넣어서 쓰자.
-void doIt(int8_t a) {
+// repeat은 MANYPRESS일 때 지난번 이후 지나간 반복 간격 수. button.getRepeatCount()를 넘겨준다.
+void doIt(int8_t a, uint8_t repeat = 1) {
   if (a != NO_ACTION) {
     switch (a) {
       case NO_ACTION: break;
       case LONGPRESS: customOneButtonLongPress(); break;
-      case MANYPRESS: customOneButtonManyPress(); break;
+      case MANYPRESS: for (uint8_t i = 0; i < repeat; i++) customOneButtonManyPress(); break; // 루프가 늦었으면 밀린 반복 횟수만큼.
       case CLICK: customOneButtonClick(); break;
       case DOUBLECLICK: customOneButtonDoubleClick(); break;
         // case TRIPLECLICK: customOneButtonTripleClick(); break;
@@ -144,14 +145,14 @@ void customTwoButtonDecaClick() { Serial.println("custom two button deca click."
 // 각 버튼들의 독립 동작 수행은 버튼마다 button.doIt()이든 doIt()이든 각각 별개의 구동 함수를 통해서 처리한다.
 // 원하면 파라미터를 넣어서 쓰자.
 
-// comboDoIt(event); 이런 식으로 쓴다.
-void comboDoIt(int8_t a) {
+// comboDoIt(event, combo.getRepeatCount(2)); 이런 식으로 쓴다.
+void comboDoIt(int8_t a, uint8_t repeat = 1) {
   // Serial.println(a); // 디버깅.. 이 함수가 실행은 되었는지, 어느 액션 번호를 받았는지 확인.
   if (a != NO_ACTION) { // <= 이거 생각보다 중요할 수 있으니 지우지 않는 게 좋음. if(a)라고 해도 되지만 이게 조금 더 명시적이어서 이렇게 해놓음.
     switch (a) {
       case NO_ACTION: break;
       case LONGPRESS: customTwoButtonLongPress(); break;
-      case MANYPRESS: customTwoButtonManyPress(); break;
+      case MANYPRESS: for (uint8_t i = 0; i < repeat; i++) customTwoButtonManyPress(); break; // 루프가 늦었으면 밀린 반복 횟수만큼.
       case CLICK: customTwoButtonClick(); break;
       case DOUBLECLICK: customTwoButtonDoubleClick(); break;
         // case TRIPLECLICK: customTwoButtonTripleClick(); break;
@@ -272,18 +273,18 @@ void buttonCheckAndExecute() {
     int8_t* events2 = buttonCombo2.event(); // 전체 이벤트 감지.
 
     // 독립 동작 판정시 버튼1 독립 동작 수행.
-    if(events1[0]) { buttonCombo1.getBt1().doIt(events1[0]); } // 등록된 기본 독립 동작 수행.
+    if(events1[0]) { buttonCombo1.getBt1().doIt(events1[0], buttonCombo1.getRepeatCount(0)); } // 등록된 기본 독립 동작 수행.
     // 독립 동작 판정시 버튼2 독립 동작 수행.
-    if(events1[1]) { buttonCombo1.getBt2().doIt(events1[1]); } // 등록된 기본 독립 동작 수행.
+    if(events1[1]) { buttonCombo1.getBt2().doIt(events1[1], buttonCombo1.getRepeatCount(1)); } // 등록된 기본 독립 동작 수행.
     // 두 버튼 조합 동작 판정시 버튼1, 버튼2 두 버튼 조합 동작 수행.
-    if(events1[2]) { buttonCombo1.doIt(events1[2]); } // 등록된 기본 조합 동작 수행.
+    if(events1[2]) { buttonCombo1.doIt(events1[2], buttonCombo1.getRepeatCount(2)); } // 등록된 기본 조합 동작 수행.
 
     // 독립 동작 판정시 버튼3 독립 동작 수행.
-    if(events2[0]) { doIt(events2[0]); } // 커스텀 동작 수행.
+    if(events2[0]) { doIt(events2[0], buttonCombo2.getRepeatCount(0)); } // 커스텀 동작 수행.
     // 독립 동작 판정시 버튼4 독립 동작 수행.
-    if(events2[1]) { doIt(events2[1]); } // 커스텀 동작 수행.
+    if(events2[1]) { doIt(events2[1], buttonCombo2.getRepeatCount(1)); } // 커스텀 동작 수행.
     // 두 버튼 조합 동작 판정시 버튼3, 버튼4 두 버튼 조합 동작 수행.
-    if(events2[2]) { comboDoIt(events2[2]); } // 커스텀 동작 수행.
+    if(events2[2]) { comboDoIt(events2[2], buttonCombo2.getRepeatCount(2)); } // 커스텀 동작 수행.
   }
 }
 
@@ -127,12 +127,13 @@ void customOneButtonDecaClick() { Serial.println("custom one button deca click."
 // cd4067을 쓰는 경우 for문을 돌며 각 버튼들의 반환값을 받아놨다가 한번에 구동할 수도 있겠고.
 // 버튼 두 개 조합키를 쓰는 경우 조합 동작으로 판정되면 그에 맞는 doIt() 함수를 따로 구동할 수 있다.
 // 원하면 파라미터를 넣어서 쓰자.
-void doIt(int8_t a) {
+// repeat은 MANYPRESS일 때 지난번 이후 지나간 반복 간격 수. button.getRepeatCount()를 넘겨준다.
+void doIt(int8_t a, uint8_t repeat = 1) {
   if (a != NO_ACTION) {
     switch (a) {
       case NO_ACTION: break;
       case LONGPRESS: customOneButtonLongPress(); break;
-      case MANYPRESS: customOneButtonManyPress(); break;
+      case MANYPRESS: for (uint8_t i = 0; i < repeat; i++) customOneButtonManyPress(); break; // 루프가 늦었으면 밀린 반복 횟수만큼.
       case CLICK: customOneButtonClick(); break;
       case DOUBLECLICK: customOneButtonDoubleClick(); break;
         // case TRIPLECLICK: customOneButtonTripleClick(); break;
@@ -168,14 +169,14 @@ void customTwoButtonDecaClick() { Serial.println("custom two button deca click."
 // 각 버튼들의 독립 동작 수행은 버튼마다 button.doIt()이든 doIt()이든 각각 별개의 구동 함수를 통해서 처리한다.
 // 원하면 파라미터를 넣어서 쓰자.
 
-// comboDoIt(event); 이런 식으로 쓴다.
-void comboDoIt(int8_t a) {
+// comboDoIt(event, combo.getRepeatCount(2)); 이런 식으로 쓴다.
+void comboDoIt(int8_t a, uint8_t repeat = 1) {
   // Serial.println(a); // 디버깅.. 이 함수가 실행은 되었는지, 어느 액션 번호를 받았는지 확인.
   if (a != NO_ACTION) { // <= 이거 생각보다 중요할 수 있으니 지우지 않는 게 좋음. if(a)라고 해도 되지만 이게 조금 더 명시적이어서 이렇게 해놓음.
     switch (a) {
       case NO_ACTION: break;
       case LONGPRESS: customTwoButtonLongPress(); break;
-      case MANYPRESS: customTwoButtonManyPress(); break;
+      case MANYPRESS: for (uint8_t i = 0; i < repeat; i++) customTwoButtonManyPress(); break; // 루프가 늦었으면 밀린 반복 횟수만큼.
       case CLICK: customTwoButtonClick(); break;
       case DOUBLECLICK: customTwoButtonDoubleClick(); break;
         // case TRIPLECLICK: customTwoButtonTripleClick(); break;
@@ -294,6 +295,13 @@ int8_t event_4067_2[16] = {
   NO_ACTION, NO_ACTION, NO_ACTION, NO_ACTION, NO_ACTION, NO_ACTION, NO_ACTION, NO_ACTION
 };
 
+// 버튼이 많아서 한 번에 다 훑으면 loop()가 오래 멈춘다면, BankScheduler로 나눠서 돌릴 수 있다. (#include "BankScheduler.h")
+// BankScheduler<32> scheduler; // setup()에서 addButton(button_4067_1[i], &mux1, i), addCombo(buttonCombo1) 등으로 등록.
+// scheduler.setPeriod(10); scheduler.setBudget(500); // 10ms마다 한 바퀴, loop() 한 번에 최대 500us.
+// loop()에서는 buttonCheckAndExecute() 대신 scheduler.run();
+// scheduler.setIdlePeriod()로 쉴 때 천천히 훑으려면 누름을 알려줄 공통 INT 선이나 핀 변화 인터럽트(setWakePin(), wake())가 있어야 한다.
+// 이 회로처럼 먹스만 있으면 그런 선이 없으니 idle 주기를 줘도 원래 주기로 돈다. 바퀴로만 찾으면 첫 누름이 늦게 보여서 짧은 클릭이 무효가 될 수 있어서.
+
 void buttonCheckAndExecute() {
   // 2개의 CD74HC4067로 각 채널들에서 이벤트를 감지하고 독립 및 조합 동작 수행.
   if(every(0, 10)){
@@ -308,24 +316,24 @@ void buttonCheckAndExecute() {
         Serial.print("button_4067_1[");
         Serial.print(i);
         Serial.print("] => ");
-        button_4067_1[i].doIt(event_4067_1[i]); // 각 버튼 별 독립 동작 수행.
-        // doIt(event_4067_1[i]); // 각 버튼 별 커스텀 동작 수행.
+        button_4067_1[i].doIt(event_4067_1[i], button_4067_1[i].getRepeatCount()); // 각 버튼 별 독립 동작 수행.
+        // doIt(event_4067_1[i], button_4067_1[i].getRepeatCount()); // 각 버튼 별 커스텀 동작 수행.
       }
     }
 
     // CD74HC4067_1 채널 12, 13은 이벤트를 감지해서 독립 및 조합 동작 수행.
     int8_t* events1 = buttonCombo1.event(); // 전체 이벤트 감지.
 
-    if (events1[0]) { buttonCombo1.getBt1().doIt(events1[0]); } // 등록된 기본 동작 수행.
-    if (events1[1]) { buttonCombo1.getBt2().doIt(events1[1]); } // 등록된 기본 동작 수행.
-    if (events1[2]) { buttonCombo1.doIt(events1[2]); } // 등록된 기본 조합 동작 수행.
+    if (events1[0]) { buttonCombo1.getBt1().doIt(events1[0], buttonCombo1.getRepeatCount(0)); } // 등록된 기본 동작 수행.
+    if (events1[1]) { buttonCombo1.getBt2().doIt(events1[1], buttonCombo1.getRepeatCount(1)); } // 등록된 기본 동작 수행.
+    if (events1[2]) { buttonCombo1.doIt(events1[2], buttonCombo1.getRepeatCount(2)); } // 등록된 기본 조합 동작 수행.
 
     // CD74HC4067_1 채널 14, 15도 이벤트를 감지해서 독립 및 조합 동작 수행.
     int8_t* events2 = buttonCombo2.event(); // 전체 이벤트 감지.
 
-    if (events2[0]) { buttonCombo2.getBt1().doIt(events2[0]); } // 등록된 기본 동작 수행.
-    if (events2[1]) { buttonCombo2.getBt2().doIt(events2[1]); } // 등록된 기본 동작 수행.
-    if (events2[2]) { buttonCombo2.doIt(events2[2]); } // 등록된 기본 조합 동작 수행.
+    if (events2[0]) { buttonCombo2.getBt1().doIt(events2[0], buttonCombo2.getRepeatCount(0)); } // 등록된 기본 동작 수행.
+    if (events2[1]) { buttonCombo2.getBt2().doIt(events2[1], buttonCombo2.getRepeatCount(1)); } // 등록된 기본 동작 수행.
+    if (events2[2]) { buttonCombo2.doIt(events2[2], buttonCombo2.getRepeatCount(2)); } // 등록된 기본 조합 동작 수행.
 
     // CD74HC4067_2 채널 0 ~ 11은 이벤트를 감지해서 각 버튼 독립 동작 수행.
     for (int i = 0; i < 12; i++) {
@@ -338,24 +346,24 @@ void buttonCheckAndExecute() {
         Serial.print("button_4067_2[");
         Serial.print(i);
         Serial.print("] => ");
-        // button_4067_2[i].doIt(event_4067_2[i]); // 각 버튼 별 독립 동작 수행.
-        doIt(event_4067_2[i]); // 각 버튼 별 커스텀 동작 수행.
+        // button_4067_2[i].doIt(event_4067_2[i], button_4067_2[i].getRepeatCount()); // 각 버튼 별 독립 동작 수행.
+        doIt(event_4067_2[i], button_4067_2[i].getRepeatCount()); // 각 버튼 별 커스텀 동작 수행.
       }
     }
 
     // CD74HC4067_2 채널 12, 13은 이벤트를 감지해서 독립 및 조합 동작 수행.
     int8_t* events3 = buttonCombo3.event(); // 전체 이벤트 감지.
 
-    if (events3[0]) { doIt(events3[0]); } // 커스텀 동작 수행.
-    if (events3[1]) { doIt(events3[1]); } // 커스텀 동작 수행.
-    if (events3[2]) { comboDoIt(events3[2]); } // 커스텀 조합 동작 수행.
+    if (events3[0]) { doIt(events3[0], buttonCombo3.getRepeatCount(0)); } // 커스텀 동작 수행.
+    if (events3[1]) { doIt(events3[1], buttonCombo3.getRepeatCount(1)); } // 커스텀 동작 수행.
+    if (events3[2]) { comboDoIt(events3[2], buttonCombo3.getRepeatCount(2)); } // 커스텀 조합 동작 수행.
 
     // CD74HC4067_2 채널 14, 15도 이벤트를 감지해서 독립 및 조합 동작 수행.
     int8_t* events4 = buttonCombo4.event(); // 전체 이벤트 감지.
 
-    if (events4[0]) { doIt(events4[0]); } // 커스텀 동작 수행.
-    if (events4[1]) { doIt(events4[1]); } // 커스텀 동작 수행.
-    if (events4[2]) { comboDoIt(events4[2]); } // 커스텀 조합 동작 수행.
+    if (events4[0]) { doIt(events4[0], buttonCombo4.getRepeatCount(0)); } // 커스텀 동작 수행.
+    if (events4[1]) { doIt(events4[1], buttonCombo4.getRepeatCount(1)); } // 커스텀 동작 수행.
+    if (events4[2]) { comboDoIt(events4[2], buttonCombo4.getRepeatCount(2)); } // 커스텀 조합 동작 수행.
   }
 }
 
@@ -2,7 +2,7 @@
 // - 버튼1, 버튼2, 버튼1과 버튼2 콤보, 이렇게 3가지 패턴 감지를 저장하는 큐를 각각 따로 썼습니다.
 // - 패턴 감지부에서는, 패턴을 감지하면 해당 숫자를 비교적 간단히 UniversalQueue 큐에 저장하거나,
 //   필요 시 큐에 파라미터들을 함께 저장하기 위해서 EventBox 구조체와 MemoryPoolQueue를 사용합니다.
-// - 버튼1의 입력 감지는 큐에 감지된 숫자만 저장하고, 버튼2, 버튼1과 버튼2 콤보 입력 감지는 파라미터를 함께 저장하는 EventBox와 MemoryPoolQueue 방식을 썼습니다.
+// - 버튼1의 입력 감지는 큐에 감지된 숫자와 반복 횟수만 저장하고, 버튼2, 버튼1과 버튼2 콤보 입력 감지는 파라미터를 함께 저장하는 EventBox와 MemoryPoolQueue 방식을 썼습니다.
 // - 패턴에 따른 동작 수행부에서는, 큐에 들어있는 것이 있으면 꺼내서 기본 구동 함수 .doIt()이나 커스텀 구동 함수를 구동합니다.
 // - EventBox와 MemoryPoolQueue 사용 시 queue.allocate()와 queue.free() 관련 프로세스 관리를 확실히 해주는 것이 필요합니다. EventBox를 꺼내 쓴 후에는 반드시 잊지않고 queue.free()를 해주어야 합니다.
 
@@ -10,7 +10,7 @@
 // - Three queues are used separately to store detections for button1, button2, and button1 + button2 combo.
 // - In the pattern detection part, when a pattern is detected, the detected number is simply stored in the UniversalQueue,
 // - or, when parameters need to be stored together in the queue, the EventBox structure and MemoryPoolQueue are used.
-// - Detection of button1 inputs stores only the detected number in the queue, while detection of button2 and button1 + button2 combo inputs uses the EventBox and MemoryPoolQueue method to store parameters together.
+// - Detection of button1 inputs stores only the detected number and its repeat count in the queue, while detection of button2 and button1 + button2 combo inputs uses the EventBox and MemoryPoolQueue method to store parameters together.
 // - In the action execution part, if there is an item in the queue, it is taken out and executed via the built-in .doIt() function or a custom execution function.
 // - When using EventBox and MemoryPoolQueue, it is necessary to reliably manage the processes related to queue.allocate() and queue.free().
 // - After using an EventBox, be sure to call queue.free() without forgetting.
@@ -39,6 +39,7 @@ public:
 // 대신 참조형이라서 당연히 그 안의 값들이 변하면 가져다 쓸 때도 변한 값을 읽게 된다고.
 struct EventBox {
   int8_t action; // 이벤트로 감지한 액션 번호.
+  uint8_t repeat = 1; // MANYPRESS의 반복 횟수. getRepeatCount() 값.
 
   // 선택적 파라미터
   int intParam = 0;
@@ -49,12 +50,25 @@ struct EventBox {
   SimpleClass simpleObj{0};    // 간단한 클래스 객체 가능.
 };
 
+// 파라미터 없이 액션 번호만 넘기면 되고 버튼이 많다면, 큐 대신 ActionNotifier(태스크 알림)를 쓸 수도 있다.
+// 버튼마다 알림 비트 하나로 수행 태스크를 깨우고, 복사나 큐 관리가 없다. 사용법은 UniversalQueue.h의 ActionNotifier 설명 참고.
+// ActionNotifier notifier; // 감지 태스크: notifier.post(0, events[0], buttonCombo.getRepeatCount(0));
+// 핸들러 하나가 오래 걸려서 다른 액션들이 그 뒤에 밀린다면, ActionExecutor로 여러 작업 태스크에 나눠서 수행할 수 있다.
+// 같은 버튼의 액션은 순서대로 수행된다. 사용법은 UniversalQueue.h의 ActionExecutor 설명 참고.
+// ActionExecutor<2> executor(eventQueueSize); // 감지 태스크: executor.dispatch(0, events[0], button1.getRepeatCount());
+
 // 큐의 최대 저장 개수. 큐에는 구조체의 포인터(주소값)만 저장된다.
 // MemoryPool을 생성하는 경우, 이 개수만큼의 용량을 가진, EventBox들의 MemoryPool도 함께 생성된다.
 constexpr size_t eventQueueSize = 10;
-// 큐에 단순 int8_t를 저장하는 거라면 MemoryPool을 쓸 필요가 없다.
+// 액션 번호와 MANYPRESS 반복 횟수만 넘기는 작은 구조체. 2바이트라 포인터 대신 값으로 그대로 큐에 넣는다.
+struct ButtonEvent {
+  int8_t action;
+  uint8_t repeat; // MANYPRESS면 getRepeatCount(). 다른 액션은 1.
+};
+// 큐에 이렇게 작은 값을 저장하는 거라면 MemoryPool을 쓸 필요가 없다.
 // 그냥 메모리 풀 없이 쓰는 기본 UniversalQueue를 사용하는 것이 훨씬 더 간단하고 효율적.
-UniversalQueue <int8_t> button1Queue(eventQueueSize); // 버튼1 이벤트 독립 동작 큐
+UniversalQueue <ButtonEvent> button1Queue(eventQueueSize); // 버튼1 이벤트 독립 동작 큐
+// StaticUniversalQueue<ButtonEvent, eventQueueSize> button1Queue; // 힙을 쓰지 않는 정적 할당 큐 (FreeRTOS는 configSUPPORT_STATIC_ALLOCATION 필요)
 // UniversalQueue <EventBox*> button2Queue(eventQueueSize); // 버튼2 이벤트 독립 동작 큐
 // 이렇게도 쓸 수 있지만 EventBox의 new, delete를 확실히 해줘야 한다.
 // EventBox* e = new EventBox(); 해서 push. => pop 해서 다 쓰고 반드시 delete e;
@@ -127,12 +141,13 @@ void customOneButtonDecaClick() { Serial.println("custom one button deca click."
 // cd4067을 쓰는 경우 for문을 돌며 각 버튼들의 반환값을 받아놨다가 한번에 구동할 수도 있겠고.
 // 버튼 두 개 조합키를 쓰는 경우 조합 동작으로 판정되면 그에 맞는 doIt() 함수를 따로 구동할 수 있다.
 // 원하면 파라미터를 넣어서 쓰자.
-void doIt(int8_t a) {
+// repeat은 MANYPRESS일 때 지난번 이후 지나간 반복 간격 수. button.getRepeatCount()를 넘겨준다.
+void doIt(int8_t a, uint8_t repeat = 1) {
   if (a != NO_ACTION) {
     switch (a) {
       case NO_ACTION: break;
       case LONGPRESS: customOneButtonLongPress(); break;
-      case MANYPRESS: customOneButtonManyPress(); break;
+      case MANYPRESS: for (uint8_t i = 0; i < repeat; i++) customOneButtonManyPress(); break; // 루프가 늦었으면 밀린 반복 횟수만큼.
       case CLICK: customOneButtonClick(); break;
       case DOUBLECLICK: customOneButtonDoubleClick(); break;
         // case TRIPLECLICK: customOneButtonTripleClick(); break;
@@ -168,14 +183,14 @@ void customTwoButtonDecaClick() { Serial.println("custom two button deca click."
 // 각 버튼들의 독립 동작 수행은 버튼마다 button.doIt()이든 doIt()이든 각각 별개의 구동 함수를 통해서 처리한다.
 // 원하면 파라미터를 넣어서 쓰자.
 
-// comboDoIt(event); 이런 식으로 쓴다.
-void comboDoIt(int8_t a) {
+// comboDoIt(event, combo.getRepeatCount(2)); 이런 식으로 쓴다.
+void comboDoIt(int8_t a, uint8_t repeat = 1) {
   // Serial.println(a); // 디버깅.. 이 함수가 실행은 되었는지, 어느 액션 번호를 받았는지 확인.
   if (a != NO_ACTION) { // <= 이거 생각보다 중요할 수 있으니 지우지 않는 게 좋음. if(a)라고 해도 되지만 이게 조금 더 명시적이어서 이렇게 해놓음.
     switch (a) {
       case NO_ACTION: break;
       case LONGPRESS: customTwoButtonLongPress(); break;
-      case MANYPRESS: customTwoButtonManyPress(); break;
+      case MANYPRESS: for (uint8_t i = 0; i < repeat; i++) customTwoButtonManyPress(); break; // 루프가 늦었으면 밀린 반복 횟수만큼.
       case CLICK: customTwoButtonClick(); break;
       case DOUBLECLICK: customTwoButtonDoubleClick(); break;
         // case TRIPLECLICK: customTwoButtonTripleClick(); break;
@@ -241,7 +256,8 @@ void Task_buttonCheck(void *pvParameters) {
     //
     // // 버튼1 이벤트 큐에 담기.
     // if (event1 != NO_ACTION) {
-    //   button1Queue.push(event1);
+    //   ButtonEvent be = {event1, button1.getRepeatCount()};
+    //   button1Queue.push(be);
     // }
     //
     // // 버튼2 이벤트 큐에 담기.
@@ -249,6 +265,7 @@ void Task_buttonCheck(void *pvParameters) {
     //   EventBox* e = button2Queue.allocate(); // MemoryPool에 할당 후 주소값 가져옴.
     //   if (e) { // 메모리 할당 성공 시에만 수행.
     //     e->action = event2;
+    //     e->repeat = button2.getRepeatCount();
     //     e->intParam = 123;
     //     e->floatParam = 3.14f;
     //     e->strParam = "bt2!";
@@ -269,13 +286,15 @@ void Task_buttonCheck(void *pvParameters) {
 
     // 버튼1 이벤트 큐에 담기.
     if (events[0] != NO_ACTION) {
-      button1Queue.push(events[0]);
+      ButtonEvent be = {events[0], buttonCombo.getRepeatCount(0)};
+      button1Queue.push(be);
     }
     // 버튼2 이벤트 큐에 담기.
     if (events[1] != NO_ACTION) {
       EventBox* e = button2Queue.allocate(); // MemoryPool에 할당 후 주소값 가져옴.
       if (e) { // 메모리 할당 성공 시에만 수행.
         e->action = events[1];
+        e->repeat = buttonCombo.getRepeatCount(1);
         e->intParam = 123;
         e->floatParam = 3.14f;
         e->strParam = "bt2!";
@@ -290,6 +309,7 @@ void Task_buttonCheck(void *pvParameters) {
       EventBox* e = buttonCombo12Queue.allocate(); // MemoryPool에 할당 후 주소값 가져옴.
       if (e) { // 메모리 할당 성공 시에만 수행.
         e->action = events[2];
+        e->repeat = buttonCombo.getRepeatCount(2);
         e->intParam = 123;
         e->floatParam = 3.14f;
         e->strParam = "combo!";
@@ -310,31 +330,28 @@ void Task_buttonExecute(void *pvParameters) {
   for (;;) {
     // 큐에 저장된 이벤트들 꺼내서 동작 수행.
 
+    // popN()으로 쌓여있는 것을 한 번에 다 꺼낸다. 하나씩 pop() 하는 것보다 락을 잡는 횟수가 적다.
     // 버튼1 독립 동작 큐 처리.
-    while (!button1Queue.isEmpty()) {
-      int8_t e;
-      if (button1Queue.pop(e)) button1.doIt(e); // doIt(e);
-    };
+    ButtonEvent es[eventQueueSize];
+    size_t n = button1Queue.popN(es, eventQueueSize);
+    for (size_t i = 0; i < n; ++i) button1.doIt(es[i].action, es[i].repeat); // doIt(es[i].action, es[i].repeat);
     // 버튼2 독립 동작 큐 처리.
-    while (!button2Queue.isEmpty()) {
-      EventBox* e;
-      if (button2Queue.pop(e)) {
-        button2.doIt(e->action);
-        // doIt(e->action);
-        // e 다 쓰고 나면.
-        button2Queue.free(e); // 반드시 1번만 해제해줘야 한다. 반드시 정확하게 해줘야 해서 pop 성공 시 수행.
-      }
-    };
+    EventBox* boxes[eventQueueSize];
+    n = button2Queue.popN(boxes, eventQueueSize);
+    for (size_t i = 0; i < n; ++i) {
+      button2.doIt(boxes[i]->action, boxes[i]->repeat);
+      // doIt(boxes[i]->action, boxes[i]->repeat);
+      // 다 쓰고 나면.
+      button2Queue.free(boxes[i]); // 꺼낸 것마다 반드시 1번만 해제해줘야 한다.
+    }
     // 버튼 1, 2 조합 동작 큐 처리.
-    while (!buttonCombo12Queue.isEmpty()) {
-      EventBox* e;
-      if (buttonCombo12Queue.pop(e)) {
-        buttonCombo.doIt(e->action);
-        // comboDoIt(e->action);
-        // e 다 쓰고 나면.
-        buttonCombo12Queue.free(e); // 반드시 1번만 해제해줘야 한다. 반드시 정확하게 해줘야 해서 pop 성공 시 수행.
-      }
-    };
+    n = buttonCombo12Queue.popN(boxes, eventQueueSize);
+    for (size_t i = 0; i < n; ++i) {
+      buttonCombo.doIt(boxes[i]->action, boxes[i]->repeat);
+      // comboDoIt(boxes[i]->action, boxes[i]->repeat);
+      // 다 쓰고 나면.
+      buttonCombo12Queue.free(boxes[i]); // 꺼낸 것마다 반드시 1번만 해제해줘야 한다.
+    }
 
     // UBaseType_t stackLeft = uxTaskGetStackHighWaterMark(NULL); // 현재 실행 중인 태스크의 스택 사용량 정보를 조회.
     // Serial.printf("스택 여유: %u words\r\n", stackLeft); // 남은 스택 워드 수(word 단위) 1 word = 4 bytes (32bit 기준)
@@ -346,6 +363,13 @@ void Task_buttonExecute(void *pvParameters) {
 void setup() {
   Serial.begin(9600);
 
+  // 큐가 가득 찼을 때의 정책. 기본은 새로 들어오는 걸 버리는 OVERFLOW_REJECT.
+  // 소비하는 쪽이 바빠서 큐가 차면 가장 오래된 이벤트를 버리고 최근 이벤트를 넣는다. 감지하는 쪽은 절대 기다리지 않는다.
+  button1Queue.setOverflowPolicy(OVERFLOW_DROP_OLDEST);
+  // button2Queue.setOverflowPolicy(OVERFLOW_DROP_OLDEST); // MemoryPoolQueue는 밀려난 EventBox를 알아서 free() 해준다.
+  // buttonCombo12Queue.setOverflowPolicy(OVERFLOW_KEEP_LATEST); // 쌓인 걸 다 비우고 최신 것 하나만 남긴다.
+  // QueueStats st = button1Queue.getStats(); // st.pushed, st.rejected, st.droppedOldest, st.overwritten, st.coalesced
+
   // 기본 구동 함수 쓸 때2. 기본 동작 함수들 등록.
   // 생성자에서 지정 못했어도 setup이나 loop에서 이렇게 할 수 있다.
   // 지정하는 함수들이 파라미터를 받지않는 함수들이다.
@@ -0,0 +1,38 @@
+// - 이 예제는 RamjiBench로 이 보드에서 버튼 스캔과 큐 연산이 얼마나 걸리는지 재는 예제입니다.
+// - 결과는 한 줄에 하나씩 JSON으로 시리얼에 찍힙니다. 시리얼 모니터 내용을 그대로 저장해서 파이썬이나 jq로 읽으면 됩니다.
+// - 뱅크 크기는 1개부터 setMaxBank()로 준 상한까지 두 배씩 늘려가며 잽니다. RAM이 작은 보드는 상한을 줄이세요.
+
+// - This example measures how long button scanning and queue operations take on this board using RamjiBench.
+// - Results are printed to serial as one JSON object per line. Save the serial monitor output and read it with Python or jq.
+// - The bank size doubles from 1 up to the limit given by setMaxBank(). Lower the limit on boards with little RAM.
+
+#include <Arduino.h>
+#include "RamjiBench.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// 버튼들이 읽을 핀. 아무것도 안 연결된 핀이면 된다. 눌린 버튼이 없어야 매번 같은 경로를 잰다.
+const uint8_t BENCH_PIN = 2;
+
+// CD74HC4067 S0~S3 핀. mux_select를 안 잴 거면 setMuxPins() 줄을 지운다.
+const uint8_t S0 = 3;
+const uint8_t S1 = 4;
+const uint8_t S2 = 5;
+const uint8_t S3 = 6;
+
+RamjiBench bench(BENCH_PIN);
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+void setup() {
+  Serial.begin(115200);
+  delay(2000); // USB 시리얼이 붙을 시간을 준다.
+
+  bench.setMuxPins(S0, S1, S2, S3);
+  bench.setMaxBank(256); // 버튼 하나가 수십 바이트라서 1024개는 RAM이 넉넉한 보드에서만.
+  bench.setScans(100);   // 뱅크 하나당 스캔 횟수. 늘리면 더 안정적이지만 오래 걸린다.
+  bench.runAll();
+}
+
+void loop() {
+}
@@ -0,0 +1,54 @@
+// - 이 예제는 PinTraceRecorder로 실제 버튼 패널의 핀 변화를 기록하는 예제입니다.
+// - 버튼을 평소처럼 쓰면서 기록하다가, 기록 버튼을 길게 누르면 트레이스를 "PT:" 줄로 시리얼에 찍습니다.
+// - 시리얼 모니터 내용을 파일로 저장해서 PC에서 RamjiReplayHost(CMake 호스트 빌드)로 다시 돌리면,
+//   타이밍 상수를 고칠 때마다 같은 입력에 대한 판정이 어떻게 달라지는지 골든 출력과 비교할 수 있습니다.
+
+// - This example records the pin transitions of a real button panel with PinTraceRecorder.
+// - Use the buttons as usual while recording; long-press the dump button to print the trace to serial as "PT:" lines.
+// - Save the serial monitor output to a file and replay it on the PC with RamjiReplayHost (CMake host build)
+//   to compare the detected actions against a golden output whenever a timing constant changes.
+
+#include <Arduino.h>
+#include "RamjiButton.h"
+#include "PinTrace.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+const uint8_t buttonPin01 = 2;
+const uint8_t buttonPin02 = 3;
+const uint8_t dumpPin = 4; // 이 버튼을 길게 누르면 트레이스를 찍는다. 트레이스에는 안 들어간다.
+
+Button button1(buttonPin01);
+Button button2(buttonPin02);
+Button dumpButton(dumpPin);
+TwoButtonCombo buttonCombo1(button1, button2);
+
+// 4KB면 변화 2천 번 정도. 보통 누름 한 번이 변화 2개(+채터링)라서 천 번쯤 누를 수 있다.
+PinTraceRecorder<4096, 2> recorder;
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+void setup() {
+  Serial.begin(115200);
+  // 채널 번호는 붙인 순서. RamjiReplayHost에서 채널 i는 버튼 i, --combo를 주면 (0,1)이 조합.
+  recorder.addPin(buttonPin01);
+  recorder.addPin(buttonPin02);
+  recorder.begin();
+}
+
+void loop() {
+  // 버튼 스캔과 같은 자리에서 기록한다. 바뀐 게 없으면 아무것도 안 쓴다.
+  recorder.sample();
+
+  int8_t* events = buttonCombo1.event();
+  if (events[0]) { Serial.print("button1 "); Serial.println(events[0]); }
+  if (events[1]) { Serial.print("button2 "); Serial.println(events[1]); }
+  if (events[2]) { Serial.print("combo "); Serial.println(events[2]); }
+
+  if (dumpButton.event() == LONGPRESS) {
+    recorder.printHex();
+    Serial.print("dropped:");
+    Serial.println(recorder.getDropped());
+    recorder.begin(); // 찍은 뒤에는 처음부터 다시 기록.
+  }
+}
@@ -0,0 +1,52 @@
+// RamjiBench 호스트 실행 파일.
+// 보드 스케치(examples/06_Benchmark)와 같은 RamjiBench.h 벤치를 PC에서 돌린다. 결과는 stdout에 JSON 한 줄씩.
+//
+//   ./RamjiBenchHost                  // 기본: 뱅크 1~1024, 스캔 1000번
+//   ./RamjiBenchHost --max-bank 256 --scans 5000 --active
+//
+// operator new를 가로채서 재는 동안의 힙 할당 수(allocs)도 함께 찍는다.
+
+#include <Arduino.h>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "RamjiBench.h"
+
+namespace {
+  std::atomic<long> g_allocs(0);
+  long allocCount() { return g_allocs.load(); }
+}
+
+void* operator new(size_t size) {
+  ++g_allocs;
+  void* p = std::malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  ++g_allocs;
+  return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+int main(int argc, char** argv) {
+  RamjiBench bench(2);
+  bench.setMuxPins(3, 4, 5, 6);
+  bench.setAllocCounter(allocCount);
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--max-bank") && i + 1 < argc) bench.setMaxBank(strtoul(argv[++i], nullptr, 10));
+    else if (!strcmp(argv[i], "--scans") && i + 1 < argc) bench.setScans(strtoul(argv[++i], nullptr, 10));
+    else if (!strcmp(argv[i], "--active")) bench.setActiveInput(true);
+    else {
+      fprintf(stderr, "usage: %s [--max-bank N] [--scans N] [--active]\n", argv[0]);
+      return 2;
+    }
+  }
+  bench.runAll();
+  return 0;
+}
@@ -0,0 +1,125 @@
+// 호스트 빌드용 Arduino HAL 대역의 구현. 설명은 Arduino.h 참고.
+
+#include "Arduino.h"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstring>
+
+namespace {
+  std::atomic<uint64_t> g_micros(0); // 가상 시계. 마이크로초 단위로 갖고 있고 millis()는 나눠서 준다.
+  int g_level[HOST_PIN_COUNT];
+  uint8_t g_mode[HOST_PIN_COUNT];
+  std::atomic<unsigned long> g_reads(0);
+  std::atomic<unsigned long> g_writes(0);
+  int (*g_readHook)(uint8_t, void*) = nullptr;
+  void* g_readCtx = nullptr;
+  void (*g_writeHook)(uint8_t, int, void*) = nullptr;
+  void* g_writeCtx = nullptr;
+  bool g_serialEnabled = true;
+
+  struct Init {
+    Init() { host::reset(); }
+  } g_init;
+}
+
+HostSerial Serial;
+
+unsigned long millis() { return static_cast<unsigned long>(g_micros.load() / 1000); }
+unsigned long micros() { return static_cast<unsigned long>(g_micros.load()); }
+void delay(unsigned long ms) { g_micros += static_cast<uint64_t>(ms) * 1000; }
+void delayMicroseconds(unsigned int us) { g_micros += us; }
+void yield() {}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  g_mode[pin] = mode;
+  // 풀업/풀다운은 아무것도 안 눌렸을 때의 레벨.
+  if (mode == INPUT_PULLUP) g_level[pin] = HIGH;
+  else if (mode == INPUT_PULLDOWN) g_level[pin] = LOW;
+}
+
+int digitalRead(uint8_t pin) {
+  ++g_reads;
+  if (g_readHook) return g_readHook(pin, g_readCtx);
+  return g_level[pin] ? HIGH : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  ++g_writes;
+  g_level[pin] = value ? HIGH : LOW;
+  if (g_writeHook) g_writeHook(pin, g_level[pin], g_writeCtx);
+}
+
+int analogRead(uint8_t pin) {
+  ++g_reads;
+  if (g_readHook) return g_readHook(pin, g_readCtx);
+  return g_level[pin];
+}
+
+void analogWrite(uint8_t pin, int value) {
+  ++g_writes;
+  g_level[pin] = value;
+  if (g_writeHook) g_writeHook(pin, value, g_writeCtx);
+}
+
+namespace host {
+  void reset() {
+    g_micros = 0;
+    for (int i = 0; i < HOST_PIN_COUNT; ++i) {
+      g_level[i] = HIGH;
+      g_mode[i] = INPUT;
+    }
+    g_reads = 0;
+    g_writes = 0;
+    g_readHook = nullptr;
+    g_writeHook = nullptr;
+  }
+
+  void setMillis(unsigned long ms) { g_micros = static_cast<uint64_t>(ms) * 1000; }
+  void advanceMillis(unsigned long ms) { g_micros += static_cast<uint64_t>(ms) * 1000; }
+  void setMicros(unsigned long us) { g_micros = us; }
+  void advanceMicros(unsigned long us) { g_micros += us; }
+
+  void setPin(uint8_t pin, int level) { g_level[pin] = level; }
+  int getPin(uint8_t pin) { return g_level[pin]; }
+  uint8_t getPinMode(uint8_t pin) { return g_mode[pin]; }
+  void setAnalog(uint8_t pin, int value) { g_level[pin] = value; }
+
+  unsigned long getReadCount() { return g_reads; }
+  unsigned long getWriteCount() { return g_writes; }
+
+  void setReadHook(int (*hook)(uint8_t pin, void* ctx), void* ctx) {
+    g_readHook = hook;
+    g_readCtx = ctx;
+  }
+
+  void setWriteHook(void (*hook)(uint8_t pin, int level, void* ctx), void* ctx) {
+    g_writeHook = hook;
+    g_writeCtx = ctx;
+  }
+
+  void setSerialEnabled(bool enabled) { g_serialEnabled = enabled; }
+}
+
+size_t HostSerial::print(const String& s) { return print(s.c_str()); }
+size_t HostSerial::print(const char* s) {
+  if (!g_serialEnabled) return 0;
+  fputs(s, stdout);
+  return strlen(s);
+}
+size_t HostSerial::print(char c) { return g_serialEnabled ? (fputc(c, stdout) != EOF) : 0; }
+size_t HostSerial::print(int v) { return printf("%d", v); }
+size_t HostSerial::print(unsigned int v) { return printf("%u", v); }
+size_t HostSerial::print(long v) { return printf("%ld", v); }
+size_t HostSerial::print(unsigned long v) { return printf("%lu", v); }
+size_t HostSerial::print(double v, int decimals) { return printf("%.*f", decimals, v); }
+size_t HostSerial::println() { return print("\n"); }
+
+int HostSerial::printf(const char* fmt, ...) {
+  if (!g_serialEnabled) return 0;
+  va_list args;
+  va_start(args, fmt);
+  int n = vprintf(fmt, args);
+  va_end(args);
+  return n;
+}
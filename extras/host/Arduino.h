@@ -0,0 +1,119 @@
+#ifndef RAMJI_HOST_ARDUINO_H
+#define RAMJI_HOST_ARDUINO_H
+
+// 호스트(리눅스/맥) 빌드용 Arduino.h 대역.
+// - 보드 없이 RamjiButton과 UniversalQueue를 PC에서 빌드하고 돌려보기 위한 최소한의 HAL.
+// - 시간은 가상 시계다. millis()는 host::setMillis()/host::advanceMillis()로 정한 값만 돌려주고, delay()는 그만큼 시계를 민다.
+//   그래서 버튼 FSM을 실제 시간 없이 원하는 속도로 돌려볼 수 있다.
+// - 핀도 가상이다. 버튼 누름은 host::setPin(pin, LOW)처럼 핀 레벨을 정해주면 된다.
+// - Arduino IDE는 extras/ 폴더를 빌드하지 않으므로 보드 빌드에는 아무 영향이 없다.
+// - CMakeLists.txt가 이 폴더를 include 경로 맨 앞에 두고 RAMJI_HOST를 정의한다.
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#define LOW 0
+#define HIGH 1
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define INPUT_PULLDOWN 0x3
+
+#define HOST_PIN_COUNT 256
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+
+// 가상 시계와 가상 핀을 다루는 호스트 전용 함수들.
+namespace host {
+  void reset();                          // 시계 0, 모든 핀 HIGH, 핀 모드 INPUT, 카운터 0.
+  void setMillis(unsigned long ms);
+  void advanceMillis(unsigned long ms);
+  void setMicros(unsigned long us);
+  void advanceMicros(unsigned long us);
+
+  void setPin(uint8_t pin, int level);   // 버튼이나 외부 회로가 핀을 이 레벨로 만든다.
+  int getPin(uint8_t pin);               // 마지막으로 쓴(digitalWrite/analogWrite) 또는 정한 레벨.
+  uint8_t getPinMode(uint8_t pin);
+  void setAnalog(uint8_t pin, int value);
+
+  // 핀 접근 횟수. 스캔 비용을 잴 때 쓴다.
+  unsigned long getReadCount();
+  unsigned long getWriteCount();
+
+  // 핀 읽기/쓰기를 가로챈다. 시프트 레지스터 같은 외부 칩을 흉내낼 때. nullptr이면 해제.
+  void setReadHook(int (*hook)(uint8_t pin, void* ctx), void* ctx = nullptr);
+  void setWriteHook(void (*hook)(uint8_t pin, int level, void* ctx), void* ctx = nullptr);
+
+  // Serial 출력을 켜고 끈다. 기본은 켜짐(stdout).
+  void setSerialEnabled(bool enabled);
+}
+
+class String {
+public:
+  String() {}
+  String(const char* s) : _s(s ? s : "") {}
+  String(const std::string& s) : _s(s) {}
+  String(char c) : _s(1, c) {}
+  String(int v) : _s(std::to_string(v)) {}
+  String(unsigned int v) : _s(std::to_string(v)) {}
+  String(long v) : _s(std::to_string(v)) {}
+  String(unsigned long v) : _s(std::to_string(v)) {}
+  String(unsigned char v) : _s(std::to_string(v)) {}
+  String(bool v) : _s(std::to_string(v ? 1 : 0)) {}
+  String(double v, unsigned char decimals = 2) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+    _s = buf;
+  }
+
+  const char* c_str() const { return _s.c_str(); }
+  unsigned int length() const { return static_cast<unsigned int>(_s.size()); }
+  String& operator+=(const String& o) { _s += o._s; return *this; }
+  bool operator==(const String& o) const { return _s == o._s; }
+
+  friend String operator+(const String& a, const String& b) { return String(a._s + b._s); }
+  friend String operator+(const String& a, const char* b) { return String(a._s + b); }
+  friend String operator+(const char* a, const String& b) { return String(a + b._s); }
+
+private:
+  std::string _s;
+};
+
+class HostSerial {
+public:
+  void begin(unsigned long) {}
+  explicit operator bool() const { return true; }
+
+  size_t print(const String& s);
+  size_t print(const char* s);
+  size_t print(char c);
+  size_t print(int v);
+  size_t print(unsigned int v);
+  size_t print(long v);
+  size_t print(unsigned long v);
+  size_t print(double v, int decimals = 2);
+
+  size_t println();
+  template <typename T>
+  size_t println(const T& v) { size_t n = print(v); return n + println(); }
+  size_t println(double v, int decimals) { size_t n = print(v, decimals); return n + println(); }
+  int printf(const char* fmt, ...);
+};
+
+extern HostSerial Serial;
+
+#endif //RAMJI_HOST_ARDUINO_H
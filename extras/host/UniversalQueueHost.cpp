@@ -0,0 +1,13 @@
+// 호스트 빌드에서 UniversalQueue.h의 템플릿들을 한 번씩 명시적으로 인스턴스화한다.
+// 헤더뿐인 코드라서, 이렇게 해야 CMake 빌드에서 모든 멤버 함수가 실제로 컴파일된다.
+
+#include "UniversalQueue.h"
+
+template class UniversalQueue<int8_t>;
+template class UniversalQueue<uint32_t*>;
+template class StaticUniversalQueue<int8_t, 8>;
+template class MemoryPool<uint32_t, 8>;
+template class MemoryPoolQueue<uint32_t, 8>;
+template class PriorityQueue<int8_t, 3>;
+template class EventBus<uint32_t, 16, 4>;
+template class ActionExecutor<2>;
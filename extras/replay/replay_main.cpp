@@ -0,0 +1,137 @@
+// RamjiReplayHost
+// 보드에서 PinTraceRecorder로 기록한 트레이스를 PC에서 Button/TwoButtonCombo에 다시 흘려보낸다.
+// 채널 i는 버튼 i. --combo를 주면 채널 (0,1), (2,3), ... 을 TwoButtonCombo로 묶는다. 조합 액션의 키는 100 + 쌍 번호.
+// 판정 결과는 stdout에 "시간 키 액션 반복 지연" 한 줄씩. 골든과 비교하면 다른 판정만 찍고, 다르면 종료 코드 1.
+//
+//   ./RamjiReplayHost panel.trace --write-golden panel.golden     // 지금 상수로 골든 뜨기
+//   ./RamjiReplayHost panel.trace --golden panel.golden --tolerance 5
+//   ./RamjiReplayHost panel.trace --scan-period 10 --combo --runs 100
+//
+// 트레이스 파일은 바이너리 그대로이거나, printHex()가 찍은 시리얼 로그("PT:" 줄) 그대로.
+// sample.trace와 그 골든 두 개(sample.golden, sample_combo.golden)는 ctest의 replay_golden, replay_golden_combo로 돈다.
+
+#include <Arduino.h>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "RamjiButton.h"
+#include "PinTrace.h"
+
+namespace {
+  const uint8_t FIRST_PIN = 10; // 가상 핀 번호. 채널 i는 핀 FIRST_PIN + i.
+  const uint8_t COMBO_KEY = 100;
+
+  struct Panel {
+    std::vector<Button*> buttons;
+    std::vector<TwoButtonCombo*> combos;
+  };
+
+  void scan(PinTraceReplay& replay, void* ctx) {
+    Panel& panel = *static_cast<Panel*>(ctx);
+    size_t paired = panel.combos.size() * 2;
+    for (size_t i = 0; i < panel.combos.size(); ++i) {
+      TwoButtonCombo& c = *panel.combos[i];
+      int8_t* events = c.event();
+      uint8_t k1 = static_cast<uint8_t>(2 * i);
+      uint8_t k2 = static_cast<uint8_t>(2 * i + 1);
+      for (int e = 0; e < 3; ++e) {
+        if (!events[e]) continue;
+        uint8_t repeat = (events[e] == MANYPRESS) ? c.getRepeatCount(e) : 1;
+        if (e == 0) replay.report(k1, events[e], repeat);
+        else if (e == 1) replay.report(k2, events[e], repeat);
+        else replay.report(static_cast<uint8_t>(COMBO_KEY + i), events[e], repeat, (1UL << k1) | (1UL << k2));
+      }
+    }
+    for (size_t i = paired; i < panel.buttons.size(); ++i) {
+      int8_t a = panel.buttons[i]->event();
+      if (a) replay.report(static_cast<uint8_t>(i), a, (a == MANYPRESS) ? panel.buttons[i]->getRepeatCount() : 1);
+    }
+  }
+
+  void build(Panel& panel, uint8_t channels, bool combo) {
+    for (Button* b : panel.buttons) delete b;
+    for (TwoButtonCombo* c : panel.combos) delete c;
+    panel.buttons.clear();
+    panel.combos.clear();
+    for (uint8_t i = 0; i < channels; ++i) panel.buttons.push_back(new Button(FIRST_PIN + i));
+    if (!combo) return;
+    for (uint8_t i = 0; i + 1 < channels; i += 2) {
+      panel.combos.push_back(new TwoButtonCombo(*panel.buttons[i], *panel.buttons[i + 1]));
+    }
+  }
+
+  int usage(const char* argv0) {
+    fprintf(stderr, "usage: %s TRACE [--scan-period MS] [--tail MS] [--combo] [--runs N]\n"
+                    "       [--golden FILE] [--write-golden FILE] [--tolerance MS] [--quiet]\n", argv0);
+    return 2;
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) return usage(argv[0]);
+  const char* tracePath = argv[1];
+  const char* goldenPath = nullptr;
+  const char* writePath = nullptr;
+  unsigned long period = 1;
+  unsigned long tail = 2000;
+  unsigned long tolerance = 0;
+  unsigned long runs = 1;
+  bool combo = false;
+  bool quiet = false;
+  for (int i = 2; i < argc; ++i) {
+    if (!strcmp(argv[i], "--scan-period") && i + 1 < argc) period = strtoul(argv[++i], nullptr, 10);
+    else if (!strcmp(argv[i], "--tail") && i + 1 < argc) tail = strtoul(argv[++i], nullptr, 10);
+    else if (!strcmp(argv[i], "--tolerance") && i + 1 < argc) tolerance = strtoul(argv[++i], nullptr, 10);
+    else if (!strcmp(argv[i], "--runs") && i + 1 < argc) runs = strtoul(argv[++i], nullptr, 10);
+    else if (!strcmp(argv[i], "--golden") && i + 1 < argc) goldenPath = argv[++i];
+    else if (!strcmp(argv[i], "--write-golden") && i + 1 < argc) writePath = argv[++i];
+    else if (!strcmp(argv[i], "--combo")) combo = true;
+    else if (!strcmp(argv[i], "--quiet")) quiet = true;
+    else return usage(argv[0]);
+  }
+  if (runs == 0) runs = 1;
+
+  PinTraceReplay replay;
+  if (!replay.loadFile(tracePath)) {
+    fprintf(stderr, "cannot read trace: %s\n", tracePath);
+    return 2;
+  }
+  replay.setScanPeriod(period);
+  replay.setTail(tail);
+  for (uint8_t ch = 0; ch < replay.channels(); ++ch) replay.mapPin(ch, FIRST_PIN + ch);
+
+  // 매번 새 버튼으로 돌린다. FSM 상태가 이전 실행에서 이어지면 결과가 달라진다.
+  Panel panel;
+  double speedup = 0;
+  for (unsigned long r = 0; r < runs; ++r) {
+    build(panel, replay.channels(), combo);
+    replay.run(scan, &panel);
+    speedup += replay.speedup();
+  }
+  build(panel, 0, false);
+
+  const std::vector<ReplayAction>& actions = replay.actions();
+  fprintf(stderr, "channels=%u transitions=%zu duration_ms=%lu actions=%zu speedup=%.0fx\n",
+          replay.channels(), replay.transitions(), replay.duration(), actions.size(), speedup / runs);
+
+  if (writePath && !PinTraceReplay::saveActions(writePath, actions)) {
+    fprintf(stderr, "cannot write golden: %s\n", writePath);
+    return 2;
+  }
+  if (goldenPath) {
+    std::vector<ReplayAction> golden;
+    if (!PinTraceReplay::loadActions(goldenPath, golden)) {
+      fprintf(stderr, "cannot read golden: %s\n", goldenPath);
+      return 2;
+    }
+    size_t diff = PinTraceReplay::compare(golden, actions, tolerance, !quiet);
+    fprintf(stderr, "%zu mismatches against %s\n", diff, goldenPath);
+    return diff ? 1 : 0;
+  }
+  if (!quiet && !writePath) {
+    for (const ReplayAction& a : actions) {
+      printf("%lu %u %d %u %lu\n", a.time, a.key, a.action, a.repeat, a.latency);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,113 @@
+// 적응형 디바운스 테스트. 1초 간격으로 30번 클릭하는 핀 스크립트를 깨끗한 스위치, 빠른 탭,
+// 닳은 스위치(12ms, 30ms 바운스)로 돌려서 고정 창과 적응형 창의 결과를 비교한다.
+
+#include <Arduino.h>
+#include "RamjiButton.h"
+#include "test_check.h"
+
+namespace {
+  const uint8_t PIN = 9;
+  const int CLICKS = 30;
+  const unsigned long FIRST = 1000;
+  const unsigned long GAP = 1000;
+  const uint8_t MIN_WINDOW = 5;
+
+  struct Script {
+    unsigned long length; // 누름 길이(ms).
+    unsigned long bounce; // 누를 때와 뗄 때 이 시간 동안 2ms마다 뒤집힌다. 0이면 깨끗하다.
+  };
+
+  int level(const Script& s, unsigned long t) {
+    if (t < FIRST) return HIGH;
+    unsigned long d = (t - FIRST) % GAP;
+    if ((t - FIRST) / GAP >= CLICKS) return HIGH;
+    if (d < s.length) return (d < s.bounce && (d / 2) % 2) ? HIGH : LOW;
+    d -= s.length;
+    return (d < s.bounce && (d / 2) % 2) ? LOW : HIGH;
+  }
+
+  struct Result {
+    int clicks = 0;
+    int other = 0;
+    unsigned long estimate = 0;
+    unsigned long discardWindow = 0;
+    uint32_t bursts = 0;
+    uint32_t rejected = 0;
+  };
+
+  Result run(const Script& s, bool adaptive) {
+    host::reset();
+    Button b(PIN);
+    if (adaptive) b.setAdaptiveDebounce(true, MIN_WINDOW);
+    Result r;
+    for (unsigned long t = 0; t < FIRST + (CLICKS + 1) * GAP; ++t) {
+      host::setMillis(t);
+      host::setPin(PIN, level(s, t));
+      int8_t a = b.event();
+      if (a == CLICK) ++r.clicks;
+      else if (a) ++r.other;
+    }
+    r.estimate = b.getBounceEstimate();
+    r.discardWindow = b.getDiscardWindow();
+    r.bursts = b.getBounceBursts();
+    r.rejected = b.getRejectedPresses();
+    return r;
+  }
+
+  // 깨끗한 100ms 클릭. 둘 다 다 받고, 적응형은 창을 하한까지 줄인다.
+  void testClean() {
+    const Script s = { 100, 0 };
+    Result fixed = run(s, false);
+    Result adaptive = run(s, true);
+    CHECK_EQ(fixed.clicks, CLICKS);
+    CHECK_EQ(adaptive.clicks, CLICKS);
+    CHECK_EQ(adaptive.other, 0);
+    CHECK_EQ(adaptive.bursts, 0);
+    CHECK_EQ(adaptive.discardWindow, MIN_WINDOW);
+  }
+
+  // 25ms 탭은 고정 창(DISCARD_SHORT_PRESS_DURATION)에 다 버려진다. 적응형은 창이 줄어든 뒤부터 받는다.
+  void testFastTaps() {
+    const Script s = { 25, 0 };
+    Result fixed = run(s, false);
+    Result adaptive = run(s, true);
+    CHECK_EQ(fixed.clicks, 0);
+    CHECK_EQ(fixed.rejected, CLICKS);
+    CHECK(adaptive.clicks >= CLICKS * 2 / 3);
+    CHECK_EQ(adaptive.clicks + adaptive.rejected, CLICKS);
+    CHECK_EQ(adaptive.other, 0);
+    CHECK(adaptive.discardWindow < 25);
+  }
+
+  // 12ms 바운스. 추정이 바운스 길이 근처로 올라가고, 창은 그보다 넓지만 설정값보다는 좁다. 클릭은 하나도 안 늘고 안 준다.
+  void testWornSwitch() {
+    const Script s = { 100, 12 };
+    Result fixed = run(s, false);
+    Result adaptive = run(s, true);
+    CHECK_EQ(fixed.clicks, CLICKS);
+    CHECK_EQ(adaptive.clicks, CLICKS);
+    CHECK_EQ(adaptive.other, 0);
+    CHECK(adaptive.bursts > 0);
+    CHECK(adaptive.estimate >= 10 && adaptive.estimate <= 14);
+    CHECK(adaptive.discardWindow > adaptive.estimate);
+    CHECK(adaptive.discardWindow < DISCARD_SHORT_PRESS_DURATION);
+  }
+
+  // 30ms 바운스. 창은 설정값에서 멈춘다.
+  void testVeryWornSwitch() {
+    const Script s = { 120, 30 };
+    Result adaptive = run(s, true);
+    CHECK_EQ(adaptive.clicks, CLICKS);
+    CHECK_EQ(adaptive.other, 0);
+    CHECK_EQ(adaptive.discardWindow, DISCARD_SHORT_PRESS_DURATION);
+  }
+}
+
+int main() {
+  host::setSerialEnabled(false);
+  testClean();
+  testFastTaps();
+  testWornSwitch();
+  testVeryWornSwitch();
+  return testResult();
+}
@@ -0,0 +1,236 @@
+// 버튼 FSM 판정 테스트. 가상 핀을 정해진 시간만큼 누르고 떼면서 1ms마다 event()를 돌리고, 나온 액션을 확인한다.
+
+#include <Arduino.h>
+#include <vector>
+#include "RamjiButton.h"
+#include "ButtonTrace.h"
+#include "test_check.h"
+
+namespace {
+  const uint8_t PIN_A = 10;
+  const uint8_t PIN_B = 11;
+
+  struct Seen {
+    int8_t action;
+    uint8_t repeat;
+    unsigned long at;
+  };
+
+  // 핀을 level로 두고 ms 동안 1ms마다 event().
+  void hold(Button& b, int level, unsigned long ms, std::vector<Seen>& out) {
+    host::setPin(PIN_A, level);
+    for (unsigned long i = 0; i < ms; ++i) {
+      host::advanceMillis(1);
+      int8_t a = b.event();
+      if (a) out.push_back({ a, b.getRepeatCount(), millis() });
+    }
+  }
+
+  void press(Button& b, unsigned long downMs, unsigned long upMs, std::vector<Seen>& out) {
+    hold(b, LOW, downMs, out);
+    hold(b, HIGH, upMs, out);
+  }
+
+  // 가상 시계를 0이 아닌 곳에서 시작한다. 보드에서도 setup()이 끝날 즈음이면 millis()가 0이 아니다.
+  void start() {
+    host::reset();
+    host::setMillis(1000);
+  }
+
+  // 판정이 다 끝나고 디바운싱도 풀릴 만큼 쉰다.
+  const unsigned long SETTLE = SHORT_REPRESS_TIME + 200;
+
+  void testClicks() {
+    start();
+    Button b(PIN_A);
+    std::vector<Seen> seen;
+    press(b, 80, SETTLE, seen);
+    CHECK_EQ(seen.size(), 1);
+    if (seen.size() == 1) CHECK_EQ(seen[0].action, CLICK);
+
+    for (int n = 2; n <= 4; ++n) {
+      seen.clear();
+      for (int i = 0; i < n - 1; ++i) press(b, 80, 120, seen);
+      press(b, 80, SETTLE, seen);
+      CHECK_EQ(seen.size(), 1);
+      if (seen.size() == 1) CHECK_EQ(seen[0].action, CLICK + n - 1);
+    }
+  }
+
+  void testShortPressDiscarded() {
+    start();
+    Button b(PIN_A);
+    std::vector<Seen> seen;
+    press(b, DISCARD_SHORT_PRESS_DURATION / 2, SETTLE, seen);
+    CHECK_EQ(seen.size(), 0);
+    CHECK_EQ(b.getRejectedPresses(), 1);
+    // 버려진 누름 다음의 정상 클릭은 그대로 판정된다.
+    press(b, 80, SETTLE, seen);
+    CHECK_EQ(seen.size(), 1);
+    if (seen.size() == 1) CHECK_EQ(seen[0].action, CLICK);
+  }
+
+  void testLongPress() {
+    start();
+    Button b(PIN_A);
+    std::vector<Seen> seen;
+    press(b, LONG_PRESS_TIME + MANY_TRIGGER_TIME / 2, SETTLE, seen);
+    CHECK_EQ(seen.size(), 1);
+    if (seen.size() == 1) CHECK_EQ(seen[0].action, LONGPRESS);
+  }
+
+  void testManyPress() {
+    start();
+    Button b(PIN_A);
+    std::vector<Seen> seen;
+    const unsigned long held = 500;
+    press(b, LONG_PRESS_TIME + MANY_TRIGGER_TIME + held, SETTLE, seen);
+    CHECK(seen.size() > 1);
+    unsigned long repeats = 0;
+    for (const Seen& s : seen) {
+      CHECK_EQ(s.action, MANYPRESS);
+      repeats += s.repeat;
+    }
+    // 1ms마다 돌렸으니 반복 간격마다 하나씩. 앞뒤 경계로 하나 정도 차이는 난다.
+    CHECK(repeats + 2 >= held / MANY_REPRESS_TIME && repeats <= held / MANY_REPRESS_TIME + 2);
+  }
+
+  // 루프가 반복 간격보다 느려도 MANYPRESS 반복 횟수는 줄지 않는다.
+  void testSlowLoopRepeatCount() {
+    start();
+    Button b(PIN_A);
+    b.event();
+    host::setPin(PIN_A, LOW);
+    const unsigned long down = millis();
+    unsigned long repeats = 0;
+    unsigned long last = 0;
+    for (unsigned long t = 0; t <= LONG_PRESS_TIME + MANY_TRIGGER_TIME + 1000; t += 100) {
+      if (b.event() == MANYPRESS) {
+        last = millis();
+        repeats += b.getRepeatCount();
+      }
+      host::advanceMillis(100);
+    }
+    CHECK(repeats > 1);
+    // 연속 누름이 시작됐어야 할 시각부터 지나간 반복 간격 수. 1ms마다 돌았을 때와 같다.
+    const unsigned long trigger = down + LONG_PRESS_TIME + 1 + MANY_TRIGGER_TIME;
+    CHECK_EQ(repeats, 1 + (last - trigger) / MANY_REPRESS_TIME);
+  }
+
+  // 한 번도 안 눌린 버튼은 매 호출 짧은 누름 분기를 지나가지만 트레이스에 남기지도, 무효로 세지도 않는다.
+  void testTraceQuietWhenIdle() {
+    start();
+    Button b(PIN_A);
+    StaticButtonTrace<16> trace;
+    b.setTrace(&trace, 1);
+    std::vector<Seen> seen;
+    hold(b, HIGH, 1000, seen);
+    CHECK_EQ(trace.available(), 0);
+    CHECK_EQ(trace.getDropped(), 0);
+    CHECK_EQ(b.getRejectedPresses(), 0);
+
+    // 짧은 누름 하나는 무효 레코드 하나.
+    press(b, DISCARD_SHORT_PRESS_DURATION / 2, SETTLE, seen);
+    TraceRecord r;
+    int discarded = 0;
+    while (trace.pop(r)) {
+      if (r.flags & TRACE_DISCARDED) ++discarded;
+    }
+    CHECK_EQ(discarded, 1);
+    CHECK_EQ(b.getRejectedPresses(), 1);
+  }
+
+  // 진단 상태는 켤 때만 붙는다. 복사한 버튼은 상태를 따로 갖는다.
+  void testDiagnosticsCopy() {
+    start();
+    Button a(PIN_A);
+    CHECK(a.getTrace() == nullptr);
+    CHECK(!a.isLatencyTracking());
+    CHECK(!a.isAdaptiveDebounce());
+    CHECK_EQ(a.getBounceBursts(), 0);
+    a.setTrace(nullptr); // 해제만 하면 아무것도 안 붙는다.
+    CHECK(a.getTrace() == nullptr);
+
+    StaticButtonTrace<4> trace;
+    a.setTrace(&trace, 3);
+    a.setLatencyTracking(true);
+    Button b(a);
+    CHECK(b.getTrace() == &trace);
+    CHECK(b.isLatencyTracking());
+    b.setLatencyTracking(false);
+    CHECK(!b.isLatencyTracking());
+    CHECK(a.isLatencyTracking());
+    b = Button(PIN_B);
+    CHECK(b.getTrace() == nullptr);
+    CHECK(a.getTrace() == &trace);
+  }
+
+  // 가장 긴 줄도 TRACE_LINE_SIZE에 들어가고, 모자란 버퍼에는 잘린 줄 대신 빈 줄과 -1.
+  void testTraceFormat() {
+    TraceRecord r;
+    r.now = 0xFFFFFFFFUL;
+    r.pressDuration = r.sinceDown = r.sinceShortCall = r.sinceLongLogic = r.sinceManyPress = 0xFFFF;
+    r.id = 0xFF;
+    r.flags = intoShortStateLogic | TRACE_PRESSED | TRACE_DEBOUNCE | TRACE_DISCARDED | TRACE_MANY_TRIGGERED;
+    r.clickCount = 0xFF;
+    r.action = -128;
+    r.reserved[0] = r.reserved[1] = 0;
+    char line[TRACE_LINE_SIZE];
+    int n = formatTraceRecord(r, line, sizeof(line));
+    CHECK_EQ(n, TRACE_LINE_SIZE - 1);
+    char small[TRACE_LINE_SIZE - 1];
+    CHECK_EQ(formatTraceRecord(r, small, sizeof(small)), -1);
+    CHECK_EQ(small[0], '\0');
+  }
+
+  void testCombo() {
+    start();
+    Button a(PIN_A), b(PIN_B);
+    TwoButtonCombo combo(a, b);
+    int8_t got[3] = { NO_ACTION, NO_ACTION, NO_ACTION };
+    int counts[3] = { 0, 0, 0 };
+    auto run = [&](int levelA, int levelB, unsigned long ms) {
+      host::setPin(PIN_A, levelA);
+      host::setPin(PIN_B, levelB);
+      for (unsigned long i = 0; i < ms; ++i) {
+        host::advanceMillis(1);
+        int8_t* e = combo.event();
+        for (int k = 0; k < 3; ++k) {
+          if (!e[k]) continue;
+          got[k] = e[k];
+          ++counts[k];
+        }
+      }
+    };
+    // 둘 다 같이 눌렀다 떼면 조합 클릭 하나. 따로따로는 안 나온다.
+    run(LOW, LOW, 80);
+    run(HIGH, HIGH, SETTLE + TWO_BUTTON_TOLLERANCE_TIME);
+    CHECK_EQ(counts[0], 0);
+    CHECK_EQ(counts[1], 0);
+    CHECK_EQ(counts[2], 1);
+    CHECK_EQ(got[2], CLICK);
+
+    // 한쪽만 누르면 그 버튼의 클릭.
+    counts[0] = counts[1] = counts[2] = 0;
+    run(LOW, HIGH, 80);
+    run(HIGH, HIGH, SETTLE + TWO_BUTTON_TOLLERANCE_TIME);
+    CHECK_EQ(counts[0], 1);
+    CHECK_EQ(counts[1], 0);
+    CHECK_EQ(counts[2], 0);
+    CHECK_EQ(got[0], CLICK);
+  }
+}
+
+int main() {
+  host::setSerialEnabled(false);
+  testClicks();
+  testShortPressDiscarded();
+  testLongPress();
+  testManyPress();
+  testSlowLoopRepeatCount();
+  testTraceQuietWhenIdle();
+  testTraceFormat();
+  testDiagnosticsCopy();
+  testCombo();
+  return testResult();
+}
@@ -0,0 +1,104 @@
+// FixedRateSampler 테스트. 1ms마다 샘플링하고 소비자(버튼 FSM)는 150ms마다 한 번만 돈다.
+// 1ms마다 직접 event()를 돌린 기준과 판정이 같아야 한다. 같은 입력을 150ms마다 직접 읽으면 짧은 클릭이 합쳐지거나 사라진다.
+
+#include <Arduino.h>
+#include <vector>
+#include "FixedRateSampler.h"
+#include "test_check.h"
+
+namespace {
+  const uint8_t PIN = 9;
+  const unsigned long LAG = 150; // 소비자가 도는 주기(ms).
+  const unsigned long END = 8000;
+
+  struct Press {
+    unsigned long start;
+    unsigned long length;
+  };
+  // 세 번 클릭(두 번째, 세 번째는 간격이 좁다), 연속 누름, 무효가 돼야 할 짧은 누름 둘, 긴 연속 누름.
+  const Press script[] = { { 100, 60 }, { 500, 60 }, { 620, 50 }, { 1200, 1300 }, { 3000, 30 }, { 3040, 30 }, { 4000, 2500 } };
+
+  bool down(unsigned long t) {
+    for (const Press& p : script) {
+      if (t >= p.start && t < p.start + p.length) return true;
+    }
+    return false;
+  }
+
+  struct Result {
+    std::vector<int8_t> discrete;             // MANYPRESS가 아닌 판정들.
+    std::vector<unsigned long> discreteAt;
+    unsigned long repeats = 0;                // MANYPRESS 반복 횟수 합.
+  };
+
+  void note(Result& r, int8_t a, uint8_t repeat, unsigned long at) {
+    if (a == MANYPRESS) {
+      r.repeats += repeat;
+      return;
+    }
+    r.discrete.push_back(a);
+    r.discreteAt.push_back(at);
+  }
+
+  Result direct(unsigned long every) {
+    Result r;
+    host::reset();
+    Button b(PIN);
+    for (unsigned long t = 0; t < END; ++t) {
+      host::setMillis(t);
+      host::setPin(PIN, down(t) ? LOW : HIGH);
+      if (t % every) continue;
+      int8_t a = b.event();
+      if (a) note(r, a, b.getRepeatCount(), t);
+    }
+    return r;
+  }
+
+  Result sampled(uint32_t& overruns) {
+    Result r;
+    host::reset();
+    FixedRateSampler<1, 64> sampler;
+    Button b;
+    sampler.addPin(PIN);
+    sampler.attach(b, 0);
+    sampler.begin();
+    for (unsigned long t = 0; t < END; ++t) {
+      host::setMillis(t);
+      host::setPin(PIN, down(t) ? LOW : HIGH);
+      sampler.sample(); // 타이머 콜백 자리.
+      if (t % LAG) continue;
+      unsigned long at;
+      while (sampler.next(at)) {
+        int8_t a = b.event(at);
+        if (a) note(r, a, b.getRepeatCount(), at);
+      }
+    }
+    overruns = sampler.getOverruns();
+    return r;
+  }
+}
+
+int main() {
+  host::setSerialEnabled(false);
+  Result ref = direct(1);
+  uint32_t overruns = 0;
+  Result got = sampled(overruns);
+
+  CHECK_EQ(overruns, 0);
+  CHECK_EQ(ref.discrete.size(), 1);
+  if (!ref.discrete.empty()) CHECK_EQ(ref.discrete[0], TRIPLECLICK);
+  CHECK_EQ(got.discrete.size(), ref.discrete.size());
+  for (size_t i = 0; i < got.discrete.size() && i < ref.discrete.size(); ++i) {
+    CHECK_EQ(got.discrete[i], ref.discrete[i]);
+    // 판정은 시간이 지난 뒤 처음 소비자가 도는 시각에 나온다.
+    CHECK(got.discreteAt[i] >= ref.discreteAt[i] && got.discreteAt[i] - ref.discreteAt[i] < LAG);
+  }
+  // 소비자가 밀려도 MANYPRESS 반복은 getRepeatCount()에 합쳐져서 줄지 않는다.
+  CHECK(ref.repeats > 0);
+  CHECK_EQ(got.repeats, ref.repeats);
+
+  // 샘플러 없이 150ms마다 읽으면 같은 입력이 다르게 판정된다. 위의 확인이 의미 있다는 것만 본다.
+  Result slow = direct(LAG);
+  CHECK(slow.discrete != ref.discrete);
+  return testResult();
+}
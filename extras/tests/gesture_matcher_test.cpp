@@ -0,0 +1,209 @@
+// GestureMatcher 테스트. 손으로 고른 경우 몇 개와, 무작위 패턴 묶음 3000개에 무작위 액션 60개씩을 넣어서
+// 오토마톤의 결과(돌려준 패턴, getMatches())가 히스토리를 통째로 다시 맞춰 보는 느린 기준 구현과 같은지 본다.
+
+#include <Arduino.h>
+#include <cstdlib>
+#include <vector>
+#include "GestureMatcher.h"
+#include "test_check.h"
+
+namespace {
+  struct Ev {
+    uint8_t b;
+    int8_t a;
+    unsigned long t;
+  };
+
+  typedef std::vector<GestureStep> Pattern;
+
+  // 기준 구현. 마지막 리셋 이후의 액션을 모두 들고 있다가, 액션마다 모든 패턴을 처음부터 맞춰 본다.
+  struct Ref {
+    std::vector<Pattern> pats;
+    std::vector<Ev> hist;
+
+    // 히스토리 끝 L개가 패턴 p의 앞 L단계와 (버튼, 액션)이 같은지.
+    bool prefix(const Pattern& p, size_t L, size_t extra = 0) {
+      if (p.size() < L + extra) return false;
+      size_t n = hist.size();
+      for (size_t i = 0; i < L; ++i) {
+        if (p[i].button != hist[n - L + i].b || p[i].action != hist[n - L + i].a) return false;
+      }
+      return true;
+    }
+
+    // 끝 L개가 아직 이어질 수 있는지. 앞부분이 같은 패턴들 중 가장 느슨한 시간 제한을 넘은 간격이 없어야 한다.
+    bool live(size_t L) {
+      bool any = false;
+      for (const Pattern& p : pats) {
+        if (prefix(p, L)) any = true;
+      }
+      if (!any) return false;
+      size_t n = hist.size();
+      for (size_t i = 1; i < L; ++i) {
+        long lim = -1; // -1: 아직 없음, 0: 제한 없음.
+        for (const Pattern& p : pats) {
+          if (p.size() <= i) continue;
+          bool ok = true;
+          for (size_t j = 0; j <= i; ++j) {
+            if (p[j].button != hist[n - L + j].b || p[j].action != hist[n - L + j].a) { ok = false; break; }
+          }
+          if (!ok) continue;
+          long w = p[i].within;
+          if (lim < 0) lim = w;
+          else if (lim != 0 && (w == 0 || w > lim)) lim = w;
+        }
+        unsigned long gap = hist[n - L + i].t - hist[n - L + i - 1].t;
+        if (lim != 0 && gap > static_cast<unsigned long>(lim)) return false;
+      }
+      return true;
+    }
+
+    // 끝 L개 뒤로 더 이어질 패턴이 없는지.
+    bool leaf(size_t L) {
+      for (const Pattern& p : pats) {
+        if (prefix(p, L, 1)) return false;
+      }
+      return true;
+    }
+
+    int feed(const Ev& e, uint32_t& mask) {
+      mask = 0;
+      hist.push_back(e);
+      bool known = false;
+      for (const Pattern& p : pats) {
+        for (const GestureStep& s : p) {
+          if (s.button == e.b && s.action == e.a) known = true;
+        }
+      }
+      if (!known) {
+        hist.clear();
+        return -1;
+      }
+      size_t best = 0;
+      for (size_t L = hist.size(); L >= 1; --L) {
+        if (live(L)) { best = L; break; }
+      }
+      int found = -1;
+      size_t foundLen = 0;
+      size_t n = hist.size();
+      for (size_t pi = 0; pi < pats.size(); ++pi) {
+        const Pattern& p = pats[pi];
+        size_t L = p.size();
+        if (L > n || !prefix(p, L)) continue;
+        bool ok = true;
+        for (size_t i = 1; ok && i < L; ++i) {
+          if (p[i].within && hist[n - L + i].t - hist[n - L + i - 1].t > p[i].within) ok = false;
+        }
+        if (!ok) continue;
+        // 단계가 똑같은 패턴이 앞에 있으면 그쪽만 맞는다.
+        bool dup = false;
+        for (size_t q = 0; q < pi && !dup; ++q) {
+          if (pats[q].size() != L) continue;
+          bool same = true;
+          for (size_t i = 0; i < L; ++i) {
+            if (pats[q][i].button != p[i].button || pats[q][i].action != p[i].action) same = false;
+          }
+          dup = same;
+        }
+        if (dup) continue;
+        mask |= 1UL << pi;
+        if (L > foundLen) {
+          foundLen = L;
+          found = static_cast<int>(pi);
+        }
+      }
+      if (best == 0) hist.clear();
+      else hist.erase(hist.begin(), hist.end() - best);
+      if (found >= 0 && leaf(best)) hist.clear();
+      return found;
+    }
+  };
+
+  void testHandPicked() {
+    GestureMatcher<2> g;
+    const GestureStep unlock[] = { { 0, CLICK, 0 }, { 1, LONGPRESS, 1000 } };
+    const GestureStep aba[] = { { 0, CLICK, 0 }, { 1, CLICK, 500 }, { 0, CLICK, 500 } };
+    CHECK_EQ(g.add(unlock, 2), 0);
+    CHECK_EQ(g.add(aba, 3), 1);
+    g.compile();
+    CHECK_EQ(g.getStateCount(), 5); // 루트, A, A-B롱, A-B, A-B-A. A를 같이 쓴다.
+
+    CHECK_EQ(g.feed(0, CLICK, 0), -1);
+    CHECK_EQ(g.feed(1, LONGPRESS, 900), 0);
+    // 1초를 넘기면 안 맞는다.
+    g.feed(0, CLICK, 2000);
+    CHECK_EQ(g.feed(1, LONGPRESS, 3100), -1);
+    // A B A B A에서 A-B-A는 한 번만.
+    int got[5];
+    unsigned long t = 5000;
+    for (int i = 0; i < 5; ++i) got[i] = g.feed(i & 1, CLICK, t += 200);
+    CHECK_EQ(got[2], 1);
+    CHECK_EQ(got[0] + got[1] + got[3] + got[4], -4);
+  }
+
+  // A-A-B의 둘째 간격이 늦으면 뒤의 A-B로 넘어간다.
+  void testFallBackToShorter() {
+    GestureMatcher<2> g;
+    const GestureStep aab[] = { { 0, CLICK, 0 }, { 0, CLICK, 200 }, { 1, CLICK, 200 } };
+    const GestureStep ab[] = { { 0, CLICK, 0 }, { 1, CLICK, 1000 } };
+    g.add(aab, 3);
+    g.add(ab, 2);
+    g.feed(0, CLICK, 0);
+    g.feed(0, CLICK, 100);
+    CHECK_EQ(g.feed(1, CLICK, 700), 1);
+  }
+
+  void testRandomAgainstReference() {
+    srand(1);
+    long mismatches = 0;
+    long matches = 0;
+    for (int trial = 0; trial < 3000; ++trial) {
+      GestureMatcher<3, 6, 20> g;
+      Ref ref;
+      int patterns = 1 + rand() % 6;
+      int used = 0;
+      for (int p = 0; p < patterns; ++p) {
+        int len = 1 + rand() % 4;
+        if (used + len > 20) break;
+        Pattern v;
+        for (int i = 0; i < len; ++i) {
+          GestureStep s;
+          s.button = rand() % 3;
+          s.action = 1 + rand() % 2;
+          s.within = (rand() % 3 == 0) ? 0 : 100 + 100 * (rand() % 5);
+          v.push_back(s);
+        }
+        if (g.add(v.data(), len) >= 0) {
+          ref.pats.push_back(v);
+          used += len;
+        }
+      }
+      unsigned long t = 0;
+      for (int k = 0; k < 60; ++k) {
+        Ev e;
+        e.b = rand() % 3;
+        e.a = 1 + rand() % 3; // 패턴에 없는 액션도 섞는다.
+        t += rand() % 700;
+        e.t = t;
+        uint32_t mask;
+        int want = ref.feed(e, mask);
+        int got = g.feed(e.b, e.a, e.t);
+        if (got >= 0) ++matches;
+        if (want != got || mask != g.getMatches()) {
+          if (mismatches < 5) std::printf("trial %d step %d: want %d (%lx) got %d (%lx)\n", trial, k, want, static_cast<unsigned long>(mask), got, static_cast<unsigned long>(g.getMatches()));
+          ++mismatches;
+        }
+      }
+    }
+    CHECK_EQ(mismatches, 0);
+    CHECK(matches > 1000); // 맞는 경우가 충분히 나와야 비교가 의미 있다.
+  }
+}
+
+int main() {
+  host::setSerialEnabled(false);
+  testHandPicked();
+  testFallBackToShorter();
+  testRandomAgainstReference();
+  return testResult();
+}
@@ -0,0 +1,109 @@
+// MCP23017Input 테스트. 가상 칩 MCP23017Sim을 버스 자리에 넣고, 설정 레지스터와
+// "INT가 떠 있을 때만 읽는다", 읽기 실패 후 다시 읽기, INT 핀 없이 매번 읽기를 확인한다.
+
+#include <Arduino.h>
+#include <vector>
+#include "MCP23017Input.h"
+#include "test_check.h"
+
+namespace {
+  const uint8_t INT_PIN = 7;
+
+  struct Seen {
+    uint8_t key;
+    int8_t action;
+  };
+
+  template <class Input>
+  void step(Input& input, Button* keys, unsigned long ms, std::vector<Seen>& out) {
+    for (unsigned long i = 0; i < ms; ++i) {
+      host::advanceMillis(1);
+      input.scan();
+      for (uint8_t k = 0; k < 16; ++k) {
+        int8_t a = keys[k].event();
+        if (a) out.push_back({ k, a });
+      }
+    }
+  }
+
+  void testInterruptDriven() {
+    host::reset();
+    host::setMillis(1000);
+    MCP23017Sim sim(0x20, INT_PIN);
+    MCP23017Input<MCP23017Sim> input(sim, 0x20, INT_PIN);
+    Button keys[16];
+    CHECK(input.begin());
+    input.attach(keys, 16);
+
+    // 16핀 입력 + 풀업, 변화 인터럽트, INT 미러 + 오픈드레인.
+    CHECK_EQ(sim.getRegister(MCP23017_IOCON), MCP23017_IOCON_MIRROR | MCP23017_IOCON_ODR);
+    CHECK_EQ(sim.getRegister(MCP23017_IODIRA), 0xFF);
+    CHECK_EQ(sim.getRegister(MCP23017_IODIRA + 1), 0xFF);
+    CHECK_EQ(sim.getRegister(MCP23017_GPPUA), 0xFF);
+    CHECK_EQ(sim.getRegister(MCP23017_GPPUA + 1), 0xFF);
+    CHECK_EQ(sim.getRegister(MCP23017_GPINTENA), 0xFF);
+    CHECK_EQ(sim.getRegister(MCP23017_GPINTENA + 1), 0xFF);
+
+    // 아무것도 안 바뀌면 버스를 건드리지 않는다.
+    std::vector<Seen> seen;
+    sim.resetCounters();
+    step(input, keys, 100, seen);
+    CHECK_EQ(sim.getTransactions(), 0);
+    CHECK(seen.empty());
+
+    // 클릭 두 번(GPA3, GPB4). 변화 하나에 버스트 읽기 하나.
+    uint32_t reads = input.getReads();
+    sim.setInput(3, LOW);
+    step(input, keys, 80, seen);
+    sim.setInput(3, HIGH);
+    step(input, keys, 600, seen);
+    sim.setInput(12, LOW);
+    step(input, keys, 50, seen);
+    CHECK(input.isPressed(12));
+    CHECK_EQ(digitalRead(INT_PIN), HIGH); // 읽었으니 INT는 내려갔다(HIGH).
+    sim.setInput(12, HIGH);
+    step(input, keys, 600, seen);
+
+    CHECK_EQ(seen.size(), 2);
+    if (seen.size() == 2) {
+      CHECK_EQ(seen[0].key, 3);
+      CHECK_EQ(seen[0].action, CLICK);
+      CHECK_EQ(seen[1].key, 12);
+      CHECK_EQ(seen[1].action, CLICK);
+    }
+    CHECK_EQ(input.getReads() - reads, 4);
+    CHECK_EQ(sim.getBytesRead(), 4 * 2);
+    CHECK_EQ(input.getErrors(), 0);
+
+    // 읽기가 실패하면 INT가 그대로라 scan()마다 다시 읽어본다. 버스가 돌아오면 그때의 입력이 보인다.
+    seen.clear();
+    sim.setFail(true);
+    sim.setInput(0, LOW);
+    step(input, keys, 5, seen);
+    CHECK_EQ(input.getErrors(), 5);
+    CHECK(!input.isPressed(0));
+    sim.setFail(false);
+    step(input, keys, 5, seen);
+    CHECK(input.isPressed(0));
+    CHECK_EQ(digitalRead(INT_PIN), HIGH);
+  }
+
+  // INT 핀이 없으면 scan()마다 읽는다. 레지스터 주소 쓰기 + 2바이트 읽기.
+  void testPolling() {
+    host::reset();
+    MCP23017Sim sim(0x20);
+    MCP23017Input<MCP23017Sim> input(sim, 0x20);
+    CHECK(input.begin());
+    sim.resetCounters();
+    for (int i = 0; i < 100; ++i) input.scan();
+    CHECK_EQ(sim.getTransactions(), 200);
+    CHECK_EQ(sim.getBytesRead(), 200);
+  }
+}
+
+int main() {
+  host::setSerialEnabled(false);
+  testInterruptDriven();
+  testPolling();
+  return testResult();
+}
@@ -0,0 +1,238 @@
+// UniversalQueue 테스트. 기본 FIFO, 오버플로 정책별 동작과 카운터, 대기 슬롯 비우기, 스레드 사이 전달, PriorityQueue, ActionExecutor 멈추기.
+
+#include <Arduino.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "RamjiButton.h"
+#include "UniversalQueue.h"
+#include "test_check.h"
+
+namespace {
+  struct ActionCount {
+    int8_t action;
+    uint8_t repeat;
+  };
+
+  bool mergeAction(ActionCount& pending, const ActionCount& incoming) {
+    if (pending.action != incoming.action) return false;
+    pending.repeat += incoming.repeat;
+    return true;
+  }
+
+  void testFifo() {
+    UniversalQueue<int> q(3);
+    CHECK(q.isInitialized());
+    CHECK(q.isEmpty());
+    CHECK_EQ(q.capacity(), 3);
+    for (int i = 1; i <= 3; ++i) CHECK(q.push(i));
+    CHECK(q.isFull());
+    CHECK_EQ(q.size(), 3);
+    int out = 0;
+    for (int i = 1; i <= 3; ++i) {
+      CHECK(q.pop(out));
+      CHECK_EQ(out, i);
+    }
+    CHECK(!q.pop(out));
+  }
+
+  void testReject() {
+    UniversalQueue<int> q(2);
+    int v[] = { 1, 2, 3 };
+    CHECK_EQ(q.pushN(v, 3), 2);
+    CHECK(!q.push(v[2]));
+    QueueStats st = q.getStats();
+    CHECK_EQ(st.pushed, 2);
+    CHECK_EQ(st.rejected, 2);
+    int out[4];
+    CHECK_EQ(q.popN(out, 4), 2);
+    CHECK_EQ(out[0], 1);
+    CHECK_EQ(out[1], 2);
+  }
+
+  void testDropOldest() {
+    UniversalQueue<int> q(2);
+    CHECK(q.setOverflowPolicy(OVERFLOW_DROP_OLDEST));
+    for (int i = 1; i <= 5; ++i) CHECK(q.push(i));
+    int out[4];
+    CHECK_EQ(q.popN(out, 4), 2);
+    CHECK_EQ(out[0], 4);
+    CHECK_EQ(out[1], 5);
+    CHECK_EQ(q.getStats().droppedOldest, 3);
+
+    // 정책이 있으면 pushN()은 timeout_ms를 무시하고 가득 찬 큐에서도 바로 돌아온다.
+    for (int i = 6; i <= 7; ++i) CHECK(q.push(i));
+    const int more[2] = { 8, 9 };
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    CHECK_EQ(q.pushN(more, 2, 500), 2);
+    CHECK(std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(100));
+    CHECK_EQ(q.popN(out, 4), 2);
+    CHECK_EQ(out[0], 8);
+    CHECK_EQ(out[1], 9);
+  }
+
+  void testKeepLatest() {
+    UniversalQueue<int> q(3);
+    CHECK(q.setOverflowPolicy(OVERFLOW_KEEP_LATEST));
+    for (int i = 1; i <= 5; ++i) CHECK(q.push(i));
+    int out[4];
+    CHECK_EQ(q.popN(out, 4), 2);
+    CHECK_EQ(out[0], 4);
+    CHECK_EQ(out[1], 5);
+    CHECK_EQ(q.getStats().overwritten, 3);
+  }
+
+  void testCoalesce() {
+    UniversalQueue<ActionCount> q(2);
+    // 합치는 함수 없이는 못 바꾼다. 정책은 그대로 REJECT.
+    CHECK(!q.setOverflowPolicy(OVERFLOW_COALESCE));
+    ActionCount one = { CLICK, 1 };
+    CHECK(q.push(one));
+    CHECK(q.push(one));
+    CHECK(!q.push(one));
+
+    ActionCount drained[2];
+    CHECK_EQ(q.popN(drained, 2), 2);
+    q.resetStats();
+    CHECK(q.setOverflowPolicy(OVERFLOW_COALESCE, mergeAction));
+    const ActionCount seq[] = {
+      { CLICK, 1 }, { DOUBLECLICK, 1 }, { MANYPRESS, 1 }, { MANYPRESS, 1 }, { MANYPRESS, 1 },
+      { TRIPLECLICK, 1 }, { TRIPLECLICK, 1 }, { LONGPRESS, 1 },
+    };
+    for (ActionCount a : seq) q.push(a);
+
+    // 가득 찬 뒤로는 같은 것끼리 모이고, 다른 게 오면 모인 걸 넣으면서 가장 오래된 걸 밀어낸다.
+    const ActionCount expect[] = { { MANYPRESS, 3 }, { TRIPLECLICK, 2 }, { LONGPRESS, 1 } };
+    ActionCount out;
+    size_t n = 0;
+    while (q.pop(out)) {
+      if (n < 3) {
+        CHECK_EQ(out.action, expect[n].action);
+        CHECK_EQ(out.repeat, expect[n].repeat);
+      }
+      ++n;
+    }
+    CHECK_EQ(n, 3);
+    CHECK(q.isEmpty());
+    QueueStats st = q.getStats();
+    CHECK_EQ(st.pushed, 5);
+    CHECK_EQ(st.droppedOldest, 2);
+    CHECK_EQ(st.coalesced, 3);
+  }
+
+  // 대기 슬롯에 남은 마지막 것도 popN()이 가져간다.
+  void testCoalescePendingDrain() {
+    UniversalQueue<ActionCount> q(2);
+    CHECK(q.setOverflowPolicy(OVERFLOW_COALESCE, mergeAction));
+    const ActionCount items[] = { { CLICK, 1 }, { DOUBLECLICK, 1 }, { LONGPRESS, 1 } };
+    CHECK_EQ(q.pushN(items, 3), 3);
+    CHECK_EQ(q.size(), 3);
+    ActionCount out[8];
+    size_t n = q.popN(out, 8);
+    CHECK_EQ(n, 3);
+    if (n == 3) CHECK_EQ(out[2].action, LONGPRESS);
+    CHECK(q.isEmpty());
+  }
+
+  // 생산자와 소비자 스레드. 기다리는 push/pop으로 하나도 빠지지 않고 순서대로 간다.
+  void testThreads() {
+    UniversalQueue<uint32_t> q(8);
+    const uint32_t count = 20000;
+    std::thread producer([&]() {
+      for (uint32_t i = 0; i < count; ++i) {
+        uint32_t v = i;
+        while (!q.push(v, 100)) {}
+      }
+    });
+    uint32_t expected = 0;
+    uint32_t wrong = 0;
+    while (expected < count) {
+      uint32_t v;
+      if (!q.pop(v, 100)) continue;
+      if (v != expected) ++wrong;
+      ++expected;
+    }
+    producer.join();
+    CHECK_EQ(wrong, 0);
+    CHECK(q.isEmpty());
+  }
+
+  void testPriority() {
+    PriorityQueue<int> q(4);
+    CHECK(q.isInitialized());
+    int a = 1, b = 2, c = 3;
+    CHECK(q.push(a, PRIORITY_REPEAT));
+    CHECK(q.push(b, PRIORITY_COMBO));
+    CHECK(q.push(c, PRIORITY_DISCRETE));
+    int out = 0;
+    CHECK(q.pop(out));
+    CHECK_EQ(out, 3);
+    CHECK(q.pop(out));
+    CHECK_EQ(out, 2);
+    CHECK(q.pop(out));
+    CHECK_EQ(out, 1);
+    CHECK(q.isEmpty());
+  }
+
+  // 남는 초인종. 오버플로 정책으로 버려진 아이템이나 다른 쪽이 먼저 가져간 아이템의 초인종에 깨어나도
+  // pop()은 처음 준 시간 안에 돌아오고, 초인종 큐가 그런 것들로 가득 차도 push()는 새 아이템을 알린다.
+  void testPriorityStaleDoorbell() {
+    PriorityQueue<int> q(1); // 단계마다 1칸, 초인종 3칸.
+    q.level(PRIORITY_REPEAT).setOverflowPolicy(OVERFLOW_DROP_OLDEST);
+    for (int i = 0; i < 5; ++i) CHECK(q.push(i, PRIORITY_REPEAT));
+    int out = -1;
+    CHECK(q.pop(out, 100));
+    CHECK_EQ(out, 4);
+
+    // 40ms마다 아이템을 넣었다가 pop()보다 먼저 단계 큐에서 직접 가져간다. 초인종만 남는다.
+    std::thread thief([&]() {
+      for (int i = 0; i < 6; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        int v = 100 + i;
+        q.push(v, PRIORITY_DISCRETE);
+        q.level(PRIORITY_DISCRETE).pop(v, 0);
+      }
+    });
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    q.pop(out, 300); // 가져간 게 있으면 일찍 돌아와도 된다.
+    long waited = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t0).count());
+    thief.join();
+    CHECK(waited < 450); // 남는 초인종마다 300ms를 처음부터 다시 기다리면 500ms가 넘는다.
+  }
+
+  std::atomic<uint32_t> executorRuns{0};
+
+  void countRepeat(uint8_t, int8_t, uint8_t repeat, void*) {
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+    executorRuns.fetch_add(repeat, std::memory_order_relaxed);
+  }
+
+  // ActionExecutor. 소멸자는 작업 스레드를 끊지 않고 큐에 남은 작업까지 끝낸 뒤 멈춘다.
+  void testExecutorStop() {
+    {
+      ActionExecutor<2> ex(16);
+      ex.setHandler(countRepeat);
+      CHECK(ex.begin());
+      for (uint8_t i = 0; i < 24; ++i) CHECK(ex.dispatch(i % 3, CLICK, 2));
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      CHECK(ex.getExecuted(0) + ex.getExecuted(1) <= 24u);
+    }
+    CHECK_EQ(executorRuns.load(), 48u);
+  }
+}
+
+int main() {
+  host::setSerialEnabled(false);
+  testFifo();
+  testReject();
+  testDropOldest();
+  testKeepLatest();
+  testCoalesce();
+  testCoalescePendingDrain();
+  testThreads();
+  testPriority();
+  testPriorityStaleDoorbell();
+  testExecutorStop();
+  return testResult();
+}
@@ -0,0 +1,35 @@
+#ifndef RAMJI_TEST_CHECK_H
+#define RAMJI_TEST_CHECK_H
+
+// 호스트 테스트용 최소한의 확인 매크로. ctest가 종료 코드로 성공/실패를 본다.
+// 실패해도 멈추지 않고 끝까지 돈 다음, main()이 return testResult(); 로 끝낸다.
+
+#include <cstdio>
+
+static int testFailures = 0;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      ++testFailures; \
+    } \
+  } while (0)
+
+#define CHECK_EQ(a, b) \
+  do { \
+    long long va_ = static_cast<long long>(a); \
+    long long vb_ = static_cast<long long>(b); \
+    if (va_ != vb_) { \
+      std::printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, va_, vb_); \
+      ++testFailures; \
+    } \
+  } while (0)
+
+static inline int testResult() {
+  if (testFailures) std::printf("%d check(s) failed\n", testFailures);
+  else std::printf("ok\n");
+  return testFailures ? 1 : 0;
+}
+
+#endif //RAMJI_TEST_CHECK_H
@@ -0,0 +1,176 @@
+#ifndef ANALOGLADDER_H
+#define ANALOGLADDER_H
+
+// AnalogLadder<MaxKeys, MaxBands>
+// - 저항 래더 키패드를 ADC 하나로 읽는 입력 소스. 키마다 다른 저항이 걸려서 눌린 키에 따라 전압이 달라진다.
+//   ADC 핀 하나(또는 CD74HC4067의 ANALOG_INPUT 채널 하나)로 키 5 ~ 10개.
+// - scan() 한 번에 setOversample()개를 연달아 읽어 평균을 낸다. 그 평균을 보정된 전압 구간(band)에 넣어 눌린 키를 정한다.
+//   결과는 KeyBitmap에 들어가서 attach()한 Button들과 TwoButtonCombo가 그대로 판정한다.
+// - 구간은 중심값으로 정한다. 각 구간의 경계는 이웃 중심값과의 가운데. 아무것도 안 눌린 전압도 구간 하나(setIdle).
+//   여러 키를 같이 누를 수 있는 래더(R-2R 등)는 addBand(중심값, 키 비트마스크)로 조합 전압을 따로 넣는다.
+// - 흔들림 방지 두 가지
+//   1) 히스테리시스: 지금 구간에서 벗어나려면 새 구간의 중심이 지금 중심보다 setHysteresis()만큼 더 가까워야 한다.
+//   2) 확인: 새 구간이 setConfirm()번 연속으로 나와야 바꾼다. 키를 뗄 때 전압이 다른 키 구간을 지나가는 걸 걸러낸다.
+//   채터링 판정은 그 뒤에 Button이 하던 대로 한다.
+// - 중심값은 ADC 단위(10비트면 0 ~ 1023). 저항값에서 구하려면 level(), 실제 보드에서 재려면 키를 누른 채 readAverage().
+// - 먹스 채널로 쓰면 scan()마다 채널을 바꾸고 setSettle()만큼 기다린다. 기본 3000us는 aRead(channel)의 delay(3)과 같다.
+//   먹스는 ANALOG_INPUT 모드로 만들어야 한다.
+//
+// // 풀업 10k, 키마다 GND 쪽 저항 0, 1k, 2.2k, 4.7k, 10k
+// AnalogLadder<5> ladder(A0);
+// setup: ladder.setIdle(1023);
+//        const float r[5] = { 0, 1000, 2200, 4700, 10000 };
+//        for (int k = 0; k < 5; k++) ladder.addKey(k, AnalogLadder<5>::level(10000, r[k], 1023));
+//        ladder.attach(keys, 5);
+// loop: ladder.scan(); for (int i = 0; i < 5; i++) { int8_t a = keys[i].event(); if (a) keys[i].doIt(a); }
+
+#include <Arduino.h>
+#include "RamjiButton.h"
+
+template <size_t MaxKeys = 10, size_t MaxBands = MaxKeys + 1>
+class AnalogLadder : public KeyBitmap<MaxKeys> {
+  static_assert(MaxKeys > 0 && MaxKeys <= 32, "AnalogLadder supports 1 to 32 keys.");
+  static_assert(MaxBands > 0 && MaxBands <= 64, "AnalogLadder supports 1 to 64 bands.");
+
+public:
+  explicit AnalogLadder(uint8_t pin) : _pin(pin), _mux(nullptr), _channel(0) {}
+  AnalogLadder(CD74HC4067& mux, uint8_t channel) : _pin(0xFF), _mux(&mux), _channel(channel) {}
+
+  // 풀업 rTop과 키 쪽 저항 rBottom으로 된 분압기의 ADC 값. fullScale은 10비트면 1023, 12비트면 4095.
+  static uint16_t level(float rTop, float rBottom, uint16_t fullScale = 1023) {
+    if (rTop + rBottom <= 0) return 0;
+    return static_cast<uint16_t>(fullScale * rBottom / (rTop + rBottom) + 0.5f);
+  }
+
+  // 중심값 center에서 keys 비트마스크의 키들이 눌린 것으로 본다. 같은 중심값이 있으면 마스크만 바꾼다. 꽉 찼으면 false.
+  bool addBand(uint16_t center, uint32_t keys) {
+    keys &= keyMask();
+    for (size_t i = 0; i < _count; ++i) {
+      if (_bands[i].center == center) {
+        _bands[i].keys = keys;
+        return true;
+      }
+    }
+    if (_count >= MaxBands) return false;
+    // 중심값 순으로 넣어둔다. 찾을 때 이웃 구간만 보면 된다.
+    size_t i = _count++;
+    while (i > 0 && _bands[i - 1].center > center) {
+      _bands[i] = _bands[i - 1];
+      --i;
+    }
+    _bands[i].center = center;
+    _bands[i].keys = keys;
+    _current = -1;
+    _candidate = -1;
+    return true;
+  }
+  bool addKey(uint8_t key, uint16_t center) { return key < MaxKeys && addBand(center, 1UL << key); }
+  bool setIdle(uint16_t center) { return addBand(center, 0); }
+  void clearBands() {
+    _count = 0;
+    _current = -1;
+    _candidate = -1;
+  }
+
+  // 한 번에 평균 낼 샘플 수. 기본 8.
+  void setOversample(uint8_t samples) { _samples = samples ? samples : 1; }
+  // ADC 단위. 기본 8.
+  void setHysteresis(uint16_t counts) { _hysteresis = counts; }
+  // 새 구간이 몇 번 연속 나와야 바꾸는지. 기본 2.
+  void setConfirm(uint8_t scans) { _confirm = scans ? scans : 1; }
+  // 먹스 채널을 바꾼 뒤 기다리는 시간(us).
+  void setSettle(uint32_t us) { _settleUs = us; }
+
+  // 채널을 고르고 setOversample()개를 읽어서 반올림한 평균.
+  uint16_t readAverage() {
+    if (_mux) {
+      _mux->selectChannel(_channel);
+      if (_settleUs) delayMicroseconds(_settleUs);
+    }
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < _samples; ++i) sum += static_cast<uint32_t>(_mux ? _mux->aRead() : analogRead(_pin));
+    return static_cast<uint16_t>((sum + _samples / 2) / _samples);
+  }
+
+  // 한 번 읽고 분류해서 비트맵을 갱신한다. 바뀐 키가 있으면 true.
+  bool scan() {
+    _value = readAverage();
+    ++_scans;
+    if (_count == 0) return false;
+
+    int16_t band = nearest(_value);
+    if (_current >= 0 && band != _current) {
+      // 새 구간 중심이 지금 중심보다 hysteresis만큼 더 가까워야 벗어난다.
+      uint16_t dCur = distance(_value, _bands[_current].center);
+      uint16_t dNew = distance(_value, _bands[band].center);
+      if (dCur < dNew + _hysteresis) band = _current;
+    }
+    if (band == _current) {
+      _candidate = -1;
+      _seen = 0;
+      return false;
+    }
+    if (band != _candidate) {
+      _candidate = band;
+      _seen = 0;
+    }
+    // 처음 한 번(_current < 0)은 확인 없이 바로.
+    if (_current >= 0 && ++_seen < _confirm) return false;
+
+    _current = band;
+    _candidate = -1;
+    _seen = 0;
+    uint32_t keys = _bands[band].keys;
+    bool changed = false;
+    for (size_t k = 0; k < MaxKeys; ++k) {
+      if (this->setKey(static_cast<uint16_t>(k), (keys >> k) & 1u)) changed = true;
+    }
+    if (changed) ++_transitions;
+    return changed;
+  }
+
+  // 마지막 평균값.
+  uint16_t getValue() { return _value; }
+  // 지금 구간의 키 비트마스크. 아직 분류 전이면 0.
+  uint32_t getKeys() { return (_current >= 0) ? _bands[_current].keys : 0; }
+  // 지금 구간 번호(중심값 순). 아직이면 -1.
+  int16_t getBand() { return _current; }
+  uint16_t getBandCenter(uint8_t band) { return (band < _count) ? _bands[band].center : 0; }
+  uint8_t getBandCount() { return static_cast<uint8_t>(_count); }
+  uint32_t getScans() { return _scans; }
+  uint32_t getTransitions() { return _transitions; }
+
+private:
+  struct Band {
+    uint16_t center;
+    uint32_t keys;
+  };
+
+  uint8_t _pin;
+  CD74HC4067* _mux;
+  uint8_t _channel;
+  Band _bands[MaxBands];
+  size_t _count = 0;
+  uint8_t _samples = 8;
+  uint16_t _hysteresis = 8;
+  uint8_t _confirm = 2;
+  uint32_t _settleUs = 3000;
+  int16_t _current = -1;
+  int16_t _candidate = -1;
+  uint8_t _seen = 0;
+  uint16_t _value = 0;
+  uint32_t _scans = 0;
+  uint32_t _transitions = 0;
+
+  static uint32_t keyMask() { return (MaxKeys >= 32) ? 0xFFFFFFFFUL : ((1UL << MaxKeys) - 1); }
+  static uint16_t distance(uint16_t a, uint16_t b) { return (a > b) ? a - b : b - a; }
+
+  int16_t nearest(uint16_t v) {
+    size_t i = 0;
+    while (i + 1 < _count && _bands[i + 1].center <= v) ++i;
+    if (i + 1 < _count && distance(v, _bands[i + 1].center) < distance(v, _bands[i].center)) ++i;
+    return static_cast<int16_t>(i);
+  }
+};
+
+#endif //ANALOGLADDER_H
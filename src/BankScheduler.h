@@ -0,0 +1,283 @@
+#ifndef BANKSCHEDULER_H
+#define BANKSCHEDULER_H
+
+// BankScheduler<MaxItems>
+// - 큰 버튼 뱅크를 한 번에 다 훑지 않고, loop()가 부를 때마다 정해진 시간(또는 개수)만큼만 돌아가며 처리한다.
+//   예제 03의 buttonCheckAndExecute()처럼 24채널 + 조합 4개를 한 번에 돌면 loop()가 한참 멈추는데, 그 멈춤을 예산 안으로 자른다.
+// - 버튼과 조합을 항목(item)으로 등록한다. 등록 순서대로 돌고, 끝까지 가면 한 바퀴(sweep).
+//   바퀴는 주기(setPeriod)마다 한 번 시작한다. 일찍 끝나면 다음 주기까지 run()은 아무것도 안 하고 바로 돌아간다.
+// - 보장: 모든 항목은 주기마다 한 번은 event()가 불린다. 바퀴가 주기를 넘기면(마감을 놓치면)
+//   그 호출에서는 예산을 무시하고 남은 항목을 끝까지 처리한다. setStrictBudget(true)면 예산을 지키는 대신 늦어진 만큼을 보고만 한다.
+// - 얼마나 밀렸는지: getLag()는 지금 바퀴가 주기를 넘긴 ms, getMaxLag()는 지금까지 최대, getOverruns()는 주기를 넘긴 바퀴 수.
+// - 판정된 액션은 setHandler()로 준 함수로 온다. 핸들러가 없으면 예제처럼 button.doIt(), 조합은 bt1/bt2/combo의 doIt()을 부른다.
+// - CD74HC4067 채널에 붙은 버튼은 addButton(button, &mux, channel). event() 전에 채널을 바꾸고 setMuxSettle()만큼 기다린다.
+//   조합은 TwoButtonCombo가 알아서 채널을 바꾼다.
+// - 쉴 때 천천히: setIdlePeriod()를 주면 모든 항목이 isIdle()(안 눌림, 대기 중인 판정 없음)인 채로
+//   setIdleAfter()만큼 지나면 바퀴 주기를 idle 주기로 늘린다. 한 항목이라도 눌리거나 판정을 기다리기 시작하면
+//   그 자리에서 바로 원래 주기로 돌아온다.
+//   단, 깨워줄 곳(wake 소스)이 있어야 idle로 넘어간다. 바퀴로만 누름을 찾으면 쉬는 동안의 첫 누름이 idle 주기만큼 늦게 보이고,
+//   그만큼 누름 시간이 짧게 재져서 짧은 클릭이 무효가 될 수 있기 때문이다.
+//   - setWakePin(): 공통 INT 선(MCP23017 INT, 다이오드 OR 등). 쉬는 동안 run()마다 그 핀 하나만 읽고, 활성이면 바로 한 바퀴를 돈다.
+//   - setWakeInterrupt(true): 핀 변화 인터럽트에서 wake()를 부르는 경우. 다음 run()이 기다리지 않고 바로 한 바퀴를 돈다.
+//   둘 다 누름이 run() 한 번 안에 보이므로 idle 주기를 1초로 해도 누름 지연이 늘지 않는다.
+//   먹스만 있는 회로처럼 wake 소스가 없으면 idle 주기를 줘도 원래 주기로 계속 돈다.
+//
+// BankScheduler<32> scheduler;
+// for (int i = 0; i < 12; i++) scheduler.addButton(button_4067_1[i], &mux1, i);
+// scheduler.addCombo(buttonCombo1);
+// scheduler.setPeriod(10);      // 모든 버튼을 10ms마다 한 번은.
+// scheduler.setBudget(500);     // run() 한 번에 최대 500us.
+// scheduler.setWakePin(intPin); // 버튼 하나라도 눌리면 LOW가 되는 공통 선.
+// scheduler.setIdlePeriod(1000); // 2초 동안 아무것도 안 눌리면 1초마다.
+// loop: scheduler.run();
+
+#include <Arduino.h>
+#include "RamjiButton.h"
+
+// 핸들러. item은 등록 순서 번호. 조합이면 output 0: 버튼1, 1: 버튼2, 2: 조합. 버튼이면 항상 0.
+typedef void (*BankHandler)(uint8_t item, uint8_t output, int8_t action, uint8_t repeat, void* ctx);
+
+template <size_t MaxItems = 32>
+class BankScheduler {
+  static_assert(MaxItems > 0 && MaxItems <= 255, "BankScheduler supports 1 to 255 items.");
+
+public:
+  BankScheduler() {}
+
+  // 등록 번호를 돌려준다. 꽉 찼으면 -1.
+  int16_t addButton(Button& button, CD74HC4067* mux = nullptr, int8_t channel = -1) {
+    if (_count >= MaxItems) return -1;
+    Item& it = _items[_count];
+    it.button = &button;
+    it.combo = nullptr;
+    it.mux = (channel >= 0) ? mux : nullptr;
+    it.channel = channel;
+    return static_cast<int16_t>(_count++);
+  }
+
+  int16_t addCombo(TwoButtonCombo& combo) {
+    if (_count >= MaxItems) return -1;
+    Item& it = _items[_count];
+    it.button = nullptr;
+    it.combo = &combo;
+    it.mux = nullptr;
+    it.channel = -1;
+    return static_cast<int16_t>(_count++);
+  }
+
+  // 한 바퀴의 주기(ms). 모든 항목이 이 안에 한 번은 처리된다. 0이면 쉬지 않고 바로 다음 바퀴. 기본 10ms.
+  void setPeriod(unsigned long ms) { _period = ms; }
+  unsigned long getPeriod() { return _period; }
+
+  // run() 한 번의 예산. us는 시간(0이면 제한 없음), items는 항목 수(0이면 제한 없음). 둘 다 주면 먼저 닿는 쪽.
+  // 예산이 아무리 작아도 한 번에 최소 한 항목은 처리한다. 기본은 제한 없음(예전처럼 한 번에 한 바퀴).
+  void setBudget(uint32_t us, uint8_t items = 0) {
+    _budgetUs = us;
+    _budgetItems = items;
+  }
+
+  // true면 마감을 놓쳐도 예산을 지킨다. 대신 주기 보장이 깨지고 getLag()가 커진다.
+  void setStrictBudget(bool strict) { _strict = strict; }
+
+  // 먹스 채널을 바꾼 뒤 기다리는 시간(us). 기본 3000us는 예제들의 delay(3)과 같다.
+  // 74HC4067의 전환 시간은 수백 ns 수준이라 배선이 짧으면 수십 us로 줄여도 된다. 예산을 쓰려면 줄이는 게 좋다.
+  void setMuxSettle(uint32_t us) { _settleUs = us; }
+
+  // 쉴 때의 바퀴 주기(ms). 0이면 안 쓴다(기본). setIdleAfter()만큼 계속 쉬어야 idle로 넘어간다(히스테리시스). 기본 2000ms.
+  // wake 소스(setWakePin() 또는 setWakeInterrupt(true))가 없으면 idle로 넘어가지 않는다.
+  void setIdlePeriod(unsigned long ms) { _idlePeriod = ms; }
+  void setIdleAfter(unsigned long ms) { _idleAfter = ms; }
+  // 쉬는 동안 run()마다 읽을 공통 선. activeLevel이면 누름이 있다고 보고 바로 원래 주기로 한 바퀴를 돈다.
+  // pinMode는 이 핀을 쓰는 쪽(예: MCP23017Input)이 정한다. BUTTON_NO_PIN이면 안 쓴다(기본).
+  void setWakePin(uint8_t pin, uint8_t activeLevel = LOW) {
+    _wakePin = pin;
+    _wakeLevel = activeLevel;
+  }
+  // 핀 변화 인터럽트에서 wake()를 부른다면 true. 그래야 setWakePin() 없이도 idle로 넘어간다.
+  void setWakeInterrupt(bool enabled) { _wakeInterrupt = enabled; }
+  // 지금 idle 주기로 돌고 있는지.
+  bool isIdling() { return _idling; }
+  // 지금 쓰는 바퀴 주기.
+  unsigned long getCurrentPeriod() { return _idling ? _idlePeriod : _period; }
+  // ISR에서 불러도 된다. idle을 풀고 다음 run()이 기다리지 않고 바퀴를 시작한다.
+  void wake() { _wake = true; }
+  // wake 소스가 있어서 idle로 넘어갈 수 있는지.
+  bool canIdle() { return _idlePeriod > 0 && (_wakePin != BUTTON_NO_PIN || _wakeInterrupt); }
+
+  void setHandler(BankHandler handler, void* ctx = nullptr) {
+    _handler = handler;
+    _ctx = ctx;
+  }
+
+  // loop()에서 가능한 한 자주. 이번에 처리한 항목 수를 돌려준다.
+  uint8_t run() {
+    if (_count == 0) return 0;
+    unsigned long nowMs = millis();
+    bool woken = _wake;
+    // 쉬는 동안은 바퀴 대신 공통 선만 본다. 핀 하나 읽기라 idle 주기 사이에도 run()마다 해도 된다.
+    if (!woken && _idling && _wakePin != BUTTON_NO_PIN && digitalRead(_wakePin) == _wakeLevel) woken = true;
+    if (woken) {
+      _wake = false;
+      activate(nowMs);
+    }
+    if (_cursor == 0) {
+      unsigned long period = getCurrentPeriod();
+      if (woken || _sweeps == 0) {
+        _sweepStart = nowMs;
+      } else {
+        // 새 바퀴는 주기가 됐을 때만. 첫 바퀴는 바로.
+        if (nowMs - _sweepStart < period) return 0;
+        // 주기보다 늦게 시작하면 다음 주기는 지금부터. 밀린 바퀴를 몰아서 돌지는 않는다.
+        _sweepStart = (nowMs - _sweepStart < 2 * period) ? _sweepStart + period : nowMs;
+      }
+      if (_sweeps == 0) _idleSince = nowMs;
+      _sweepIdle = true;
+      if (_idling) ++_idleSweeps;
+    }
+
+    uint32_t startUs = micros();
+    uint8_t done = 0;
+    unsigned long period = getCurrentPeriod();
+    bool late = !_strict && period > 0 && (nowMs - _sweepStart >= period);
+    while (_cursor < _count) {
+      if (done > 0 && !late) {
+        if (_budgetItems && done >= _budgetItems) break;
+        if (_budgetUs && micros() - startUs >= _budgetUs) break;
+      }
+      process(_cursor);
+      ++_cursor;
+      ++done;
+      period = getCurrentPeriod(); // 도중에 idle이 풀리면 원래 주기로 잰다.
+      if (!late && !_strict && period > 0 && millis() - _sweepStart >= period) late = true;
+    }
+    _lastRunUs = micros() - startUs;
+    if (_lastRunUs > _maxRunUs) _maxRunUs = _lastRunUs;
+
+    if (_cursor >= _count) {
+      _cursor = 0;
+      ++_sweeps;
+      unsigned long endMs = millis();
+      unsigned long took = endMs - _sweepStart;
+      _lastSweep = took;
+      if (period > 0 && took > period) {
+        ++_overruns;
+        _lag = took - period;
+        if (_lag > _maxLag) _maxLag = _lag;
+      } else {
+        _lag = 0;
+      }
+      // 한 바퀴 내내 모두 쉬고 있었고 그게 idleAfter만큼 이어졌으면 idle로.
+      if (!_sweepIdle) _idleSince = endMs;
+      else if (!_idling && canIdle() && endMs - _idleSince >= _idleAfter) _idling = true;
+    }
+    return done;
+  }
+
+  // 지금 진행 중인 바퀴가 주기를 넘긴 ms. 바퀴가 끝났으면 그 바퀴의 값.
+  unsigned long getLag() {
+    unsigned long period = getCurrentPeriod();
+    if (_cursor > 0 && period > 0) {
+      unsigned long elapsed = millis() - _sweepStart;
+      if (elapsed > period) return elapsed - period;
+    }
+    return _lag;
+  }
+  unsigned long getMaxLag() { return _maxLag; }
+  uint32_t getOverruns() { return _overruns; }
+  uint32_t getSweeps() { return _sweeps; }
+  unsigned long getLastSweepTime() { return _lastSweep; }
+  uint32_t getLastRunMicros() { return _lastRunUs; }
+  uint32_t getMaxRunMicros() { return _maxRunUs; }
+  // idle 주기로 돈 바퀴 수.
+  uint32_t getIdleSweeps() { return _idleSweeps; }
+  void resetStats() {
+    _maxLag = 0;
+    _overruns = 0;
+    _maxRunUs = 0;
+    _idleSweeps = 0;
+  }
+
+  uint8_t size() { return static_cast<uint8_t>(_count); }
+  // 다음에 처리할 항목 번호. 0이면 바퀴 사이.
+  uint8_t getCursor() { return static_cast<uint8_t>(_cursor); }
+
+private:
+  struct Item {
+    Button* button;
+    TwoButtonCombo* combo;
+    CD74HC4067* mux;
+    int8_t channel;
+  };
+
+  Item _items[MaxItems];
+  size_t _count = 0;
+  size_t _cursor = 0;
+  unsigned long _period = 10;
+  uint32_t _budgetUs = 0;
+  uint8_t _budgetItems = 0;
+  bool _strict = false;
+  uint32_t _settleUs = 3000;
+  BankHandler _handler = nullptr;
+  void* _ctx = nullptr;
+  unsigned long _idlePeriod = 0;
+  unsigned long _idleAfter = 2000;
+  unsigned long _idleSince = 0;
+  bool _idling = false;
+  bool _sweepIdle = true;
+  volatile bool _wake = false;
+  uint8_t _wakePin = BUTTON_NO_PIN;
+  uint8_t _wakeLevel = LOW;
+  bool _wakeInterrupt = false;
+  uint32_t _idleSweeps = 0;
+
+  unsigned long _sweepStart = 0;
+  unsigned long _lastSweep = 0;
+  unsigned long _lag = 0;
+  unsigned long _maxLag = 0;
+  uint32_t _sweeps = 0;
+  uint32_t _overruns = 0;
+  uint32_t _lastRunUs = 0;
+  uint32_t _maxRunUs = 0;
+
+  // 눌림이나 대기 중인 판정이 보이면 바로 원래 주기로.
+  void activate(unsigned long nowMs) {
+    _idling = false;
+    _idleSince = nowMs;
+  }
+
+  void noteActivity(bool idle) {
+    if (idle) return;
+    _sweepIdle = false;
+    if (_idling) activate(millis());
+  }
+
+  void process(size_t i) {
+    Item& it = _items[i];
+    uint8_t item = static_cast<uint8_t>(i);
+    if (it.button) {
+      if (it.mux) {
+        it.mux->selectChannel(static_cast<uint8_t>(it.channel));
+        if (_settleUs) delayMicroseconds(_settleUs);
+      }
+      int8_t a = it.button->event();
+      noteActivity(it.button->isIdle());
+      if (a == NO_ACTION) return;
+      uint8_t repeat = it.button->getRepeatCount();
+      if (_handler) _handler(item, 0, a, repeat, _ctx);
+      else it.button->doIt(a, repeat);
+      return;
+    }
+    int8_t* events = it.combo->event();
+    noteActivity(it.combo->isIdle());
+    for (uint8_t k = 0; k < 3; ++k) {
+      if (events[k] == NO_ACTION) continue;
+      uint8_t repeat = it.combo->getRepeatCount(k);
+      if (_handler) _handler(item, k, events[k], repeat, _ctx);
+      else if (k == 0) it.combo->getBt1().doIt(events[k], repeat);
+      else if (k == 1) it.combo->getBt2().doIt(events[k], repeat);
+      else it.combo->doIt(events[k], repeat);
+    }
+  }
+};
+
+#endif //BANKSCHEDULER_H
@@ -0,0 +1,125 @@
+#ifndef BUTTONSTATEBANK_H
+#define BUTTONSTATEBANK_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <cstring>
+#include "RamjiButton.h"
+
+// 버튼 뱅크(최대 32개)의 상태 사진. 한 순간에 찍힌 값들이라 서로 어긋나지 않는다.
+template <size_t N>
+struct ButtonBankState {
+  uint32_t pressedMask = 0;           // 비트 i: 버튼 i가 눌려 있음.
+  unsigned long time = 0;             // 사진을 찍은 시간 (millis).
+  unsigned long downTime[N] = {0};    // 버튼 i가 마지막으로 눌린 시간.
+  unsigned long actionTime[N] = {0};  // 버튼 i의 마지막 액션이 판정된 시간.
+  int8_t lastAction[N] = {0};         // 버튼 i의 마지막 액션 번호.
+  uint8_t clickCount[N] = {0};        // 버튼 i의 아직 판정 안된 연속 클릭 수.
+
+  bool isPressed(size_t i) const { return i < N && ((pressedMask >> i) & 1UL); }
+  // 지금 누르고 있는 시간. 안 눌려 있으면 0.
+  unsigned long holdTime(size_t i) const { return isPressed(i) ? time - downTime[i] : 0; }
+};
+
+// ButtonStateBank<N>
+// - Button의 상태 변수들은 event()를 돌리는 스캔 코어(태스크) 것이라서, 다른 코어나 태스크에서 getter로 읽으면
+//   event()가 도는 도중의 어긋난 값을 읽을 수 있다.
+// - 스캔 쪽이 event()를 다 돌린 후 capture()로 뱅크 전체의 사진을 찍어두면, 다른 쪽은 read()로 락 없이 읽는다.
+// - seqlock 방식. 쓰는 쪽은 일련번호를 홀수로 올리고, 쓰고, 짝수로 올린다. 읽는 쪽은 복사 전후 번호가 같고 짝수일 때만 믿는다.
+//   쓰는 쪽은 절대 기다리지 않고, 읽는 쪽도 락을 잡지 않는다.
+// - 읽는 쪽이 같은 코어의 더 높은 우선순위 태스크면 쓰는 도중에 끼어들 수 있어서, read()는 몇 번만 다시 해보고 안되면 false.
+//   그럴 때는 지난번에 읽은 사진을 그대로 쓰면 된다.
+// - 눌림 비트만 필요하면 pressedMask()가 원자적인 32비트 읽기 하나로 끝난다.
+// - <atomic>을 쓰므로 ESP32, RP2040, 호스트용.
+//
+// #include "ButtonStateBank.h"
+// Button buttons[16] = { ... };
+// ButtonStateBank<16> bankState;
+//
+// // 스캔 코어 (core0 / 감지 태스크)
+// for (int i = 0; i < 16; i++) events[i] = buttons[i].event();
+// bankState.capture(buttons);
+//
+// // 다른 코어 (core1 / 화면 태스크)
+// ButtonBankState<16> s;
+// if (bankState.read(s)) {
+//   if (s.isPressed(3)) showHold(s.holdTime(3));
+// }
+template <size_t N>
+class ButtonStateBank {
+  static_assert(N > 0 && N <= 32, "ButtonStateBank supports 1 to 32 buttons.");
+
+public:
+  ButtonStateBank() : _seq(0), _pressedMask(0) {}
+
+  // non-copyable
+  ButtonStateBank(const ButtonStateBank&) = delete;
+  ButtonStateBank& operator=(const ButtonStateBank&) = delete;
+
+  // 스캔 코어에서만 부른다. buttons는 N개짜리 Button 배열.
+  void capture(Button* buttons, unsigned long t) {
+    beginWrite(t);
+    for (size_t i = 0; i < N; ++i) store(i, buttons[i]);
+    endWrite();
+  }
+  void capture(Button* buttons) { capture(buttons, millis()); }
+
+  // 여기저기 흩어진 버튼들일 때. N개짜리 포인터 배열. nullptr인 자리는 건너뛴다.
+  void capture(Button* const* buttons, unsigned long t) {
+    beginWrite(t);
+    for (size_t i = 0; i < N; ++i) {
+      if (buttons[i]) store(i, *buttons[i]);
+    }
+    endWrite();
+  }
+  void capture(Button* const* buttons) { capture(buttons, millis()); }
+
+  /**
+   * read(out, maxRetries)
+   * - 마지막으로 찍힌 사진을 out에 복사한다. 어느 코어, 어느 태스크에서든 부를 수 있다.
+   * - 쓰는 도중이라 maxRetries번 안에 깨끗한 사진을 못 얻으면 false. out은 쓰다 만 값일 수 있으니 버린다.
+   */
+  bool read(ButtonBankState<N>& out, uint8_t maxRetries = 8) {
+    for (uint8_t i = 0; i <= maxRetries; ++i) {
+      uint32_t s1 = _seq.load(std::memory_order_acquire);
+      if (s1 & 1) continue;
+      std::memcpy(&out, &_state, sizeof(out));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (_seq.load(std::memory_order_relaxed) == s1) return true;
+    }
+    return false;
+  }
+
+  // 눌림 비트만. 항상 성공한다.
+  uint32_t pressedMask() { return _pressedMask.load(std::memory_order_acquire); }
+
+  // 지금까지 찍은 사진 수. 바뀌었는지 확인할 때.
+  uint32_t version() { return _seq.load(std::memory_order_acquire) >> 1; }
+
+private:
+  std::atomic<uint32_t> _seq;         // 홀수면 쓰는 중.
+  std::atomic<uint32_t> _pressedMask;
+  ButtonBankState<N> _state;
+
+  void beginWrite(unsigned long t) {
+    _seq.store(_seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _state.time = t;
+    _state.pressedMask = 0;
+  }
+
+  void store(size_t i, Button& b) {
+    if (b.isPressed()) _state.pressedMask |= (1UL << i);
+    _state.downTime[i] = b.getDownTime();
+    _state.lastAction[i] = b.getLastAction();
+    _state.actionTime[i] = b.getActionTime(b.getLastAction());
+    _state.clickCount[i] = b.getClickCount();
+  }
+
+  void endWrite() {
+    _pressedMask.store(_state.pressedMask, std::memory_order_release);
+    _seq.store(_seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+};
+
+#endif //BUTTONSTATEBANK_H
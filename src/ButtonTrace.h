@@ -0,0 +1,107 @@
+#ifndef BUTTONTRACE_H
+#define BUTTONTRACE_H
+
+// ButtonTrace
+// - Button::debugPrint()의 String 출력 대신 쓰는 바이너리 트레이스. 레코드 하나 20바이트를 RAM 링 버퍼에 복사만 한다.
+//   출력(문자열 만들기, 시리얼 전송)은 나중에 drain()이 한다. 스캔 루프 타이밍을 거의 건드리지 않아서 켜놓은 채로 배포해도 된다.
+// - 버튼에 setTrace()로 붙이면 event()가 상태가 바뀔 때(핀 변화, 로직 전환, 짧은 누름 무효, 액션 판정)마다 알아서 기록한다.
+//   바뀐 게 없는 호출은 기록하지 않는다. debugPrint()도 붙어 있으면 출력 대신 기록한다.
+// - 쓰는 쪽 하나(스캔 루프나 감지 태스크), 읽는 쪽 하나(drain 태스크나 loop). 락 없음.
+//   다른 태스크에서 스캔하는 버튼들은 트레이스를 따로 쓴다.
+// - 꽉 차면 새 레코드를 버리고 getDropped()로 센다. 오래된 걸 덮어쓰면 읽는 쪽과 부딪히므로.
+// - 용량은 2의 거듭제곱. 아니면 그보다 작은 2의 거듭제곱으로 내려서 쓴다.
+// - <atomic>을 쓰므로 ESP32, RP2040, 호스트용. RamjiButton.h만 쓰는 스케치(AVR)에는 들어가지 않는다.
+//
+// #include "ButtonTrace.h"
+// StaticButtonTrace<64> trace;
+// button1.setTrace(&trace, 1);
+// button2.setTrace(&trace, 2);
+// // 낮은 우선순위 태스크나 loop의 한가한 자리에서.
+// trace.drain(8); // 한 번에 최대 8줄만 찍는다.
+
+#include <Arduino.h>
+#include <atomic>
+#include "RamjiButton.h"
+
+class ButtonTrace : public TraceSink {
+public:
+  // storage는 capacity개짜리 배열. 보통은 StaticButtonTrace<N>을 쓴다.
+  ButtonTrace(TraceRecord* storage, size_t capacity)
+    : _buf(storage), _mask(0), _head(0), _tail(0), _dropped(0), _enabled(true) {
+    // 2의 거듭제곱으로 내린다. 위치를 나머지 대신 마스크로 구하려고.
+    size_t n = 1;
+    while (n * 2 <= capacity) n *= 2;
+    _mask = (storage && capacity) ? static_cast<uint32_t>(n - 1) : 0;
+    if (!storage || !capacity) _enabled = false;
+  }
+
+  // non-copyable
+  ButtonTrace(const ButtonTrace&) = delete;
+  ButtonTrace& operator=(const ButtonTrace&) = delete;
+
+  // 쓰는 쪽. 꽉 찼거나 꺼져 있으면 false.
+  bool record(const TraceRecord& r) override {
+    if (!_enabled.load(std::memory_order_relaxed)) return false;
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    if (head - _tail.load(std::memory_order_acquire) > _mask) {
+      _dropped.store(_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return false;
+    }
+    _buf[head & _mask] = r;
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // 읽는 쪽. 비었으면 false.
+  bool pop(TraceRecord& out) {
+    uint32_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire)) return false;
+    out = _buf[tail & _mask];
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // 읽는 쪽. 최대 maxRecords개를 꺼내서 한 줄씩 Serial에 찍는다. 찍은 수를 돌려준다.
+  size_t drain(size_t maxRecords = 0xFFFF) {
+    TraceRecord r;
+    char line[TRACE_LINE_SIZE];
+    size_t n = 0;
+    while (n < maxRecords && pop(r)) {
+      if (format(r, line, sizeof(line)) >= 0) Serial.println(line);
+      ++n;
+    }
+    return n;
+  }
+
+  size_t available() { return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire); }
+  size_t capacity() { return _buf ? _mask + 1 : 0; }
+  uint32_t getDropped() { return _dropped.load(std::memory_order_relaxed); }
+  void resetDropped() { _dropped.store(0, std::memory_order_relaxed); }
+  // 끄면 record()가 바로 돌아간다. 버튼에 붙인 채로 켜고 끌 수 있다.
+  void setEnabled(bool enabled) { _enabled.store(enabled && _buf, std::memory_order_relaxed); }
+  bool isEnabled() { return _enabled.load(std::memory_order_relaxed); }
+
+  // formatTraceRecord()와 같다.
+  static int format(const TraceRecord& r, char* buf, size_t size) { return formatTraceRecord(r, buf, size); }
+
+private:
+  TraceRecord* _buf;
+  uint32_t _mask;
+  std::atomic<uint32_t> _head; // 쓰는 쪽이 다음에 쓸 위치. 계속 늘어나기만 한다.
+  std::atomic<uint32_t> _tail; // 읽는 쪽이 다음에 읽을 위치.
+  std::atomic<uint32_t> _dropped;
+  std::atomic<bool> _enabled;
+};
+
+template <size_t Capacity>
+class StaticButtonTrace : public ButtonTrace {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "StaticButtonTrace capacity must be a power of two.");
+
+public:
+  StaticButtonTrace() : ButtonTrace(_storage, Capacity) {}
+
+private:
+  TraceRecord _storage[Capacity];
+};
+
+#endif //BUTTONTRACE_H
@@ -0,0 +1,176 @@
+#ifndef FIXEDRATESAMPLER_H
+#define FIXEDRATESAMPLER_H
+
+// FixedRateSampler<Keys, Depth>
+// - 입력을 읽는 시점을 loop()에서 떼어낸다. 하드웨어 타이머 콜백이 일정한 주기로 sample()을 부르고,
+//   읽은 비트가 바뀌었을 때만 (시각, 비트) 레코드를 링에 넣는다. 버튼 FSM은 나중에 다른 태스크/코어/loop()에서 꺼내 돌린다.
+//   loop()가 바빠서 100ms 늦게 돌아도 각 변화는 타이머가 본 시각으로 판정되므로 짧은 클릭이 합쳐지거나 사라지지 않는다.
+//   DISCARD_SHORT_PRESS_DURATION 같은 창도 loop() 부하와 상관없이 샘플 시각으로 잰다.
+// - 읽을 것: addPin()으로 준 핀들(키 번호 = 추가한 순서), 또는 setSource()로 준 입력 소스.
+//   ShiftRegisterInput, KeyMatrix, MCP23017Input처럼 scan()과 bitmap()이 있는 소스는 setSource(src)로 바로.
+//   sample()이 ISR에서 돌 수 있는 소스여야 한다. I2C(MCP23017Input)는 ISR 대신 높은 우선순위 태스크에서 sample()을 부른다.
+// - 꺼내는 쪽: next(at)가 참인 동안 attach()한 버튼들을 event(at)로 돌린다. 한 레코드마다
+//   1) 바뀌기 직전 샘플 시각에 이전 비트로 한 번(그 사이 롱프레스, 더블클릭 대기 같은 시간 판정을 놓치지 않게),
+//   2) 바뀐 샘플 시각에 새 비트로 한 번. 레코드가 다 떨어지면 마지막 샘플 시각으로 한 번 더 돌리고 false.
+//   누름/뗌은 샘플 시각 그대로 판정된다. 시간만 흘러서 나오는 판정(연속 클릭 대기가 끝난 CLICK, 롱프레스)은
+//   그 시간이 지난 뒤 처음 돌리는 시각에 나오고, 밀린 MANYPRESS는 getRepeatCount()에 합쳐진다.
+// - 링이 꽉 차면 새 변화를 넣지 않고 getOverruns()를 늘린다. 그 변화는 다음 샘플에서 다시 넣어본다.
+// - 링은 쓰는 쪽 하나, 읽는 쪽 하나. 원자 연산은 load/store만 쓴다.
+//
+// FixedRateSampler<16> sampler;
+// Button keys[16];
+// setup: for (int i = 0; i < 16; i++) sampler.addPin(pins[i]);
+//        sampler.attach(keys, 16); sampler.begin();
+//        // RP2040: add_repeating_timer_us(-1000, [](repeating_timer*) { sampler.sample(); return true; }, nullptr, &timer);
+//        // ESP32:  hw_timer_t* t = timerBegin(1000000); timerAttachInterrupt(t, onTimer); timerAlarm(t, 1000, true, 0);
+// loop: unsigned long at;
+//       while (sampler.next(at)) for (int i = 0; i < 16; i++) { int8_t a = keys[i].event(at); if (a) keys[i].doIt(a); }
+
+#include <Arduino.h>
+#include <atomic>
+#include "RamjiButton.h"
+
+// bits에 (Keys + 7) / 8바이트를 채운다. 비트 k = 키 k, 1 = 눌림.
+typedef void (*SampleSource)(uint8_t* bits, void* ctx);
+
+template <size_t Keys, size_t Depth = 32>
+class FixedRateSampler : public KeyBitmap<Keys> {
+  static_assert(Depth > 0 && (Depth & (Depth - 1)) == 0, "FixedRateSampler depth must be a power of two.");
+  static const size_t Bytes = (Keys + 7) / 8;
+
+public:
+  FixedRateSampler() : _head(0), _tail(0), _latest(0), _samples(0), _overruns(0) {
+    memset(_last, 0, sizeof(_last));
+  }
+
+  // 핀 하나를 다음 키로. pressedLevel은 눌렸을 때의 레벨. LOW면 begin()이 INPUT_PULLUP으로 잡는다. 꽉 찼으면 false.
+  bool addPin(uint8_t pin, uint8_t pressedLevel = LOW) {
+    if (_pinCount >= Keys) return false;
+    _pins[_pinCount] = pin;
+    _levels[_pinCount] = pressedLevel;
+    ++_pinCount;
+    return true;
+  }
+
+  void setSource(SampleSource source, void* ctx = nullptr) {
+    _source = source;
+    _sourceCtx = ctx;
+  }
+  // scan()과 bitmap(), keys()가 있는 입력 소스. sample()마다 scan()하고 비트맵을 복사한다.
+  template <class Source>
+  void setSource(Source& src) {
+    setSource([](uint8_t* bits, void* ctx) {
+      Source* s = static_cast<Source*>(ctx);
+      s->scan();
+      size_t n = (s->keys() + 7) / 8;
+      memcpy(bits, s->bitmap(), n < Bytes ? n : Bytes);
+    }, &src);
+  }
+
+  // 핀 모드를 잡고 지금 상태를 첫 상태로. 타이머를 켜기 전에.
+  void begin() {
+    for (size_t i = 0; i < _pinCount; ++i) pinMode(_pins[i], _levels[i] == LOW ? INPUT_PULLUP : INPUT);
+    read(_last);
+    memcpy(this->_bits, _last, Bytes);
+    unsigned long now = millis();
+    _latest.store(now, std::memory_order_relaxed);
+    _lastAt = now;
+    _lastSample = now;
+  }
+
+  // 타이머 콜백에서. 읽고, 바뀌었으면 링에 넣는다.
+  void sample() {
+    uint8_t bits[Bytes];
+    read(bits);
+    unsigned long now = millis();
+    _samples.store(_samples.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (memcmp(bits, _last, Bytes) != 0) {
+      uint32_t head = _head.load(std::memory_order_relaxed);
+      if (head - _tail.load(std::memory_order_acquire) >= Depth) {
+        _overruns.store(_overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      } else {
+        Record& r = _ring[head & (Depth - 1)];
+        r.at = now;
+        r.before = _lastSample;
+        memcpy(r.bits, bits, Bytes);
+        memcpy(_last, bits, Bytes);
+        _head.store(head + 1, std::memory_order_release);
+      }
+    }
+    _lastSample = now;
+    _latest.store(now, std::memory_order_release);
+  }
+
+  // 다음 판정 시각을 at에 주고 비트맵을 그 시각의 상태로 맞춘다. 더 돌릴 게 없으면 false.
+  bool next(unsigned long& at) {
+    uint32_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail != _head.load(std::memory_order_acquire)) {
+      Record& r = _ring[tail & (Depth - 1)];
+      if (!_edgePending) {
+        _edgePending = true;
+        if (after(r.before, _lastAt)) {
+          at = _lastAt = r.before;
+          return true;
+        }
+      }
+      _edgePending = false;
+      memcpy(this->_bits, r.bits, Bytes);
+      if (after(r.at, _lastAt)) _lastAt = r.at;
+      at = _lastAt;
+      _tail.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+    unsigned long latest = _latest.load(std::memory_order_acquire);
+    if (!after(latest, _lastAt)) return false;
+    at = _lastAt = latest;
+    return true;
+  }
+
+  // 링에 남은 변화 레코드 수.
+  size_t pending() { return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_relaxed); }
+  uint32_t getSamples() { return _samples.load(std::memory_order_relaxed); }
+  uint32_t getOverruns() { return _overruns.load(std::memory_order_relaxed); }
+  void resetStats() {
+    _samples.store(0, std::memory_order_relaxed);
+    _overruns.store(0, std::memory_order_relaxed);
+  }
+
+private:
+  struct Record {
+    unsigned long at;     // 바뀐 샘플의 시각.
+    unsigned long before; // 그 직전 샘플의 시각. 이때까지는 이전 비트였다.
+    uint8_t bits[Bytes];
+  };
+
+  Record _ring[Depth];
+  std::atomic<uint32_t> _head;
+  std::atomic<uint32_t> _tail;
+  std::atomic<unsigned long> _latest;
+  std::atomic<uint32_t> _samples;
+  std::atomic<uint32_t> _overruns;
+  uint8_t _last[Bytes];         // 쓰는 쪽. 마지막으로 링에 넣은 비트.
+  unsigned long _lastSample = 0; // 쓰는 쪽.
+  unsigned long _lastAt = 0;     // 읽는 쪽. 마지막으로 준 판정 시각.
+  bool _edgePending = false;     // 읽는 쪽. 직전 시각 판정을 주고 변화 적용을 기다리는 중.
+
+  uint8_t _pins[Keys];
+  uint8_t _levels[Keys];
+  size_t _pinCount = 0;
+  SampleSource _source = nullptr;
+  void* _sourceCtx = nullptr;
+
+  static bool after(unsigned long a, unsigned long b) { return static_cast<long>(a - b) > 0; }
+
+  void read(uint8_t* bits) {
+    if (_source) {
+      _source(bits, _sourceCtx);
+      return;
+    }
+    memset(bits, 0, Bytes);
+    for (size_t i = 0; i < _pinCount; ++i) {
+      if (digitalRead(_pins[i]) == _levels[i]) bits[i >> 3] |= static_cast<uint8_t>(1u << (i & 7));
+    }
+  }
+};
+
+#endif //FIXEDRATESAMPLER_H
@@ -0,0 +1,284 @@
+#ifndef GESTUREMATCHER_H
+#define GESTUREMATCHER_H
+
+// GestureMatcher<Buttons, MaxPatterns, MaxSteps>
+// - event()가 준 액션들을 이어서 보는 제스처 판정. "A 클릭 뒤 1초 안에 B 롱프레스", "A-B-A" 같은 순서를
+//   (버튼 번호, ACTION, 앞 단계와의 시간 제한) 단계들의 배열로 선언해 두면 feed()가 맞춰 본다.
+// - add()로 넣은 패턴들은 compile()에서 오토마톤 하나로 합쳐진다. 같은 앞부분을 가진 패턴들은 상태를 공유하고,
+//   (상태, 입력) 전이표가 미리 채워져 있어서 feed() 한 번에 표 한 칸만 본다. 패턴 수와 상관없이 같은 일만 하고,
+//   패턴마다 따로 돌거나 주기적으로 부를 것이 없다. 시간 제한도 액션이 들어올 때 직전 액션과의 간격으로만 본다.
+// - 시간 제한은 단계마다 앞 단계 액션과의 간격(ms). 0은 제한 없음. 첫 단계의 제한은 쓰지 않는다.
+//   간격은 feed()에 준 시각끼리 잰다. 롱프레스는 누른 시각이 아니라 event()가 LONGPRESS를 준 시각이다.
+//   더 긴 패턴의 뒷부분이 다른 패턴과 겹치는데 그쪽 제한이 더 빡빡할 때만 최근 액션 시각을 거슬러 확인한다(패턴 길이만큼).
+// - 맞으면 그 패턴 번호(add() 순서, 0부터)를 돌려주고 핸들러가 있으면 부른다. 없으면 -1.
+//   여러 패턴이 한꺼번에 끝나면 가장 긴 것 하나를 돌려주고, 전부는 getMatches() 비트마스크로.
+//   맞은 뒤 더 이어질 패턴이 없으면 처음부터 다시 본다. "A-B-A"는 A B A B A에서 한 번만 맞는다.
+//   "A"와 "A-B"가 같이 있으면 A에서 "A", 이어서 B가 오면 "A-B".
+// - 어느 패턴에도 없는 (버튼, 액션)이 오면 처음으로. NO_ACTION은 무시하므로 event() 결과를 그대로 넣어도 된다.
+// - 두 버튼 조합은 안 쓰는 버튼 번호 하나를 조합 몫으로 정해서 event()[2]를 그 번호로 넣는다.
+//
+// GestureMatcher<2> gestures;
+// const GestureStep unlock[] = { { 0, CLICK, 0 }, { 1, LONGPRESS, 1000 } }; // A 클릭, 1초 안에 B 롱프레스
+// const GestureStep aba[] = { { 0, CLICK, 0 }, { 1, CLICK, 500 }, { 0, CLICK, 500 } };
+// setup: gestures.add(unlock, 2, onUnlock); gestures.add(aba, 3, onAba); gestures.compile();
+// loop: int8_t a = btnA.event(); gestures.feed(0, a);
+//       int8_t b = btnB.event(); gestures.feed(1, b);
+
+#include <Arduino.h>
+#include "RamjiButton.h"
+
+struct GestureStep {
+  uint8_t button;  // feed()에 줄 버튼 번호. 0 ~ Buttons-1.
+  int8_t action;   // enum ACTION. NO_ACTION은 안 된다.
+  uint16_t within; // 앞 단계 액션과의 최대 간격(ms). 0은 제한 없음.
+};
+
+template <size_t Buttons = 8, size_t MaxPatterns = 8, size_t MaxSteps = 16>
+class GestureMatcher {
+  static_assert(Buttons > 0 && Buttons <= 255, "GestureMatcher supports 1 to 255 buttons.");
+  static_assert(MaxPatterns > 0 && MaxPatterns <= 32, "GestureMatcher supports 1 to 32 patterns.");
+  static_assert(MaxSteps > 0 && MaxSteps < 127, "GestureMatcher supports 1 to 126 steps in total.");
+  static const size_t States = MaxSteps + 1; // 루트 + 단계마다 많아야 하나.
+  static const uint8_t NO_SYMBOL = 0xFF;
+  static const uint8_t STATE_MASK = 0x7F;
+  static const uint8_t CHECK = 0x80; // 전이표 칸의 이 비트: 건너뛴 앞부분의 시간 제한을 다시 확인해야 한다.
+
+public:
+  GestureMatcher() { clear(); }
+
+  // 패턴 하나를 추가한다. steps는 복사해 둔다. 패턴 번호를 돌려준다. 자리가 없거나 단계가 잘못됐으면 -1.
+  int8_t add(const GestureStep* steps, uint8_t count, void (*handler)() = nullptr) {
+    if (!steps || count == 0 || _patterns >= MaxPatterns || _stepCount + count > MaxSteps) return -1;
+    for (uint8_t i = 0; i < count; ++i) {
+      if (steps[i].button >= Buttons || steps[i].action <= NO_ACTION || steps[i].action >= NUMBER_OF_ACTIONS) return -1;
+    }
+    uint8_t p = _patterns++;
+    _start[p] = _stepCount;
+    _length[p] = count;
+    _handlers[p] = handler;
+    for (uint8_t i = 0; i < count; ++i) _steps[_stepCount++] = steps[i];
+    _dirty = true;
+    return static_cast<int8_t>(p);
+  }
+  void setHandler(uint8_t pattern, void (*handler)()) {
+    if (pattern < _patterns) _handlers[pattern] = handler;
+  }
+  // 패턴을 전부 지운다.
+  void clear() {
+    _patterns = 0;
+    _stepCount = 0;
+    _dirty = true;
+    _stateCount = 1;
+    _symbols = 0;
+    _depth[0] = 0;
+    _state = 0;
+    _matches = 0;
+  }
+
+  // 패턴들을 오토마톤으로 만든다. setup()에서 add()를 다 한 뒤에. 안 하면 첫 feed()가 한다.
+  void compile() {
+    memset(_symbol, NO_SYMBOL, sizeof(_symbol));
+    memset(_next, 0, sizeof(_next));
+    _symbols = 0;
+    _stateCount = 1;
+    _depth[0] = 0;
+    _parent[0] = 0;
+    _within[0] = 0;
+    _end[0] = -1;
+
+    // 1) 앞부분이 같은 패턴끼리 상태를 나누는 트리. 공유하는 단계의 제한은 그중 가장 느슨한 것.
+    for (uint8_t p = 0; p < _patterns; ++p) {
+      uint8_t v = 0;
+      for (uint8_t i = 0; i < _length[p]; ++i) {
+        const GestureStep& s = _steps[_start[p] + i];
+        uint8_t& c = _symbol[s.button][s.action];
+        if (c == NO_SYMBOL) c = _symbols++;
+        uint8_t w = _next[v][c];
+        if (w == 0) {
+          w = _stateCount++;
+          _next[v][c] = w;
+          _depth[w] = static_cast<uint8_t>(_depth[v] + 1);
+          _parent[w] = v;
+          _within[w] = (i == 0) ? 0 : s.within;
+          _end[w] = -1;
+        } else if (_within[w] != 0 && (s.within == 0 || s.within > _within[w])) {
+          _within[w] = (i == 0) ? 0 : s.within;
+        }
+        v = w;
+      }
+      if (_end[v] < 0) _end[v] = static_cast<int8_t>(p);
+    }
+
+    // 2) 너비 우선으로 실패 링크를 달고, 트리에 없는 전이는 실패 링크 쪽 전이로 채운다.
+    uint8_t queue[States];
+    uint8_t head = 0, tail = 0;
+    _fail[0] = 0;
+    _outLink[0] = 0;
+    queue[tail++] = 0;
+    while (head < tail) {
+      uint8_t v = queue[head++];
+      _leaf[v] = true;
+      for (uint8_t c = 0; c < _symbols; ++c) {
+        uint8_t w = _next[v][c];
+        if (w != 0 && _parent[w] == v && _depth[w] == _depth[v] + 1) {
+          _leaf[v] = false;
+          _fail[w] = (v == 0) ? 0 : (_next[_fail[v]][c] & STATE_MASK);
+          _outLink[w] = (_end[_fail[w]] >= 0) ? _fail[w] : _outLink[_fail[w]];
+          queue[tail++] = w;
+        } else {
+          _next[v][c] = (v == 0) ? 0 : (_next[_fail[v]][c] & STATE_MASK);
+        }
+      }
+    }
+
+    // 3) 더 짧은 앞부분으로 건너뛰는 전이 중, 그 앞부분의 제한이 지금 상태보다 빡빡한 칸에 표시.
+    for (uint8_t s = 0; s < _stateCount; ++s) {
+      for (uint8_t c = 0; c < _symbols; ++c) {
+        uint8_t t = _next[s][c];
+        if (t != 0 && _parent[t] != s && !implied(_parent[t], s)) _next[s][c] = static_cast<uint8_t>(t | CHECK);
+      }
+    }
+
+    // 4) 트리 상태의 제한보다 자기 제한이 빡빡한 패턴은 끝날 때 자기 제한으로 다시 확인.
+    for (uint8_t p = 0; p < _patterns; ++p) {
+      uint8_t v = 0;
+      _exact[p] = true;
+      for (uint8_t i = 0; i < _length[p]; ++i) {
+        const GestureStep& s = _steps[_start[p] + i];
+        v = _next[v][_symbol[s.button][s.action]] & STATE_MASK;
+        if (i > 0 && _within[v] != s.within) _exact[p] = false;
+      }
+    }
+
+    _state = 0;
+    _dirty = false;
+  }
+
+  // 액션 하나를 넣는다. 맞은 패턴 번호, 없으면 -1. at은 그 액션의 시각(ms).
+  int8_t feed(uint8_t button, int8_t action, unsigned long at) {
+    _matches = 0;
+    if (action <= NO_ACTION || action >= NUMBER_OF_ACTIONS) return -1;
+    if (_dirty) compile();
+    ++_feeds;
+    _head = static_cast<uint8_t>((_head + 1) % MaxSteps);
+    _times[_head] = at;
+
+    uint8_t c = (button < Buttons) ? _symbol[button][action] : NO_SYMBOL;
+    uint8_t t = (c == NO_SYMBOL) ? 0 : step(c);
+    _state = t;
+    if (t == 0) return -1;
+
+    // t와 t의 뒷부분에서 끝나는 패턴들. 긴 것부터.
+    int8_t found = -1;
+    for (uint8_t o = t; o != 0; o = _outLink[o]) {
+      int8_t p = _end[o];
+      if (p < 0) continue;
+      if (o != t && !fits(o, 0)) continue;
+      if (!_exact[p] && !fitsPattern(static_cast<uint8_t>(p))) continue;
+      _matches |= 1UL << p;
+      if (found < 0) found = p;
+    }
+    if (found >= 0) {
+      ++_hits;
+      if (_leaf[t]) _state = 0;
+      if (_handlers[found]) _handlers[found]();
+    }
+    return found;
+  }
+  int8_t feed(uint8_t button, int8_t action) { return feed(button, action, millis()); }
+
+  // 처음부터 다시 본다. 패턴은 그대로.
+  void reset() { _state = 0; }
+
+  // 마지막 feed()에서 맞은 패턴들. 비트 p = 패턴 p.
+  uint32_t getMatches() { return _matches; }
+  // 지금 맞춰 가는 중인 가장 긴 앞부분의 단계 수. 0이면 아무것도 진행 중이 아님.
+  uint8_t getProgress() { return _depth[_state]; }
+  uint8_t getPatternCount() { return _patterns; }
+  uint8_t getStateCount() { return _stateCount; }
+  uint32_t getFeeds() { return _feeds; }
+  uint32_t getHits() { return _hits; }
+  void resetStats() {
+    _feeds = 0;
+    _hits = 0;
+  }
+
+private:
+  GestureStep _steps[MaxSteps];
+  uint8_t _start[MaxPatterns];
+  uint8_t _length[MaxPatterns];
+  bool _exact[MaxPatterns];
+  void (*_handlers[MaxPatterns])();
+  uint8_t _patterns = 0;
+  uint8_t _stepCount = 0;
+  bool _dirty = true;
+
+  // 오토마톤.
+  uint8_t _symbol[Buttons][NUMBER_OF_ACTIONS]; // (버튼, 액션) -> 입력 번호.
+  uint8_t _next[States][MaxSteps];             // (상태, 입력) -> 다음 상태 | CHECK.
+  uint8_t _depth[States];
+  uint8_t _parent[States];
+  uint8_t _fail[States];
+  uint8_t _outLink[States]; // 뒷부분 중 패턴이 끝나는 가장 긴 상태. 없으면 0.
+  int8_t _end[States];      // 여기서 끝나는 패턴. 없으면 -1.
+  uint16_t _within[States]; // 이 상태로 들어오는 단계의 제한.
+  bool _leaf[States];
+  uint8_t _symbols = 0;
+  uint8_t _stateCount = 1;
+
+  uint8_t _state = 0;
+  unsigned long _times[MaxSteps] = {0}; // 최근 액션 시각. _head가 가장 최근.
+  uint8_t _head = 0;
+  uint32_t _matches = 0;
+  uint32_t _feeds = 0;
+  uint32_t _hits = 0;
+
+  // k번째로 최근 액션과 그 앞 액션의 간격이 w 이하인가.
+  bool gapOk(uint16_t w, uint8_t k) {
+    if (w == 0) return true;
+    uint8_t i = static_cast<uint8_t>((_head + MaxSteps - k) % MaxSteps);
+    uint8_t j = static_cast<uint8_t>((i + MaxSteps - 1) % MaxSteps);
+    return _times[i] - _times[j] <= w;
+  }
+
+  // 상태 v의 단계들이 k번째로 최근 액션에서 끝났다고 보고 제한을 다 지켰는지.
+  bool fits(uint8_t v, uint8_t k) {
+    for (; _depth[v] > 1; v = _parent[v], ++k) {
+      if (!gapOk(_within[v], k)) return false;
+    }
+    return true;
+  }
+
+  bool fitsPattern(uint8_t p) {
+    uint8_t n = _length[p];
+    for (uint8_t i = 1; i < n; ++i) {
+      if (!gapOk(_steps[_start[p] + i].within, static_cast<uint8_t>(n - 1 - i))) return false;
+    }
+    return true;
+  }
+
+  // 뒷부분 u의 제한이 s의 같은 자리 제한보다 다 느슨하면, s를 지켰을 때 u도 지킨 것.
+  bool implied(uint8_t u, uint8_t s) {
+    for (; _depth[u] > 1; u = _parent[u], s = _parent[s]) {
+      if (_within[u] == 0) continue;
+      if (_within[s] == 0 || _within[s] > _within[u]) return false;
+    }
+    return true;
+  }
+
+  // 입력 c로 다음 상태. 보통은 표 한 칸. 건너뛴 앞부분이나 이번 간격이 제한을 넘었으면 더 짧은 앞부분으로 내려간다.
+  uint8_t step(uint8_t c) {
+    uint8_t e = _next[_state][c];
+    uint8_t t = e & STATE_MASK;
+    bool check = (e & CHECK) != 0;
+    while (t != 0) {
+      uint8_t u = _parent[t];
+      if (gapOk(_within[t], 0) && (!check || fits(u, 1))) return t;
+      t = _next[_fail[u]][c] & STATE_MASK; // 첫 단계는 늘 통과하므로 여기서 u는 루트가 아니다.
+      check = true;
+    }
+    return 0;
+  }
+};
+
+#endif //GESTUREMATCHER_H
@@ -0,0 +1,180 @@
+#ifndef KEYMATRIX_H
+#define KEYMATRIX_H
+
+// KeyMatrix<Rows, Cols>
+// - 행/열 키 매트릭스 스캐너. 행을 하나씩 LOW로 내리고 열들을 한 번에 읽는다. 8x8이면 핀 16개로 키 64개.
+//   키 번호는 row * Cols + col. 결과는 KeyBitmap에 들어가서 attach()한 Button들이 그대로 판정한다.
+// - 열은 INPUT_PULLUP. 눌린 키가 있는 열이 LOW로 읽힌다. 쉬는 행은 INPUT(하이 임피던스)로 둬서
+//   다이오드 없는 매트릭스에서 여러 키를 눌러도 행끼리 부딪히지 않게 한다.
+// - 열 읽기는 기본이 열마다 digitalRead(). setColumnReader()로 포트 레지스터를 한 번에 읽는 함수를 주면 행마다 읽기 한 번이 된다.
+//   그 함수는 열 0 ~ Cols-1의 레벨을 비트 0 ~ Cols-1에 담아서(1 = HIGH) 돌려준다.
+//   ESP32: return (REG_READ(GPIO_IN_REG) >> 12) & 0xFF; RP2040: return (sio_hw->gpio_in >> 8) & 0xFF; 처럼 보드에 맞게.
+// - 다이오드 없는 매트릭스(setDiodes(false))에서는 직사각형의 세 모서리가 눌리면 네 번째가 눌린 것처럼 읽힌다(고스팅).
+//   반대로 네 모서리가 다 눌린 채 하나를 떼면 뗀 게 안 보인다(마스킹).
+//   두 행이 눌린 열을 둘 이상 같이 갖고 있으면 그 직사각형의 모서리들은 모호하다고 보고, 거기서 새로 눌린 키는 받아들이지 않는다.
+//   이미 눌려 있던 키와 떼는 건 그대로 받아들인다. 세 모서리를 한 스캔 안에 동시에 누르면 셋 다 막힌다. 어느 게 진짜인지 알 수 없어서.
+//   - 고스팅: 막힌 키는 getBlockedRow(r). 키가 막히기 시작할 때마다 getGhostEvents()가 하나 오른다(막혀 있는 동안 계속 세지 않는다).
+//   - 마스킹: 모호한 모서리에 이미 눌려 있던 키는 떼어도 안 보이므로 눌림으로 둔다. 그런 키는 getMaskedRow(r),
+//     그렇게 되기 시작할 때마다 getMaskEvents()가 하나 오른다. 직사각형이 풀리면(다른 모서리를 떼면) 그때 뗀 게 보인다.
+//   지금 모호한 행들은 getAmbiguousRows().
+//   다이오드가 있는 매트릭스(기본)는 고스팅/마스킹이 없으므로 이 검사를 안 한다.
+//
+// const uint8_t rows[8] = { 2, 3, 4, 5, 6, 7, 8, 9 };
+// const uint8_t cols[8] = { 10, 11, 12, 13, 14, 15, 16, 17 };
+// KeyMatrix<8, 8> matrix(rows, cols);
+// Button keys[64];
+// setup: matrix.begin(); matrix.attach(keys, 64);
+// loop: matrix.scan(); for (int i = 0; i < 64; i++) { int8_t a = keys[i].event(); if (a) keys[i].doIt(a); }
+
+#include <Arduino.h>
+#include "RamjiButton.h"
+
+template <size_t Rows, size_t Cols>
+class KeyMatrix : public KeyBitmap<Rows * Cols> {
+  static_assert(Rows > 0 && Rows <= 32, "KeyMatrix supports 1 to 32 rows.");
+  static_assert(Cols > 0 && Cols <= 32, "KeyMatrix supports 1 to 32 columns.");
+
+public:
+  typedef uint32_t (*ColumnReader)(void* ctx);
+
+  KeyMatrix(const uint8_t* rowPins, const uint8_t* colPins, bool diodes = true) : _diodes(diodes) {
+    for (size_t r = 0; r < Rows; ++r) _rowPins[r] = rowPins[r];
+    for (size_t c = 0; c < Cols; ++c) _colPins[c] = colPins[c];
+    for (size_t r = 0; r < Rows; ++r) {
+      _rows[r] = 0;
+      _blocked[r] = 0;
+      _masked[r] = 0;
+    }
+  }
+
+  // 핀 모드 설정. setup()에서. 생성자에서 안 하는 건 전역 객체가 보드 초기화보다 먼저 만들어질 수 있어서.
+  void begin() {
+    for (size_t c = 0; c < Cols; ++c) pinMode(_colPins[c], INPUT_PULLUP);
+    for (size_t r = 0; r < Rows; ++r) pinMode(_rowPins[r], INPUT);
+  }
+
+  void setDiodes(bool diodes) {
+    _diodes = diodes;
+    if (diodes) clearAmbiguity();
+  }
+  bool hasDiodes() { return _diodes; }
+  // 행을 내린 뒤 열을 읽기 전에 기다리는 시간(us). 배선 정전용량에 따라. 기본 5us.
+  void setSettle(uint32_t us) { _settleUs = us; }
+  void setColumnReader(ColumnReader reader, void* ctx = nullptr) {
+    _reader = reader;
+    _readerCtx = ctx;
+  }
+
+  // 전체를 한 번 훑어서 비트맵을 갱신한다. 바뀐 키가 있으면 true.
+  bool scan() {
+    uint32_t raw[Rows];
+    for (size_t r = 0; r < Rows; ++r) {
+      pinMode(_rowPins[r], OUTPUT);
+      digitalWrite(_rowPins[r], LOW);
+      if (_settleUs) delayMicroseconds(_settleUs);
+      raw[r] = ~readColumns() & colMask();
+      pinMode(_rowPins[r], INPUT);
+    }
+    if (!_diodes) resolveGhosts(raw);
+
+    bool changed = false;
+    for (size_t r = 0; r < Rows; ++r) {
+      uint32_t diff = raw[r] ^ _rows[r];
+      if (!diff) continue;
+      _rows[r] = raw[r];
+      for (size_t c = 0; c < Cols; ++c) {
+        if ((diff >> c) & 1u) this->setKey(static_cast<uint16_t>(r * Cols + c), (raw[r] >> c) & 1u);
+      }
+      changed = true;
+    }
+    ++_scans;
+    return changed;
+  }
+
+  // 행 r에서 눌린 열들의 비트마스크. 고스트 처리가 끝난 값.
+  uint32_t getRow(uint8_t r) { return (r < Rows) ? _rows[r] : 0; }
+  uint32_t getAmbiguousRows() { return _ambiguous; }
+  // 행 r에서 고스트일 수 있어서 막고 있는 열들, 떼어도 안 보일 수 있는(마스킹) 눌린 열들.
+  uint32_t getBlockedRow(uint8_t r) { return (r < Rows) ? _blocked[r] : 0; }
+  uint32_t getMaskedRow(uint8_t r) { return (r < Rows) ? _masked[r] : 0; }
+  uint32_t getGhostEvents() { return _ghostEvents; }
+  uint32_t getMaskEvents() { return _maskEvents; }
+  uint32_t getScans() { return _scans; }
+  void resetStats() {
+    _ghostEvents = 0;
+    _maskEvents = 0;
+    _scans = 0;
+  }
+
+private:
+  uint8_t _rowPins[Rows];
+  uint8_t _colPins[Cols];
+  uint32_t _rows[Rows]; // 받아들인 상태. 비트 c = 열 c 눌림.
+  bool _diodes;
+  uint32_t _settleUs = 5;
+  ColumnReader _reader = nullptr;
+  void* _readerCtx = nullptr;
+  uint32_t _blocked[Rows]; // 고스트로 막고 있는 자리.
+  uint32_t _masked[Rows];  // 떼어도 안 보일 수 있는 눌린 자리.
+  uint32_t _ambiguous = 0;
+  uint32_t _ghostEvents = 0;
+  uint32_t _maskEvents = 0;
+  uint32_t _scans = 0;
+
+  static uint32_t colMask() { return (Cols >= 32) ? 0xFFFFFFFFUL : ((1UL << Cols) - 1); }
+
+  uint32_t readColumns() {
+    if (_reader) return _reader(_readerCtx);
+    uint32_t levels = 0;
+    for (size_t c = 0; c < Cols; ++c) {
+      if (digitalRead(_colPins[c])) levels |= (1UL << c);
+    }
+    return levels;
+  }
+
+  static bool twoOrMore(uint32_t v) { return (v & (v - 1)) != 0; }
+
+  static uint8_t countBits(uint32_t v) {
+    uint8_t n = 0;
+    for (; v; v &= v - 1) ++n;
+    return n;
+  }
+
+  void clearAmbiguity() {
+    _ambiguous = 0;
+    for (size_t r = 0; r < Rows; ++r) {
+      _blocked[r] = 0;
+      _masked[r] = 0;
+    }
+  }
+
+  // 두 행이 눌린 열을 둘 이상 공유하면 직사각형. 그 모서리 자리들에서는 새로 눌린 키를 막고(고스팅)
+  // 이미 눌려 있던 키는 눌림으로 둔다(마스킹). 둘 다 새로 그렇게 된 키만 센다.
+  void resolveGhosts(uint32_t* raw) {
+    uint32_t corners[Rows];
+    uint32_t ambiguous = 0;
+    for (size_t r = 0; r < Rows; ++r) corners[r] = 0;
+    for (size_t a = 0; a < Rows; ++a) {
+      if (!twoOrMore(raw[a])) continue;
+      for (size_t b = a + 1; b < Rows; ++b) {
+        uint32_t shared = raw[a] & raw[b];
+        if (!twoOrMore(shared)) continue;
+        corners[a] |= shared;
+        corners[b] |= shared;
+        ambiguous |= (1UL << a) | (1UL << b);
+      }
+    }
+    _ambiguous = ambiguous;
+    for (size_t r = 0; r < Rows; ++r) {
+      uint32_t blocked = raw[r] & corners[r] & ~_rows[r];
+      uint32_t masked = raw[r] & corners[r] & _rows[r];
+      _ghostEvents += countBits(blocked & ~_blocked[r]);
+      _maskEvents += countBits(masked & ~_masked[r]);
+      _blocked[r] = blocked;
+      _masked[r] = masked;
+      raw[r] &= ~blocked;
+    }
+  }
+};
+
+#endif //KEYMATRIX_H
@@ -0,0 +1,300 @@
+#ifndef MCP23017INPUT_H
+#define MCP23017INPUT_H
+
+// MCP23017Input<Bus>
+// - MCP23017(I2C 16비트 GPIO 확장 칩)에 달린 버튼 16개를 읽는 입력 소스. 결과는 KeyBitmap<16>에 들어간다.
+//   Button::event()가 버튼마다 I2C를 읽는 대신, scan()이 GPIOA/GPIOB를 한 번의 버스트 읽기(2바이트)로 가져온다.
+// - INT 핀을 주면 INT가 떠 있을 때(LOW)만 읽는다. 안 떠 있으면 버스를 건드리지 않고 캐시된 비트맵 그대로.
+//   버튼 FSM의 시간 판정(롱프레스, 더블클릭 대기)은 event()가 캐시를 보고 계속 진행한다.
+//   그래서 I2C 읽기는 입력이 실제로 바뀔 때만 한 번. INT 핀이 없으면 scan()마다 읽는다.
+// - begin()이 칩을 설정한다: 16핀 모두 입력 + 내부 풀업, 변화 인터럽트 켬, INTA/INTB 미러(INT 선 하나면 됨),
+//   INT는 오픈드레인 LOW 액티브. 그래서 MCU 쪽 INT 핀은 INPUT_PULLUP. 여러 칩의 INT를 한 선에 묶어도 된다.
+// - GPIO를 읽으면 칩이 INT를 내린다. 읽기에 실패하면 INT가 그대로라 다음 scan()이 다시 읽는다.
+// - 핀 번호: GPA0 ~ GPA7 = 키 0 ~ 7, GPB0 ~ GPB7 = 키 8 ~ 15. 버튼이 GND로 눌리면 눌림 = 0. 반대면 setActiveLow(false).
+// - Bus는 Wire 같은 TwoWire 호환 객체(beginTransmission/write/endTransmission/requestFrom/read).
+//   이 헤더는 Wire.h를 include하지 않는다. 스케치가 Wire.h를 include하고 타입을 준다.
+// - 호스트(RAMJI_HOST) 빌드에는 가상 칩 MCP23017Sim이 있다. Bus 자리에 넣고 핀 레벨을 바꿔가며 시험한다.
+//
+// #include <Wire.h>
+// MCP23017Input<TwoWire> expander(Wire, 0x20, 7); // 주소 0x20, INT = 핀 7
+// Button keys[16];
+// setup: Wire.begin(); Wire.setClock(400000); expander.begin(); expander.attach(keys, 16);
+// loop: expander.scan(); for (int i = 0; i < 16; i++) { int8_t a = keys[i].event(); if (a) keys[i].doIt(a); }
+
+#include <Arduino.h>
+#include "RamjiButton.h"
+
+#define MCP23017_IODIRA   0x00
+#define MCP23017_IPOLA    0x02
+#define MCP23017_GPINTENA 0x04
+#define MCP23017_DEFVALA  0x06
+#define MCP23017_INTCONA  0x08
+#define MCP23017_IOCON    0x0A
+#define MCP23017_GPPUA    0x0C
+#define MCP23017_INTFA    0x0E
+#define MCP23017_INTCAPA  0x10
+#define MCP23017_GPIOA    0x12
+#define MCP23017_OLATA    0x14
+
+// IOCON 비트. BANK = 0(A/B 레지스터가 번갈아), SEQOP = 0(주소 자동 증가)은 기본값 그대로 쓴다.
+#define MCP23017_IOCON_MIRROR 0x40
+#define MCP23017_IOCON_ODR    0x04
+
+template <class Bus>
+class MCP23017Input : public KeyBitmap<16> {
+public:
+  // intPin: 칩의 INTA(또는 INTB)를 연결한 핀. 연결 안 했으면 안 준다(매번 읽기).
+  MCP23017Input(Bus& bus, uint8_t address = 0x20, uint8_t intPin = 0xFF)
+    : _bus(bus), _address(address), _intPin(intPin) {}
+
+  // 칩 설정. Wire.begin() 다음에. 성공하면 true. 실패하면 getErrors()가 늘고 scan()이 계속 다시 읽어본다.
+  bool begin() {
+    if (_intPin != 0xFF) pinMode(_intPin, INPUT_PULLUP);
+    bool ok = writeRegister(MCP23017_IOCON, MCP23017_IOCON_MIRROR | MCP23017_IOCON_ODR)
+           && writePair(MCP23017_IODIRA, 0xFFFF)
+           && writePair(MCP23017_IPOLA, 0x0000)
+           && writePair(MCP23017_GPPUA, _pullups)
+           && writePair(MCP23017_INTCONA, 0x0000)  // 이전 값과 비교: 바뀌면 인터럽트.
+           && writePair(MCP23017_GPINTENA, 0xFFFF);
+    // 처음 한 번은 INT와 상관없이 읽는다. 이 읽기가 켜져 있던 INT도 내린다.
+    _pending = true;
+    if (ok) scan();
+    return ok;
+  }
+
+  // 내부 풀업. 비트 i = 핀 i. 기본은 16핀 모두. begin() 전에 부르거나, 바꾼 뒤 begin()을 다시 부른다.
+  void setPullups(uint16_t mask) { _pullups = mask; }
+  void setActiveLow(bool activeLow) { _activeLow = activeLow; }
+
+  // INT가 없거나 놓칠 수 있는 배선에서, INT와 상관없이 이 주기(ms)마다 한 번은 읽는다. 0이면 끔(기본).
+  void setResync(unsigned long ms) { _resyncMs = ms; }
+
+  // INT에 attachInterrupt()를 걸었을 때 ISR에서 부른다. 다음 scan()이 읽는다.
+  void notify() { _pending = true; }
+
+  // INT가 떠 있거나(또는 INT 핀이 없거나) notify()/재동기화 때가 됐으면 읽는다. 바뀐 키가 있으면 true.
+  bool scan() {
+    ++_scans;
+    bool due = _pending || _intPin == 0xFF || digitalRead(_intPin) == LOW;
+    if (!due && _resyncMs && millis() - _lastRead >= _resyncMs) due = true;
+    if (!due) return false;
+
+    uint16_t gpio;
+    if (!readPair(MCP23017_GPIOA, gpio)) {
+      ++_errors;
+      _pending = true;
+      return false;
+    }
+    _pending = false;
+    _lastRead = millis();
+    ++_reads;
+    _gpio = gpio;
+
+    uint16_t pressed = _activeLow ? static_cast<uint16_t>(~gpio) : gpio;
+    uint8_t lo = static_cast<uint8_t>(pressed);
+    uint8_t hi = static_cast<uint8_t>(pressed >> 8);
+    bool changed = (_bits[0] != lo) || (_bits[1] != hi);
+    _bits[0] = lo;
+    _bits[1] = hi;
+    return changed;
+  }
+
+  // 마지막으로 읽은 핀 레벨 그대로. 비트 i = 핀 i, 1 = HIGH.
+  uint16_t getRaw() { return _gpio; }
+  // 실제로 I2C 읽기를 한 횟수 / scan() 호출 수 / 실패한 I2C 전송 수.
+  uint32_t getReads() { return _reads; }
+  uint32_t getScans() { return _scans; }
+  uint32_t getErrors() { return _errors; }
+  void resetStats() {
+    _reads = 0;
+    _scans = 0;
+    _errors = 0;
+  }
+
+private:
+  Bus& _bus;
+  uint8_t _address;
+  uint8_t _intPin;
+  bool _activeLow = true;
+  uint16_t _pullups = 0xFFFF;
+  uint16_t _gpio = 0xFFFF;
+  unsigned long _resyncMs = 0;
+  unsigned long _lastRead = 0;
+  volatile bool _pending = true;
+  uint32_t _reads = 0;
+  uint32_t _scans = 0;
+  uint32_t _errors = 0;
+
+  bool writeRegister(uint8_t reg, uint8_t value) {
+    _bus.beginTransmission(_address);
+    _bus.write(reg);
+    _bus.write(value);
+    if (_bus.endTransmission() == 0) return true;
+    ++_errors;
+    return false;
+  }
+
+  // A, B 레지스터 한 쌍을 한 번에. 주소가 자동으로 A -> B로 넘어간다.
+  bool writePair(uint8_t regA, uint16_t value) {
+    _bus.beginTransmission(_address);
+    _bus.write(regA);
+    _bus.write(static_cast<uint8_t>(value));
+    _bus.write(static_cast<uint8_t>(value >> 8));
+    if (_bus.endTransmission() == 0) return true;
+    ++_errors;
+    return false;
+  }
+
+  // 레지스터 주소를 쓰고 STOP 없이(리피티드 스타트) 2바이트를 읽는다. 트랜잭션 하나.
+  bool readPair(uint8_t regA, uint16_t& value) {
+    _bus.beginTransmission(_address);
+    _bus.write(regA);
+    if (_bus.endTransmission(false) != 0) return false;
+    if (_bus.requestFrom(static_cast<uint8_t>(_address), static_cast<uint8_t>(2)) != 2) return false;
+    uint8_t a = static_cast<uint8_t>(_bus.read());
+    uint8_t b = static_cast<uint8_t>(_bus.read());
+    value = static_cast<uint16_t>(a | (b << 8));
+    return true;
+  }
+};
+
+#if defined(RAMJI_HOST)
+// MCP23017Sim
+// - 호스트 시험용 가상 MCP23017. TwoWire와 같은 함수들을 가지고 있어서 MCP23017Input<MCP23017Sim>로 쓴다.
+// - 레지스터 22개, 주소 자동 증가, 입력 극성(IPOL), 풀업, 변화 인터럽트(INTCON = 0이면 이전 값, 1이면 DEFVAL과 비교)를 흉내낸다.
+// - INT는 가상 핀 intPin에 LOW 액티브로 나온다(host::setPin). GPIO나 INTCAP을 읽으면 풀린다.
+// - setInput()/setInputs()로 외부 핀 레벨을 바꾼다. 버튼 누름 = LOW.
+// - 트랜잭션 수와 읽은 바이트 수를 센다. 폴링과 INT 방식의 버스 사용량을 비교할 때.
+// - setFail(true)면 주소 NACK. 버스 오류 처리를 시험할 때.
+class MCP23017Sim {
+public:
+  MCP23017Sim(uint8_t address = 0x20, uint8_t intPin = 0xFF) : _address(address), _intPin(intPin) {
+    memset(_reg, 0, sizeof(_reg));
+    _reg[MCP23017_IODIRA] = 0xFF;
+    _reg[MCP23017_IODIRA + 1] = 0xFF;
+    if (_intPin != 0xFF) host::setPin(_intPin, HIGH);
+  }
+
+  void setInputs(uint16_t levels) {
+    uint16_t before = gpio();
+    _levels = levels;
+    uint16_t after = gpio();
+    uint16_t enabled = pair(MCP23017_GPINTENA) & pair(MCP23017_IODIRA);
+    uint16_t intcon = pair(MCP23017_INTCONA);
+    uint16_t fired = enabled & ((~intcon & (before ^ after)) | (intcon & (after ^ pair(MCP23017_DEFVALA))));
+    if (!fired) return;
+    // 인터럽트가 이미 떠 있으면 INTCAP은 처음 캡처한 값을 유지한다.
+    if (!interruptActive()) setPair(MCP23017_INTCAPA, after);
+    setPair(MCP23017_INTFA, pair(MCP23017_INTFA) | fired);
+    updateInt();
+  }
+  void setInput(uint8_t pin, int level) {
+    if (pin >= 16) return;
+    uint16_t mask = static_cast<uint16_t>(1u << pin);
+    setInputs(level ? (_levels | mask) : (_levels & ~mask));
+  }
+  uint16_t getInputs() { return _levels; }
+  uint8_t getRegister(uint8_t reg) { return (reg < sizeof(_reg)) ? _reg[reg] : 0; }
+  bool interruptActive() { return pair(MCP23017_INTFA) != 0; }
+
+  void setFail(bool fail) { _fail = fail; }
+  uint32_t getTransactions() { return _transactions; }
+  uint32_t getBytesRead() { return _bytesRead; }
+  void resetCounters() {
+    _transactions = 0;
+    _bytesRead = 0;
+  }
+
+  // TwoWire 호환.
+  void begin() {}
+  void setClock(uint32_t) {}
+  void beginTransmission(uint8_t address) {
+    _txAddress = address;
+    _txCount = 0;
+  }
+  size_t write(uint8_t value) {
+    if (_txCount == 0) _pointer = value;
+    else writeRegister(value);
+    ++_txCount;
+    return 1;
+  }
+  uint8_t endTransmission(bool stop = true) {
+    (void)stop;
+    ++_transactions;
+    return (_fail || _txAddress != _address) ? 2 : 0; // 2 = 주소 NACK
+  }
+  uint8_t requestFrom(uint8_t address, uint8_t quantity) {
+    ++_transactions;
+    _rxCount = 0;
+    _rxIndex = 0;
+    if (_fail || address != _address) return 0;
+    for (uint8_t i = 0; i < quantity && i < sizeof(_rx); ++i) _rx[_rxCount++] = readRegister();
+    _bytesRead += _rxCount;
+    return _rxCount;
+  }
+  int available() { return _rxCount - _rxIndex; }
+  int read() { return (_rxIndex < _rxCount) ? _rx[_rxIndex++] : -1; }
+
+private:
+  uint8_t _address;
+  uint8_t _intPin;
+  uint8_t _reg[0x16];
+  uint16_t _levels = 0xFFFF;
+  uint8_t _pointer = 0;
+  uint8_t _txAddress = 0;
+  uint8_t _txCount = 0;
+  uint8_t _rx[32];
+  uint8_t _rxCount = 0;
+  uint8_t _rxIndex = 0;
+  bool _fail = false;
+  uint32_t _transactions = 0;
+  uint32_t _bytesRead = 0;
+
+  uint16_t pair(uint8_t regA) { return static_cast<uint16_t>(_reg[regA] | (_reg[regA + 1] << 8)); }
+  void setPair(uint8_t regA, uint16_t v) {
+    _reg[regA] = static_cast<uint8_t>(v);
+    _reg[regA + 1] = static_cast<uint8_t>(v >> 8);
+  }
+
+  // 입력 핀은 외부 레벨(IPOL이면 반전), 출력 핀은 OLAT.
+  uint16_t gpio() {
+    uint16_t dir = pair(MCP23017_IODIRA);
+    uint16_t in = _levels ^ pair(MCP23017_IPOLA);
+    return static_cast<uint16_t>((in & dir) | (pair(MCP23017_OLATA) & ~dir));
+  }
+
+  void updateInt() {
+    if (_intPin == 0xFF) return;
+    host::setPin(_intPin, interruptActive() ? LOW : HIGH);
+  }
+
+  void advance() { _pointer = static_cast<uint8_t>((_pointer + 1) % sizeof(_reg)); }
+
+  uint8_t readRegister() {
+    uint8_t reg = _pointer;
+    uint8_t v;
+    if (reg == MCP23017_GPIOA || reg == MCP23017_GPIOA + 1) {
+      v = static_cast<uint8_t>(gpio() >> ((reg & 1) * 8));
+    } else {
+      v = _reg[reg];
+    }
+    // GPIO나 INTCAP을 읽으면 그 포트의 인터럽트가 풀린다. MIRROR면 INT 선은 둘 다 풀려야 올라간다.
+    if (reg == MCP23017_GPIOA || reg == MCP23017_INTCAPA) _reg[MCP23017_INTFA] = 0;
+    if (reg == MCP23017_GPIOA + 1 || reg == MCP23017_INTCAPA + 1) _reg[MCP23017_INTFA + 1] = 0;
+    updateInt();
+    advance();
+    return v;
+  }
+
+  void writeRegister(uint8_t value) {
+    uint8_t reg = _pointer;
+    if (reg == MCP23017_GPIOA || reg == MCP23017_GPIOA + 1) reg = static_cast<uint8_t>(reg + 2); // GPIO 쓰기 = OLAT
+    if (reg != MCP23017_INTFA && reg != MCP23017_INTFA + 1 && reg != MCP23017_INTCAPA && reg != MCP23017_INTCAPA + 1) {
+      _reg[reg] = value;
+    }
+    advance();
+  }
+};
+#endif // RAMJI_HOST
+
+#endif //MCP23017INPUT_H
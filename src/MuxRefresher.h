@@ -0,0 +1,136 @@
+#ifndef MUXREFRESHER_H
+#define MUXREFRESHER_H
+
+// MuxRefresher
+// - CD74HC4067로 LED나 표시등 16개를 시분할로 켜는 출력 리프레셔. dWrite(channel, ...)/aWrite(channel, ...)처럼
+//   채널마다 delay(3)을 하지 않는다. tick() 한 번에 채널 하나씩 넘어가고, 그 채널의 출력을 다음 tick까지 켜 둔다.
+//   4067은 한 번에 한 채널만 연결되므로 어차피 시분할이다. 16채널을 다 쓰면 각 출력은 1/16 시간만 켜진다.
+// - 채널마다 듀티(0 ~ 255). 프레임(한 바퀴)마다 켤지 말지를 정하는 16단계 소프트웨어 PWM. 켜는 프레임을 고르게 흩어서 깜빡임이 적다.
+//   먹스가 ANALOG_OUTPUT이어도 같다. aWrite(duty)를 한 tick(500us)만 걸어두면 보드의 하드웨어 PWM 주기(490Hz ~ 1kHz면 1 ~ 2ms)를
+//   한 번도 못 채우고 끊겨서 듀티가 아니라 주기 중 어디서 끊겼는지에 따라 밝기가 들쭉날쭉해진다.
+//   그래서 ANALOG_OUTPUT에서는 aWrite(255)/aWrite(0)으로 완전히 켜고 끄기만 한다.
+// - 입력 먹스를 같이 주면(setInputMux) 선택선(S0 ~ S3)을 공유하는 두 번째 4067을 같은 tick에 읽는다.
+//   채널을 바꾸기 직전, 즉 한 tick 내내 선택돼 있던 채널을 읽으므로 따로 안정화 대기가 필요 없다.
+//   읽은 결과는 KeyBitmap<16>에 들어간다(키 번호 = 채널). attach()한 Button들이 그대로 판정한다.
+//   그래서 표시등 갱신과 키 스캔을 합쳐서 tick마다 채널 선택 한 번.
+// - tick()은 하드웨어 타이머 ISR에서 불러도 된다(analogWrite를 ISR에서 못 쓰는 코어는 디지털 출력으로).
+//   타이머가 없으면 loop()에서 run()을 자주 부른다. setTickMicros() 주기가 되면 tick()을 한 번 부른다.
+// - 한 프레임 = setChannels()개 tick. 기본 500us x 16채널 = 8ms, 125Hz. 안 쓰는 채널은 setChannels()로 줄이면 밝고 빨라진다.
+//
+// CD74HC4067 leds(3, 4, 5, 6, 7, OUTPUT);         // 출력 먹스
+// CD74HC4067 keysMux(3, 4, 5, 6, 8, INPUT_PULLUP); // 같은 선택선, 시그널만 다른 입력 먹스
+// MuxRefresher refresher(leds);
+// Button keys[16];
+// setup: refresher.setInputMux(keysMux); refresher.attach(keys, 16); refresher.begin();
+// loop: refresher.run(); refresher.setDuty(3, 128); for (...) keys[i].event() ...
+
+#include <Arduino.h>
+#include "RamjiButton.h"
+
+class MuxRefresher : public KeyBitmap<16> {
+public:
+  explicit MuxRefresher(CD74HC4067& output) : _output(&output) {
+    for (uint8_t i = 0; i < 16; ++i) _duty[i] = 0;
+  }
+
+  // 선택선을 공유하는 입력 먹스. inputs는 입력으로 읽을 채널 비트마스크.
+  void setInputMux(CD74HC4067& input, uint16_t inputs = 0xFFFF) {
+    _input = &input;
+    _inputMask = inputs;
+  }
+  // 출력으로 쓸 채널 비트마스크. 빠진 채널은 자기 차례에 꺼 둔다. 기본은 전부.
+  void setOutputChannels(uint16_t outputs) { _outputMask = outputs; }
+  // 채널 0 ~ count-1만 돈다. 기본 16.
+  void setChannels(uint8_t count) { _count = (count == 0) ? 1 : (count > 16 ? 16 : count); }
+  void setTickMicros(uint32_t us) { _tickUs = us; }
+  uint32_t getTickMicros() { return _tickUs; }
+  // 입력이 GND로 눌리면(INPUT_PULLUP) 눌림 = LOW. 반대면 false.
+  void setActiveLow(bool activeLow) { _activeLow = activeLow; }
+
+  void setDuty(uint8_t channel, uint8_t duty) {
+    if (channel < 16) _duty[channel] = duty;
+  }
+  uint8_t getDuty(uint8_t channel) { return (channel < 16) ? _duty[channel] : 0; }
+  void setOutput(uint8_t channel, bool on) { setDuty(channel, on ? 255 : 0); }
+
+  // 채널 0을 고르고 시작한다. setup()에서.
+  void begin() {
+    _channel = 0;
+    _output->selectChannel(0);
+    drive(0);
+    _next = micros() + _tickUs;
+  }
+
+  // 다음 채널로 넘어간다. ISR에서 불러도 된다.
+  void tick() {
+    uint8_t ch = _channel;
+    // 한 tick 동안 선택돼 있던 채널이라 이미 안정됐다.
+    if (_input && ((_inputMask >> ch) & 1u)) {
+      bool level = _input->dRead() != LOW;
+      setKey(ch, level != _activeLow);
+    }
+    // 끄고 바꾸고 켠다. 바꾸는 순간 이전 값이 새 채널에 새어 나가지 않게.
+    if ((_outputMask >> ch) & 1u) off();
+    ch = static_cast<uint8_t>(ch + 1);
+    if (ch >= _count) {
+      ch = 0;
+      ++_frames;
+    }
+    _channel = ch;
+    _output->selectChannel(ch);
+    drive(ch);
+    ++_ticks;
+  }
+
+  // loop()에서. 주기가 됐으면 tick()을 한 번. 했으면 true. 한참 밀렸으면 몰아서 하지 않고 지금부터 다시 센다.
+  bool run() {
+    uint32_t now = micros();
+    if (static_cast<int32_t>(now - _next) < 0) return false;
+    tick();
+    _next += _tickUs;
+    if (static_cast<int32_t>(now - _next) >= 0) _next = now + _tickUs;
+    return true;
+  }
+
+  uint8_t getChannel() { return _channel; }
+  uint32_t getTicks() { return _ticks; }
+  uint32_t getFrames() { return _frames; }
+
+private:
+  CD74HC4067* _output;
+  CD74HC4067* _input = nullptr;
+  uint16_t _inputMask = 0;
+  uint16_t _outputMask = 0xFFFF;
+  uint8_t _duty[16];
+  uint8_t _count = 16;
+  uint8_t _channel = 0;
+  bool _activeLow = true;
+  uint32_t _tickUs = 500;
+  uint32_t _next = 0;
+  volatile uint32_t _ticks = 0;
+  volatile uint32_t _frames = 0;
+
+  bool analog() { return _output->getMode() == ANALOG_OUTPUT; }
+
+  void off() {
+    if (analog()) _output->aWrite(0);
+    else _output->dWrite(LOW);
+  }
+
+  void drive(uint8_t ch) {
+    if (!((_outputMask >> ch) & 1u)) {
+      off();
+      return;
+    }
+    uint8_t duty = _duty[ch];
+    // 16단계. 프레임 번호를 비트 뒤집어서 켜는 프레임을 흩는다. 255는 항상 켜짐, 0은 항상 꺼짐.
+    uint8_t level = static_cast<uint8_t>((static_cast<uint16_t>(duty) * 16 + 128) >> 8);
+    uint8_t f = static_cast<uint8_t>(_frames & 15u);
+    uint8_t phase = static_cast<uint8_t>(((f & 1u) << 3) | ((f & 2u) << 1) | ((f & 4u) >> 1) | ((f & 8u) >> 3));
+    bool on = level > phase;
+    if (analog()) _output->aWrite(on ? 255 : 0);
+    else _output->dWrite(on ? HIGH : LOW);
+  }
+};
+
+#endif //MUXREFRESHER_H
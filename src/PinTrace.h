@@ -0,0 +1,487 @@
+#ifndef PINTRACE_H
+#define PINTRACE_H
+
+// PinTrace
+// - 실제 패널에서 사람이 누른 핀 변화를 그대로 기록해뒀다가, 호스트에서 가상 시계로 FSM에 다시 흘려보내는 도구.
+//   ACTION_SUPPRESS_TIME 같은 타이밍 상수는 사람 손으로 눌러봐야 문제가 드러나는데,
+//   한 번 기록해두면 상수를 고칠 때마다 몇 시간 분량의 실제 입력을 몇 초 만에 다시 돌려볼 수 있다.
+// - PinTraceRecorder: 보드에서 돈다. 핀(또는 CD74HC4067 채널) 레벨이 바뀔 때만 바이너리 레코드를 RAM에 쌓는다.
+// - PinTraceReplay: 호스트(RAMJI_HOST)에서만. 트레이스를 가상 핀에 다시 걸고, 가상 시계를 스캔 주기만큼 밀면서 FSM을 돌린다.
+//   판정된 액션과 지연(마지막 핀 변화 ~ 판정)을 모아서 골든 출력과 비교한다.
+//
+// 트레이스 형식 (리틀 엔디언)
+//   헤더 20바이트: "RPT" + 버전(1), 채널 수, 예약 3바이트, 시작 시간(ms), 처음 레벨 비트마스크, 길이(ms, 마지막 sample 시점)
+//   레코드: (앞 레코드로부터 지난 ms << 6) | (레벨 << 5) | 채널 을 LEB128 가변 길이로. 보통 2바이트.
+//   같은 sample()에서 바뀐 채널이 여럿이면 두 번째부터는 지난 시간이 0이다.
+
+#include <Arduino.h>
+#include "RamjiButton.h"
+
+#if defined(RAMJI_HOST)
+  #include <chrono>
+  #include <cstdio>
+  #include <vector>
+#endif
+
+#define PINTRACE_VERSION 1
+#define PINTRACE_HEADER_SIZE 20
+#define PINTRACE_MAX_RECORD 10 // uint64 LEB128 최대 길이.
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// PinTraceRecorder<Capacity, MaxChannels>
+// - Capacity 바이트짜리 정적 버퍼에 기록한다. 힙을 쓰지 않는다.
+// - 채널은 addPin()/addMuxChannel()로 붙인 순서대로 0번부터. 최대 32개.
+// - 루프나 스캔 태스크에서 sample()을 버튼 스캔과 같은 주기로 불러준다. 바뀐 게 없으면 아무것도 안 쓴다.
+//   직접 읽는 대신 비트마스크를 이미 갖고 있으면 record(levels, t)로 넣어도 된다.
+// - 버퍼가 차면 거기서 멈춘다. 이후 변화는 getDropped()로 개수만 센다. 중간을 건너뛰면 시간이 어긋나므로 덮어쓰지 않는다.
+// - 다 모았으면 data()/size()를 그대로 보내거나, printHex()로 시리얼에 찍어서 PC에서 파일로 저장한다.
+//
+// PinTraceRecorder<4096> rec;
+// rec.addPin(buttonPin01);
+// rec.addPin(buttonPin02);
+// rec.begin();
+// loop: rec.sample();
+template <size_t Capacity = 2048, size_t MaxChannels = 16>
+class PinTraceRecorder {
+  static_assert(MaxChannels > 0 && MaxChannels <= 32, "PinTraceRecorder supports 1 to 32 channels.");
+  static_assert(Capacity >= PINTRACE_HEADER_SIZE + PINTRACE_MAX_RECORD, "PinTraceRecorder capacity is too small.");
+
+public:
+  PinTraceRecorder() {}
+
+  // 직접 읽는 핀. 붙은 채널 번호를 돌려준다. 꽉 찼으면 -1.
+  int8_t addPin(uint8_t pin) {
+    if (_channels >= MaxChannels) return -1;
+    _pin[_channels] = pin;
+    _mux[_channels] = nullptr;
+    return static_cast<int8_t>(_channels++);
+  }
+
+  // CD74HC4067 채널. 읽을 때마다 채널을 바꾸므로 dRead(channel)의 안정화 대기가 채널마다 든다.
+  int8_t addMuxChannel(CD74HC4067* mux, uint8_t channel) {
+    if (_channels >= MaxChannels || mux == nullptr) return -1;
+    _pin[_channels] = channel;
+    _mux[_channels] = mux;
+    return static_cast<int8_t>(_channels++);
+  }
+
+  // 헤더를 쓰고 처음부터 다시 기록한다. 처음 레벨은 지금 읽은 값.
+  void begin(unsigned long t) { begin(readLevels(), t); }
+  void begin() { begin(millis()); }
+
+  void begin(uint32_t levels, unsigned long t) {
+    _size = PINTRACE_HEADER_SIZE;
+    _dropped = 0;
+    _full = false;
+    _start = t;
+    _last = t;
+    _levels = levels;
+    _buf[0] = 'R';
+    _buf[1] = 'P';
+    _buf[2] = 'T';
+    _buf[3] = PINTRACE_VERSION;
+    _buf[4] = static_cast<uint8_t>(_channels);
+    _buf[5] = _buf[6] = _buf[7] = 0;
+    put32(8, static_cast<uint32_t>(t));
+    put32(12, levels);
+    put32(16, 0);
+  }
+
+  // 모든 채널을 읽어서 바뀐 것만 기록한다. 이번에 기록한 변화 수를 돌려준다.
+  uint8_t sample(unsigned long t) { return record(readLevels(), t); }
+  uint8_t sample() { return sample(millis()); }
+
+  // 이미 읽어둔 레벨 비트마스크(비트 i = 채널 i의 digitalRead 값)를 기록한다.
+  uint8_t record(uint32_t levels, unsigned long t) {
+    uint32_t changed = (levels ^ _levels) & channelMask();
+    uint8_t n = 0;
+    while (changed) {
+      uint8_t ch = lowestBit(changed);
+      changed &= changed - 1;
+      uint8_t level = (levels >> ch) & 1u;
+      if (_full || !append(ch, level, t)) {
+        _full = true;
+        ++_dropped;
+        continue;
+      }
+      _levels ^= (1UL << ch);
+      ++n;
+    }
+    if (!_full) put32(16, static_cast<uint32_t>(t - _start));
+    return n;
+  }
+
+  const uint8_t* data() const { return _buf; }
+  size_t size() const { return _size; }
+  size_t capacity() const { return Capacity; }
+  uint8_t channels() const { return static_cast<uint8_t>(_channels); }
+  bool isFull() const { return _full; }
+  uint32_t getDropped() const { return _dropped; }
+  uint32_t getLevels() const { return _levels; }
+
+  // 트레이스를 "PT:" 로 시작하는 16진수 줄로 찍는다. 시리얼 모니터 내용을 저장해서 RamjiReplayHost에 그대로 주면 된다.
+  void printHex(uint8_t perLine = 32) {
+    static const char digits[] = "0123456789abcdef";
+    if (perLine == 0) perLine = 32;
+    for (size_t i = 0; i < _size; i += perLine) {
+      Serial.print("PT:");
+      for (size_t j = i; j < _size && j < i + perLine; ++j) {
+        Serial.print(digits[_buf[j] >> 4]);
+        Serial.print(digits[_buf[j] & 0x0F]);
+      }
+      Serial.println();
+    }
+  }
+
+private:
+  uint8_t _buf[Capacity];
+  size_t _size = 0;
+  uint8_t _pin[MaxChannels];
+  CD74HC4067* _mux[MaxChannels];
+  size_t _channels = 0;
+  unsigned long _start = 0;
+  unsigned long _last = 0; // 마지막 레코드 시간. 다음 레코드의 지난 시간 기준.
+  uint32_t _levels = 0;
+  uint32_t _dropped = 0;
+  bool _full = false;
+
+  uint32_t channelMask() const { return (_channels >= 32) ? 0xFFFFFFFFUL : ((1UL << _channels) - 1); }
+
+  static uint8_t lowestBit(uint32_t v) {
+    uint8_t i = 0;
+    while (!(v & 1u)) { v >>= 1; ++i; }
+    return i;
+  }
+
+  uint32_t readLevels() {
+    uint32_t levels = 0;
+    for (size_t i = 0; i < _channels; ++i) {
+      int v = _mux[i] ? _mux[i]->dRead(_pin[i]) : digitalRead(_pin[i]);
+      if (v) levels |= (1UL << i);
+    }
+    return levels;
+  }
+
+  bool append(uint8_t ch, uint8_t level, unsigned long t) {
+    uint64_t v = (static_cast<uint64_t>(t - _last) << 6) | (static_cast<uint64_t>(level) << 5) | ch;
+    uint8_t tmp[PINTRACE_MAX_RECORD];
+    size_t n = 0;
+    do {
+      uint8_t b = v & 0x7F;
+      v >>= 7;
+      tmp[n++] = v ? (b | 0x80) : b;
+    } while (v);
+    if (_size + n > Capacity) return false;
+    memcpy(_buf + _size, tmp, n);
+    _size += n;
+    _last = t;
+    return true;
+  }
+
+  void put32(size_t at, uint32_t v) {
+    for (uint8_t i = 0; i < 4; ++i) _buf[at + i] = static_cast<uint8_t>(v >> (8 * i));
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(RAMJI_HOST)
+
+// 리플레이에서 판정된 액션 하나.
+struct ReplayAction {
+  unsigned long time;    // 판정 시간. 트레이스 시작 기준 ms.
+  uint8_t key;           // report()에 준 키 번호.
+  int8_t action;         // enum ACTION.
+  uint8_t repeat;        // MANYPRESS 반복 횟수. 나머지는 1.
+  unsigned long latency; // 관련 채널의 마지막 핀 변화부터 판정까지 ms.
+};
+
+// PinTraceReplay
+// - 트레이스 채널을 가상 핀에 걸고(mapPin/mapMux), 가상 시계를 스캔 주기만큼 밀어가며 scan 콜백을 부른다.
+//   콜백에서 button.event() 등을 돌리고, 판정된 액션을 report()로 알려준다.
+// - 실제 시간은 전혀 기다리지 않는다. 스캔 한 번의 비용만큼만 걸리므로 실시간보다 수천 배 빠르다. speedup()으로 확인.
+// - 같은 트레이스, 같은 스캔 주기면 결과는 항상 같다. 타이밍 상수를 고치기 전 결과를 saveActions()로 골든으로 떠놓고,
+//   고친 뒤 compare()로 달라진 판정을 본다.
+// - host::reset()은 부르지 않는다. 핀 모드 등은 버튼 생성자가 이미 정해둔 걸 그대로 쓴다. 대신 가상 시계는 옮긴다.
+//
+// PinTraceReplay replay;
+// replay.loadFile("panel.trace");
+// replay.mapPin(0, buttonPin01);
+// replay.run([](PinTraceReplay& r, void*) { if (int8_t a = button1.event()) r.report(0, a, button1.getRepeatCount()); });
+// PinTraceReplay::compare(golden, replay.actions(), 5);
+class PinTraceReplay {
+public:
+  typedef void (*ScanFunction)(PinTraceReplay& replay, void* ctx);
+
+  PinTraceReplay() {
+    for (uint8_t i = 0; i < 32; ++i) {
+      _map[i] = Unmapped;
+      _muxOf[i] = -1;
+    }
+  }
+
+  // 바이너리 트레이스를 읽는다. 헤더가 맞지 않거나 레코드가 잘려 있으면 false.
+  bool load(const uint8_t* data, size_t size) {
+    _edges.clear();
+    if (!data || size < PINTRACE_HEADER_SIZE) return false;
+    if (data[0] != 'R' || data[1] != 'P' || data[2] != 'T' || data[3] != PINTRACE_VERSION) return false;
+    _channels = data[4];
+    if (_channels > 32) return false;
+    _start = get32(data + 8);
+    _initial = get32(data + 12);
+    _duration = get32(data + 16);
+    unsigned long t = 0;
+    size_t i = PINTRACE_HEADER_SIZE;
+    while (i < size) {
+      uint64_t v = 0;
+      uint8_t shift = 0;
+      for (;;) {
+        if (i >= size || shift > 63) return false;
+        uint8_t b = data[i++];
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        shift += 7;
+        if (!(b & 0x80)) break;
+      }
+      t += static_cast<unsigned long>(v >> 6);
+      Edge e = { t, static_cast<uint8_t>(v & 0x1F), static_cast<uint8_t>((v >> 5) & 1u) };
+      if (e.channel >= _channels) return false;
+      _edges.push_back(e);
+    }
+    if (!_edges.empty() && _edges.back().time > _duration) _duration = _edges.back().time;
+    return true;
+  }
+
+  // 파일에서 읽는다. 바이너리("RPT"로 시작)이거나, printHex()가 찍은 "PT:" 줄이 섞인 시리얼 로그.
+  bool loadFile(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    std::vector<uint8_t> raw;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) raw.insert(raw.end(), chunk, chunk + n);
+    fclose(f);
+    if (raw.size() >= 3 && raw[0] == 'R' && raw[1] == 'P' && raw[2] == 'T') return load(raw.data(), raw.size());
+
+    std::vector<uint8_t> bytes;
+    for (size_t i = 0; i + 3 <= raw.size(); ++i) {
+      if ((i > 0 && raw[i - 1] != '\n') || raw[i] != 'P' || raw[i + 1] != 'T' || raw[i + 2] != ':') continue;
+      for (i += 3; i + 1 < raw.size(); i += 2) {
+        int hi = hexValue(raw[i]);
+        int lo = hexValue(raw[i + 1]);
+        if (hi < 0 || lo < 0) break;
+        bytes.push_back(static_cast<uint8_t>((hi << 4) | lo));
+      }
+    }
+    return load(bytes.data(), bytes.size());
+  }
+
+  // 트레이스 채널을 직접 핀에 건다.
+  void mapPin(uint8_t channel, uint8_t pin) {
+    if (channel >= 32) return;
+    _map[channel] = pin;
+    _muxOf[channel] = -1;
+  }
+
+  // 트레이스 채널을 CD74HC4067 채널에 건다. 시그널 핀을 읽을 때 S0~S3 핀의 가상 레벨로 선택된 채널을 보고 값을 준다.
+  void mapMux(uint8_t channel, uint8_t sig, uint8_t p0, uint8_t p1, uint8_t p2, uint8_t p3, uint8_t muxChannel) {
+    if (channel >= 32) return;
+    _map[channel] = sig;
+    _muxOf[channel] = static_cast<int8_t>(muxChannel & 0x0F);
+    _sel[channel][0] = p0;
+    _sel[channel][1] = p1;
+    _sel[channel][2] = p2;
+    _sel[channel][3] = p3;
+  }
+
+  // 가상 시계를 한 번에 미는 양. 실제 루프의 스캔 주기(every(0, 10)이면 10)에 맞춘다. 기본 1ms.
+  void setScanPeriod(unsigned long ms) { _period = (ms > 0) ? ms : 1; }
+  // 트레이스가 끝난 뒤에 더 돌리는 시간. 마지막 클릭의 SHORT_REPRESS_TIME 대기가 끝나야 판정이 나오므로. 기본 2000ms.
+  void setTail(unsigned long ms) { _tail = ms; }
+
+  // 처음부터 끝까지 한 번 돌린다. 스캔 횟수를 돌려준다. 이전 run()의 결과는 지운다.
+  unsigned long run(ScanFunction scan, void* ctx = nullptr) {
+    _actions.clear();
+    _levels = _initial;
+    for (uint8_t i = 0; i < 32; ++i) _lastEdge[i] = 0;
+    _anyEdge = 0;
+    for (uint8_t ch = 0; ch < _channels; ++ch) applyLevel(ch);
+    bool hook = false;
+    for (uint8_t ch = 0; ch < _channels; ++ch) {
+      if (_map[ch] != Unmapped && _muxOf[ch] >= 0) hook = true;
+    }
+    if (hook) host::setReadHook(readHook, this);
+
+    auto wallStart = std::chrono::steady_clock::now();
+    host::setMillis(_start);
+    size_t next = 0;
+    unsigned long scans = 0;
+    const unsigned long end = _duration + _tail;
+    for (;;) {
+      _now = millis() - _start;
+      while (next < _edges.size() && _edges[next].time <= _now) {
+        const Edge& e = _edges[next++];
+        if (e.level) _levels |= (1UL << e.channel);
+        else _levels &= ~(1UL << e.channel);
+        _lastEdge[e.channel] = e.time;
+        _anyEdge = e.time;
+        applyLevel(e.channel);
+      }
+      if (scan) scan(*this, ctx);
+      ++scans;
+      if (_now >= end) break;
+      // 콜백 안에서 delay()로 시계가 이미 지나갔으면 거기서부터 한 주기.
+      host::setMillis(millis() + _period);
+    }
+    auto wall = std::chrono::steady_clock::now() - wallStart;
+    _wallNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(wall).count());
+    if (hook) host::setReadHook(nullptr);
+    return scans;
+  }
+
+  // scan 콜백에서 판정된 액션을 알려준다.
+  // 지연은 channelMask에 든 채널들 중 가장 최근 핀 변화부터 잰다. 0이면 key가 채널 번호 안쪽일 때는 그 채널, 아니면 모든 채널.
+  // 조합키는 두 채널을 같이 주면 된다. report(100, a, r, (1UL << 0) | (1UL << 1));
+  void report(uint8_t key, int8_t action, uint8_t repeat = 1, uint32_t channelMask = 0) {
+    if (action == NO_ACTION) return;
+    if (channelMask == 0) channelMask = (key < _channels) ? (1UL << key) : 0xFFFFFFFFUL;
+    unsigned long edge = 0;
+    if (channelMask == 0xFFFFFFFFUL) edge = _anyEdge;
+    else {
+      for (uint8_t ch = 0; ch < 32; ++ch) {
+        if ((channelMask >> ch) & 1u) edge = (_lastEdge[ch] > edge) ? _lastEdge[ch] : edge;
+      }
+    }
+    ReplayAction a = { _now, key, action, repeat, _now - edge };
+    _actions.push_back(a);
+  }
+
+  const std::vector<ReplayAction>& actions() const { return _actions; }
+  uint8_t channels() const { return _channels; }
+  unsigned long duration() const { return _duration; }
+  size_t transitions() const { return _edges.size(); }
+  unsigned long now() const { return _now; }
+  // 마지막 run()이 트레이스 시간 대비 몇 배 빨랐는지.
+  double speedup() const { return (_wallNs > 0) ? (_duration + _tail) * 1e6 / _wallNs : 0; }
+
+  // "시간 키 액션 반복 지연" 한 줄씩. #으로 시작하는 줄은 주석.
+  static bool saveActions(const char* path, const std::vector<ReplayAction>& actions) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "# time key action repeat latency\n");
+    for (const ReplayAction& a : actions) {
+      fprintf(f, "%lu %u %d %u %lu\n", a.time, a.key, a.action, a.repeat, a.latency);
+    }
+    return fclose(f) == 0;
+  }
+
+  static bool loadActions(const char* path, std::vector<ReplayAction>& out) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    out.clear();
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+      if (line[0] == '#' || line[0] == '\n') continue;
+      unsigned long t, latency;
+      unsigned int key, repeat;
+      int action;
+      if (sscanf(line, "%lu %u %d %u %lu", &t, &key, &action, &repeat, &latency) != 5) {
+        fclose(f);
+        return false;
+      }
+      ReplayAction a = { t, static_cast<uint8_t>(key), static_cast<int8_t>(action), static_cast<uint8_t>(repeat), latency };
+      out.push_back(a);
+    }
+    fclose(f);
+    return true;
+  }
+
+  // 골든과 비교해서 다른 판정 수를 돌려준다. 키, 액션, 반복 횟수가 같고 시간이 toleranceMs 안이면 같은 판정.
+  // verbose면 빠진 것(-)과 더 생긴 것(+)을 한 줄씩 찍는다.
+  static size_t compare(const std::vector<ReplayAction>& golden, const std::vector<ReplayAction>& actual,
+                        unsigned long toleranceMs = 0, bool verbose = true) {
+    size_t i = 0, j = 0, mismatches = 0;
+    while (i < golden.size() || j < actual.size()) {
+      if (i < golden.size() && j < actual.size() && same(golden[i], actual[j], toleranceMs)) {
+        ++i;
+        ++j;
+        continue;
+      }
+      ++mismatches;
+      bool missing = (j >= actual.size()) || (i < golden.size() && golden[i].time <= actual[j].time);
+      const ReplayAction& a = missing ? golden[i++] : actual[j++];
+      if (verbose) {
+        Serial.printf("%c t=%lu key=%u action=%d repeat=%u latency=%lu\n",
+                      missing ? '-' : '+', a.time, a.key, a.action, a.repeat, a.latency);
+      }
+    }
+    return mismatches;
+  }
+
+private:
+  struct Edge {
+    unsigned long time; // 트레이스 시작 기준 ms.
+    uint8_t channel;
+    uint8_t level;
+  };
+
+  static const uint16_t Unmapped = 0xFFFF;
+
+  std::vector<Edge> _edges;
+  std::vector<ReplayAction> _actions;
+  uint8_t _channels = 0;
+  unsigned long _start = 0;
+  unsigned long _duration = 0;
+  uint32_t _initial = 0;
+  uint32_t _levels = 0;
+  unsigned long _now = 0;
+  unsigned long _lastEdge[32];
+  unsigned long _anyEdge = 0;
+  unsigned long _period = 1;
+  unsigned long _tail = 2000;
+  double _wallNs = 0;
+  uint16_t _map[32];
+  int8_t _muxOf[32];
+  uint8_t _sel[32][4];
+
+  static uint32_t get32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+         | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+  }
+
+  static int hexValue(uint8_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  }
+
+  static bool same(const ReplayAction& a, const ReplayAction& b, unsigned long toleranceMs) {
+    if (a.key != b.key || a.action != b.action || a.repeat != b.repeat) return false;
+    unsigned long d = (a.time > b.time) ? a.time - b.time : b.time - a.time;
+    return d <= toleranceMs;
+  }
+
+  // 직접 핀은 가상 핀 레벨을 바로 바꾼다. 먹스 채널은 읽기 훅이 처리한다.
+  void applyLevel(uint8_t ch) {
+    if (_map[ch] == Unmapped || _muxOf[ch] >= 0) return;
+    host::setPin(static_cast<uint8_t>(_map[ch]), ((_levels >> ch) & 1u) ? HIGH : LOW);
+  }
+
+  static int readHook(uint8_t pin, void* ctx) {
+    PinTraceReplay* self = static_cast<PinTraceReplay*>(ctx);
+    for (uint8_t ch = 0; ch < self->_channels; ++ch) {
+      if (self->_map[ch] != pin) continue;
+      if (self->_muxOf[ch] < 0) return ((self->_levels >> ch) & 1u) ? HIGH : LOW;
+      const uint8_t* s = self->_sel[ch];
+      int selected = (host::getPin(s[0]) ? 1 : 0) | (host::getPin(s[1]) ? 2 : 0)
+                   | (host::getPin(s[2]) ? 4 : 0) | (host::getPin(s[3]) ? 8 : 0);
+      if (selected == self->_muxOf[ch]) return ((self->_levels >> ch) & 1u) ? HIGH : LOW;
+    }
+    return host::getPin(pin);
+  }
+};
+
+#endif // RAMJI_HOST
+
+#endif //PINTRACE_H
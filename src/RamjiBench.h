@@ -0,0 +1,323 @@
+#ifndef RAMJIBENCH_H
+#define RAMJIBENCH_H
+
+// RamjiBench
+// - Button::event(), TwoButtonCombo::event(), CD74HC4067::selectChannel(), 큐들의 push/pop, MemoryPool::alloc 비용을 잰다.
+// - 같은 코드가 보드(스케치)와 호스트(CMake의 RamjiBenchHost) 양쪽에서 돈다.
+//   보드에서는 사이클 카운터(ESP32 ccount, RP2040 rp2040.getCycleCount(), Cortex-M3/M4/M7 DWT)를 쓰고, 없으면 micros().
+//   호스트에서는 std::chrono::steady_clock. 가상 시계는 스캔마다 1ms씩 밀어서 FSM이 실제처럼 흘러가게 한다.
+// - 결과는 한 줄에 하나씩 JSON으로 Serial에 찍는다. 호스트에서는 stdout. 파이썬이나 jq로 바로 읽을 수 있다.
+//   {"bench":"button_event","backend":"rp2040","n":64,"iters":1000,"ns_per_op":812.5,"ops_per_sec":1230769.2,"scans_per_sec":19230.7,"allocs":null}
+//   - n: 뱅크 크기(버튼 수)나 조합 수, 배치 크기.
+//   - ns_per_op: 버튼 하나의 event() 한 번, 큐 push+pop 한 쌍 같은 단위 작업 하나의 시간.
+//   - scans_per_sec: 뱅크 전체를 한 번 훑는 걸 1초에 몇 번 할 수 있는지. 스캔이 아닌 벤치는 null.
+//   - allocs: 재는 동안 일어난 힙 할당 수. setAllocCounter()로 세는 함수를 줬을 때만. 아니면 null.
+//
+// #include "RamjiBench.h"
+// RamjiBench bench(2);     // 버튼들이 읽을 핀. 아무것도 안 연결된 INPUT_PULLUP 핀이면 된다.
+// bench.setMuxPins(3, 4, 5, 6); // CD74HC4067 S0~S3. 안 주면 mux_select는 건너뛴다.
+// bench.setMaxBank(256);   // RAM이 작은 보드는 뱅크 크기 상한을 줄인다. 기본 1024.
+// bench.runAll();
+
+#include <Arduino.h>
+#include <new>
+#include "RamjiButton.h"
+#include "UniversalQueue.h"
+
+#if defined(RAMJI_HOST)
+  #include <chrono>
+#endif
+
+#if defined(RAMJI_HOST)
+  #define RAMJIBENCH_BACKEND "host"
+#elif defined(USE_FREERTOS)
+  #define RAMJIBENCH_BACKEND "freertos"
+#elif defined(ARDUINO_ARCH_RP2040)
+  #define RAMJIBENCH_BACKEND "rp2040"
+#else
+  #define RAMJIBENCH_BACKEND "none"
+#endif
+
+class RamjiBench {
+public:
+  explicit RamjiBench(uint8_t pin) : pin(pin) {}
+
+  // CD74HC4067 벤치에 쓸 S0~S3 핀. 안 주면 mux_select 벤치는 건너뛴다.
+  void setMuxPins(uint8_t p0, uint8_t p1, uint8_t p2, uint8_t p3) {
+    muxPins[0] = p0;
+    muxPins[1] = p1;
+    muxPins[2] = p2;
+    muxPins[3] = p3;
+    hasMux = true;
+  }
+
+  // 뱅크 크기를 1, 4, 16, 64, 256, 1024 순서로 늘려가는데, 이 값을 넘는 건 건너뛴다.
+  void setMaxBank(uint32_t n) { maxBank = n; }
+  // 뱅크 스캔 벤치에서 뱅크 전체를 몇 번 훑을지. 큐 벤치는 이것의 100배만큼 돈다.
+  void setScans(uint32_t n) { scans = (n > 0) ? n : 1; }
+  // 힙 할당 수를 돌려주는 함수. 호스트에서는 operator new를 가로채서 센다.
+  void setAllocCounter(long (*counter)()) { allocCounter = counter; }
+  // 호스트에서만. 스캔 중에 버튼들을 눌렀다 뗐다 해서 FSM의 판정 경로까지 잰다. 기본은 안 눌린 상태만.
+  void setActiveInput(bool active) { activeInput = active; }
+
+  void runAll() {
+    static const uint32_t sizes[] = { 1, 4, 16, 64, 256, 1024 };
+    for (uint32_t n : sizes) {
+      if (n > maxBank) break;
+      benchButtonEvent(n);
+    }
+    for (uint32_t n : sizes) {
+      if (n > maxBank / 2 || n > 256) break;
+      benchTwoButtonCombo(n);
+    }
+    if (hasMux) benchMuxSelect();
+    benchQueues();
+  }
+
+  // 버튼 n개짜리 뱅크. 스캔 한 번 = 버튼 n개 모두의 event().
+  void benchButtonEvent(uint32_t n) {
+    Button* bank = makeButtons(n);
+    if (!bank) return;
+    int8_t sink = 0;
+    Span span = begin();
+    for (uint32_t s = 0; s < scans; ++s) {
+      tick(s);
+      for (uint32_t i = 0; i < n; ++i) sink ^= bank[i].event();
+    }
+    end("button_event", n, scans, scans * n, span, true);
+    keep(sink);
+    destroyButtons(bank, n);
+  }
+
+  // 두 버튼 조합 n개. 스캔 한 번 = 조합 n개 모두의 event() (버튼 2n개).
+  void benchTwoButtonCombo(uint32_t n) {
+    Button* bank = makeButtons(n * 2);
+    if (!bank) return;
+    TwoButtonCombo* combos = static_cast<TwoButtonCombo*>(::operator new(sizeof(TwoButtonCombo) * n, std::nothrow));
+    if (!combos) {
+      destroyButtons(bank, n * 2);
+      return;
+    }
+    for (uint32_t i = 0; i < n; ++i) new (&combos[i]) TwoButtonCombo(bank[2 * i], bank[2 * i + 1]);
+    int8_t sink = 0;
+    Span span = begin();
+    for (uint32_t s = 0; s < scans; ++s) {
+      tick(s);
+      for (uint32_t i = 0; i < n; ++i) sink ^= combos[i].event()[2];
+    }
+    end("combo_event", n, scans, scans * n, span, true);
+    keep(sink);
+    for (uint32_t i = 0; i < n; ++i) combos[i].~TwoButtonCombo();
+    ::operator delete(combos);
+    destroyButtons(bank, n * 2);
+  }
+
+  // CD74HC4067 채널 선택. 16채널을 돌아가며. 안정화 delay는 빼고 핀 쓰기 비용만.
+  void benchMuxSelect() {
+    CD74HC4067 mux(muxPins[0], muxPins[1], muxPins[2], muxPins[3], pin);
+    uint32_t iters = scans * 16;
+    Span span = begin();
+    for (uint32_t i = 0; i < iters; ++i) mux.selectChannel(static_cast<uint8_t>(i & 0x0F));
+    end("mux_select", 16, iters, iters, span, false);
+  }
+
+  void benchQueues() {
+    const uint32_t iters = scans * 100;
+    {
+      UniversalQueue<int8_t> q(64);
+      if (q.isInitialized()) {
+        int8_t v = CLICK;
+        Span span = begin();
+        for (uint32_t i = 0; i < iters; ++i) {
+          q.push(v);
+          q.pop(v);
+        }
+        end("queue_push_pop", 1, iters, iters, span, false);
+      }
+    }
+    {
+      UniversalQueue<int8_t> q(64);
+      if (q.isInitialized()) {
+        int8_t items[8] = { CLICK, CLICK, CLICK, CLICK, CLICK, CLICK, CLICK, CLICK };
+        uint32_t batches = iters / 8;
+        Span span = begin();
+        for (uint32_t i = 0; i < batches; ++i) {
+          q.pushN(items, 8);
+          q.popN(items, 8);
+        }
+        end("queue_pushN_popN", 8, batches, batches * 8, span, false);
+      }
+    }
+#if UNIVERSALQUEUE_STATIC_ALLOCATION
+    {
+      StaticUniversalQueue<int8_t, 64> q;
+      if (q.isInitialized()) {
+        int8_t v = CLICK;
+        Span span = begin();
+        for (uint32_t i = 0; i < iters; ++i) {
+          q.push(v);
+          q.pop(v);
+        }
+        end("static_queue_push_pop", 1, iters, iters, span, false);
+      }
+    }
+#endif
+    {
+      MemoryPool<BenchBox, 16> pool;
+      Span span = begin();
+      for (uint32_t i = 0; i < iters; ++i) pool.free(pool.alloc());
+      end("pool_alloc_free", 16, iters, iters, span, false);
+    }
+    {
+      MemoryPoolQueue<BenchBox, 16> q;
+      BenchBox* box = nullptr;
+      Span span = begin();
+      for (uint32_t i = 0; i < iters; ++i) {
+        box = q.allocate();
+        if (box && !q.push(box)) q.free(box);
+        if (q.pop(box)) q.free(box);
+      }
+      end("pool_queue_cycle", 16, iters, iters, span, false);
+    }
+    {
+      PriorityQueue<int8_t, NUMBER_OF_PRIORITIES> q(16);
+      if (q.isInitialized()) {
+        int8_t v = CLICK;
+        Span span = begin();
+        for (uint32_t i = 0; i < iters; ++i) {
+          q.push(v, static_cast<uint8_t>(i % NUMBER_OF_PRIORITIES));
+          q.pop(v);
+        }
+        end("priority_queue_push_pop", NUMBER_OF_PRIORITIES, iters, iters, span, false);
+      }
+    }
+    benchEventBus(1, iters);
+    benchEventBus(4, iters);
+  }
+
+private:
+  struct BenchBox {
+    int8_t action;
+    uint8_t repeat;
+    int param;
+  };
+
+  struct Span {
+    long allocs;
+  };
+
+  uint8_t pin;
+  uint8_t muxPins[4] = { 0, 0, 0, 0 };
+  bool hasMux = false;
+  uint32_t maxBank = 1024;
+  uint32_t scans = 1000;
+  long (*allocCounter)() = nullptr;
+  bool activeInput = false;
+  volatile int32_t keepSink = 0; // keep()이 쓰는 곳.
+
+  // 구독자 subs개. 한 번 publish하고 구독자 모두가 read.
+  void benchEventBus(uint8_t subs, uint32_t iters) {
+    EventBus<BenchBox, 32, 4> bus;
+    int8_t ids[4];
+    for (uint8_t i = 0; i < subs; ++i) ids[i] = bus.subscribe();
+    BenchBox box = { CLICK, 1, 0 };
+    Span span = begin();
+    for (uint32_t i = 0; i < iters; ++i) {
+      box.param = static_cast<int>(i);
+      bus.publish(box);
+      for (uint8_t k = 0; k < subs; ++k) bus.read(ids[k], box);
+    }
+    end("event_bus_fanout", subs, iters, iters, span, false);
+  }
+
+  Button* makeButtons(uint32_t n) {
+    Button* bank = static_cast<Button*>(::operator new(sizeof(Button) * n, std::nothrow));
+    if (!bank) return nullptr;
+    for (uint32_t i = 0; i < n; ++i) new (&bank[i]) Button(pin);
+    return bank;
+  }
+
+  void destroyButtons(Button* bank, uint32_t n) {
+    for (uint32_t i = 0; i < n; ++i) bank[i].~Button();
+    ::operator delete(bank);
+  }
+
+  // 스캔 한 번의 시작. 호스트는 가상 시계를 1ms 밀고, 필요하면 입력을 바꾼다. 보드는 실제 시간 그대로.
+  void tick(uint32_t scan) {
+#if defined(RAMJI_HOST)
+    host::advanceMillis(1);
+    // 300ms 주기로 80ms 누르고 뗀다. 클릭, 연속 클릭 판정 경로를 지나가게.
+    if (activeInput) host::setPin(pin, (scan % 300) < 80 ? LOW : HIGH);
+#else
+    (void)scan;
+#endif
+  }
+
+  // 컴파일러가 재는 루프를 통째로 지우지 못하게. volatile 멤버에 쓰는 건 지울 수 없는 부수 효과라서
+  // v를 만드는 계산도 남는다. 함수 안 static으로 두면 읽는 곳이 없다고 경고가 난다.
+  void keep(int32_t v) { keepSink = v; }
+
+  Span begin() {
+    Span span;
+    span.allocs = allocCounter ? allocCounter() : -1;
+    startClock();
+    return span;
+  }
+
+  void end(const char* name, uint32_t n, uint32_t iters, uint32_t ops, const Span& span, bool scan) {
+    double ns = elapsedNs();
+    long allocs = (allocCounter && span.allocs >= 0) ? allocCounter() - span.allocs : -1;
+    double nsPerOp = ops ? ns / ops : 0;
+    Serial.print("{\"bench\":\"");
+    Serial.print(name);
+    Serial.print("\",\"backend\":\"" RAMJIBENCH_BACKEND "\",\"n\":");
+    Serial.print(static_cast<unsigned long>(n));
+    Serial.print(",\"iters\":");
+    Serial.print(static_cast<unsigned long>(iters));
+    Serial.print(",\"ns_per_op\":");
+    Serial.print(nsPerOp, 2);
+    Serial.print(",\"ops_per_sec\":");
+    Serial.print(nsPerOp > 0 ? 1e9 / nsPerOp : 0.0, 1);
+    Serial.print(",\"scans_per_sec\":");
+    if (scan && ns > 0) Serial.print(iters * 1e9 / ns, 1);
+    else Serial.print("null");
+    Serial.print(",\"allocs\":");
+    if (allocs >= 0) Serial.print(allocs);
+    else Serial.print("null");
+    Serial.println("}");
+  }
+
+  // 사이클 카운터. 잴 때만 쓰는 시계라서 한 벤치 안에서만 의미가 있다.
+#if defined(RAMJI_HOST)
+  std::chrono::steady_clock::time_point t0;
+  void startClock() { t0 = std::chrono::steady_clock::now(); }
+  double elapsedNs() {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count());
+  }
+#elif defined(ARDUINO_ARCH_ESP32)
+  uint32_t c0 = 0;
+  void startClock() { c0 = ESP.getCycleCount(); }
+  double elapsedNs() { return (ESP.getCycleCount() - c0) * 1000.0 / ESP.getCpuFreqMHz(); }
+#elif defined(ARDUINO_ARCH_RP2040) && !defined(ARDUINO_ARCH_MBED)
+  // arduino-pico 코어. SysTick으로 센 64비트 사이클.
+  uint64_t c0 = 0;
+  void startClock() { c0 = rp2040.getCycleCount64(); }
+  double elapsedNs() { return (rp2040.getCycleCount64() - c0) * 1e9 / rp2040.f_cpu(); }
+#elif (defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)) && defined(F_CPU)
+  // Cortex-M3/M4/M7 DWT 사이클 카운터. 32비트라서 F_CPU에 따라 수십 초 이상은 잴 수 없다.
+  uint32_t c0 = 0;
+  static volatile uint32_t& reg(uintptr_t addr) { return *reinterpret_cast<volatile uint32_t*>(addr); }
+  void startClock() {
+    reg(0xE000EDFC) |= (1UL << 24); // DEMCR.TRCENA
+    reg(0xE0001000) |= 1UL;         // DWT_CTRL.CYCCNTENA
+    c0 = reg(0xE0001004);           // DWT_CYCCNT
+  }
+  double elapsedNs() { return (reg(0xE0001004) - c0) * 1e9 / F_CPU; }
+#else
+  unsigned long us0 = 0;
+  void startClock() { us0 = micros(); }
+  double elapsedNs() { return (micros() - us0) * 1000.0; }
+#endif
+};
+
+#endif //RAMJIBENCH_H
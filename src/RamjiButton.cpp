@@ -59,6 +59,10 @@ void CD74HC4067::changeMode(uint8_t mode) {
     }
 }
 
+uint8_t CD74HC4067::getMode() {
+    return pinmode;
+}
+
 void CD74HC4067::selectChannel(uint8_t channel) {
     // C0(0) ~ C15(15)까지 채널 선택. 한번 선택하면 다시 선택할 때까지 그 상태가 유지된다.
     digitalWrite(pin0, channel & 0x01);
@@ -117,6 +121,29 @@ void CD74HC4067::aWrite(uint8_t channel, uint8_t duty) {
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 
+int formatTraceRecord(const TraceRecord& r, char* buf, size_t size) {
+  static const char* const states[] = { "none", "short", "long", "?" };
+  // 필드가 모두 고정 폭 정수라 가장 긴 줄도 TRACE_LINE_SIZE 안에 들어간다. 더 작은 버퍼를 받아서 잘리면 빈 줄, -1.
+  int n = snprintf(buf, size,
+                   "t:%lu pin:%u state:%s%s%s%s%s upTime-downTime:%u now-downTime:%u now-shortCallTime:%u "
+                   "now-longLogicTime:%u now-actionTime[MANYPRESS]:%u clickCount:%u action:%d",
+                   static_cast<unsigned long>(r.now), static_cast<unsigned>(r.id), states[r.flags & TRACE_STATE_MASK],
+                   (r.flags & TRACE_PRESSED) ? " pressed" : "",
+                   (r.flags & TRACE_DEBOUNCE) ? " debounce" : "",
+                   (r.flags & TRACE_MANY_TRIGGERED) ? " many" : "",
+                   (r.flags & TRACE_DISCARDED) ? " discarded" : "",
+                   static_cast<unsigned>(r.pressDuration), static_cast<unsigned>(r.sinceDown),
+                   static_cast<unsigned>(r.sinceShortCall), static_cast<unsigned>(r.sinceLongLogic),
+                   static_cast<unsigned>(r.sinceManyPress), static_cast<unsigned>(r.clickCount), static_cast<int>(r.action));
+  if (n < 0 || static_cast<size_t>(n) >= size) {
+    if (size) buf[0] = '\0';
+    return -1;
+  }
+  return n;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
 // 지정할 함수 던져주면 지정되고 안던져주면 그냥 nullptr 배정된다.
 // Button aaa(SIG_button);
 // Button aaa(SIG_button, onClick, onDoubleClick, onLongPress, onManyPress);
@@ -157,23 +184,103 @@ Button::Button(uint8_t pin
       , onNonaClick(onNonaClick)
       , onDecaClick(onDecaClick)
 {
-  pinMode(pin, pinModeValue);
+  if (pin != BUTTON_NO_PIN) pinMode(pin, pinModeValue);
   if (pinModeValue == INPUT_PULLUP) LOWHIGH = LOW;
   else if (pinModeValue == INPUT_PULLDOWN) LOWHIGH = HIGH;
 }
 
 void Button::update() {
-  pressed = (digitalRead(pin) == LOWHIGH);
+  pressed = readPressed();
 }
 
+struct ButtonDiagnostics {
+  bool latencyTracking = false; // 지연 측정용 타임스탬프를 남길지.
+  uint32_t lastScanMicros = 0; // 바로 앞 event() 호출 시점.
+  LatencyStamp latency = {0, 0, 0};
+  TraceSink* trace = nullptr; // 바이너리 트레이스. nullptr이면 기록 안 함.
+  uint8_t traceId = 0;
+  bool adaptiveDebounce = false; // 적응형 디바운스.
+  uint16_t bounceMinWindow = 10;
+  uint16_t bounceEstimate16 = 0; // 배운 바운스 길이. 1/16ms 단위.
+  uint8_t burstEdges = 0; // 지금 묶음의 핀 변화 수.
+  unsigned long burstStart = 0;
+  unsigned long lastEdgeTime = 0;
+  uint16_t bounceBursts = 0;
+};
+
+Button::Diagnostics::Diagnostics(const Diagnostics& other)
+  : p(other.p ? new ButtonDiagnostics(*other.p) : nullptr) {}
+
+Button::Diagnostics& Button::Diagnostics::operator=(const Diagnostics& other) {
+  if (this != &other) {
+    ButtonDiagnostics* copy = other.p ? new ButtonDiagnostics(*other.p) : nullptr;
+    delete p;
+    p = copy;
+  }
+  return *this;
+}
+
+Button::Diagnostics::~Diagnostics() { delete p; }
+
+// 한 번 붙이면 기능을 다 꺼도 버튼이 살아 있는 동안 둔다. 켜고 끌 때마다 힙을 건드리지 않도록.
+ButtonDiagnostics* Button::Diagnostics::attach() {
+  if (!p) p = new ButtonDiagnostics();
+  return p;
+}
+
+bool Button::readPressed() {
+  if (inputBitmap) return (inputBitmap[inputBit >> 3] >> (inputBit & 7)) & 1u;
+  if (pin == BUTTON_NO_PIN) return false; // setInput() 전의 핀 없는 버튼. 0xFF번 핀을 읽지 않는다.
+  return digitalRead(pin) == LOWHIGH;
+}
+
+void Button::setInput(const uint8_t* bitmap, uint16_t bit) {
+  inputBitmap = bitmap;
+  inputBit = bit;
+}
+
+// 트레이스가 붙어 있으면 레코드로 남기고 끝. 아니면 String 없이 스택 버퍼 하나로 찍는다.
 void Button::debugPrint() {
-  Serial.print("pin:" + String(pin)+" ");
-  Serial.print("upTime-downTime:" + String(upTime-downTime)+" ");
-  Serial.print("now-downTime:" + String(now-downTime)+" ");
-  Serial.print("now-shortCallTime:" + String(now-shortCallTime)+" ");
-  Serial.print("now-longLogicTime:" + String(now-longLogicTime)+" ");
-  Serial.print("now-actionTime[MANYPRESS]:" + String(now-actionTime[MANYPRESS])+" ");
-  Serial.println("clickCount:" + String(actionClickCount)+" ");
+  TraceRecord r = makeTraceRecord(0);
+  TraceSink* trace = getTrace();
+  if (trace) {
+    trace->record(r);
+    return;
+  }
+  char line[TRACE_LINE_SIZE];
+  if (formatTraceRecord(r, line, sizeof(line)) >= 0) Serial.println(line);
+}
+
+void Button::setTrace(TraceSink* t, uint8_t id) {
+  ButtonDiagnostics* d = t ? diag.attach() : diag.get(); // 해제할 때는 새로 붙이지 않는다.
+  if (!d) return;
+  d->trace = t;
+  d->traceId = (id == 0xFF) ? pin : id;
+}
+
+TraceSink* Button::getTrace() {
+  ButtonDiagnostics* d = diag.get();
+  return d ? d->trace : nullptr;
+}
+
+static inline uint16_t traceClamp(unsigned long ms) { return (ms > 0xFFFFUL) ? 0xFFFF : static_cast<uint16_t>(ms); }
+
+TraceRecord Button::makeTraceRecord(uint8_t extraFlags) {
+  TraceRecord r;
+  r.now = static_cast<uint32_t>(now);
+  r.pressDuration = traceClamp(upTime - downTime);
+  r.sinceDown = traceClamp(now - downTime);
+  r.sinceShortCall = traceClamp(now - shortCallTime);
+  r.sinceLongLogic = traceClamp(now - longLogicTime);
+  r.sinceManyPress = traceClamp(now - actionTime[MANYPRESS]);
+  ButtonDiagnostics* d = diag.get();
+  r.id = (d && d->trace) ? d->traceId : pin;
+  r.flags = static_cast<uint8_t>((state & TRACE_STATE_MASK) | (pressed ? TRACE_PRESSED : 0)
+          | (debounceActive ? TRACE_DEBOUNCE : 0) | (manyTriggered ? TRACE_MANY_TRIGGERED : 0) | extraFlags);
+  r.clickCount = actionClickCount;
+  r.action = action;
+  r.reserved[0] = r.reserved[1] = 0;
+  return r;
 }
 
 void Button::longPress() { if (onLongPress) onLongPress(); }
@@ -194,12 +301,37 @@ void Button::decaClick() { if (onDecaClick) onDecaClick(); }
 // 동작 판정이 없을 시 action = NO_ACTION(0)을 리턴.
 // 더 정확히는 동작 판정 시 action에 그걸 저장하고, action값을 리턴.
 int8_t Button::event() {
+    return event(millis()); // 현재 시점을 계속 체킹.
+}
+
+int8_t Button::event(unsigned long at) {
     action = NO_ACTION; // 동작 판정 전 혹시 모르니 action 초기화.
-    now = millis(); // 현재 시점을 계속 체킹.
+    now = at;
+    ButtonDiagnostics* const d = diag.get(); // 진단 기능을 하나도 안 켰으면 nullptr.
+    const bool latencyTracking = d && d->latencyTracking;
+    const bool adaptiveDebounce = d && d->adaptiveDebounce;
+    TraceSink* const trace = d ? d->trace : nullptr;
+    const uint32_t nowMicros = latencyTracking ? micros() : 0; // 지연 측정용. 꺼져 있으면 안 부른다.
+    // 설정을 한 번만 읽어서 이번 호출 동안 쓴다. 도중에 publish()돼도 이번 호출은 옛 설정으로 끝난다.
+    const ButtonProfile* profile = getProfile();
+    const unsigned long longPressTime = profile ? profile->longPressTime : LONG_PRESS_TIME;
+    const unsigned long manyTriggerTime = profile ? profile->manyTriggerTime : MANY_TRIGGER_TIME;
+    const unsigned long manyRepressTime = profile ? profile->manyRepressTime : MANY_REPRESS_TIME;
+    const unsigned long shortRepressTime = profile ? profile->shortRepressTime : SHORT_REPRESS_TIME;
+    const unsigned long discardLimit = profile ? profile->discardShortPressDuration : DISCARD_SHORT_PRESS_DURATION;
+    const unsigned long debounceLimit = profile ? profile->debounceTime : debounceInterval;
+    // 적응형 디바운스면 배운 값으로 줄인다. 설정값이 상한.
+    const unsigned long discardShortPressDuration = adaptiveDebounce ? adaptiveWindow(*d, discardLimit) : discardLimit;
+    const unsigned long debounceTime = (adaptiveDebounce && discardLimit) ? debounceLimit * discardShortPressDuration / discardLimit : debounceLimit;
+    const uint8_t stateBefore = state; // 트레이스용. 바뀐 게 있을 때만 기록한다.
+    const bool pressedBefore = pressed;
+    uint8_t manyCount = 0; // 이번 호출에서 센 MANYPRESS 반복 횟수.
+    bool manyFirst = false; // 이번 MANYPRESS가 연속 누름의 첫 번째인지. 지연 측정에서 핀 변화 기준을 정할 때.
+    unsigned long manyNextPhase = manyPhaseTime; // 이번 MANYPRESS가 받아들여지면 옮겨갈 경계 시간.
 
   // 디바운싱 체킹.
     // 디바운싱 상태인지 체크해서 시간이 지나면 해제. 해제해야 action이 판정된다.
-    if (debounceActive && now - lastActionTime >= debounceInterval) {
+    if (debounceActive && now - lastActionTime >= debounceTime) {
       debounceActive = false;
     }
 
@@ -213,20 +345,30 @@ int8_t Button::event() {
 
   // 버튼 상태 체킹.
     // 버튼 다운, 업 발생 시 실시간으로 알아차리며 그 시간과 상태를 체킹한다.
-    if(!pressed && digitalRead(pin) == LOWHIGH) {
+    if(!pressed && readPressed()) {
       downTime = now;
       pressed = Pressed;
-    } else if(pressed && digitalRead(pin) == !LOWHIGH) {
+      if (latencyTracking) { d->latency.edge = nowMicros; d->latency.scanGap = nowMicros - d->lastScanMicros; }
+      if (adaptiveDebounce) noteEdge(*d, discardLimit);
+    } else if(pressed && !readPressed()) {
       upTime = now;
       pressed = Released;
+      if (latencyTracking) { d->latency.edge = nowMicros; d->latency.scanGap = nowMicros - d->lastScanMicros; }
+      if (adaptiveDebounce) noteEdge(*d, discardLimit);
     }
+    if (latencyTracking) d->lastScanMicros = nowMicros;
 
   // 1.0.4버전에서 생긴 버튼 오동작 안전장치.
     // 디바운싱과 조금은 비슷한 오동작 방지.
     // upTime-downTime이 DISCARD_SHORT_PRESS_DURATION보다 작으면 더이상 코드 수행 안하고 무효 처리.
     // 동일 버튼이 연속으로 잘못 눌린 걸로 간주한다.
     // (MANYPRESS 시에는 Pressed 상태라서 upTime-downTime이 엄청 높게 뜨기 때문에 상관없다.)
-    if (upTime - downTime < DISCARD_SHORT_PRESS_DURATION) {
+    if (upTime - downTime < discardShortPressDuration) {
+      // 이번 호출에서 뗀 경우만 센다. 한 번도 안 눌린 처음에는 upTime == downTime이라 매번 여기로 온다.
+      if (upTime != pre_upTime) {
+        if (trace) trace->record(makeTraceRecord(TRACE_DISCARDED)); // 되돌리기 전의 짧았던 누름 시간을 남긴다.
+        if (rejectedPresses < 0xFFFF) rejectedPresses++;
+      }
       upTime = pre_upTime;
       downTime = pre_downTime;
       return NO_ACTION;
@@ -235,15 +377,16 @@ int8_t Button::event() {
   // 쇼트, 롱 로직 선정부.
     // ShortState 로직으로 들어갈지 LongState 로직으로 들어갈지 판단한다.
     // 버튼 업 시간이 갱신되었고, 다운->업 시간이 짧다면,
-    if(pre_upTime!=upTime && upTime - downTime <= LONG_PRESS_TIME) { // 버튼이 콕 눌렸다 떼어질 때마다,
+    if(pre_upTime!=upTime && upTime - downTime <= longPressTime) { // 버튼이 콕 눌렸다 떼어질 때마다,
       shortCallTime = upTime; // 시간 체킹 하고.
       clickCount++; // 클릭 카운트 올리고.
       state = intoShortStateLogic; // ShortState 로직으로 들어간다.
     }
     // 그렇지 않은 수행들 중에서.
     // LongState 로직이 아니고, 버튼이 눌려져 있고, 이전 버튼 다운 시간에서 오래 지났다면.
-    else if(state!=intoLongStateLogic && pressed == Pressed && now - downTime > LONG_PRESS_TIME) { // 버튼이 꾸욱 눌리고 있으면 LongState 로직으로 들어가고.
-      longLogicTime = now; // 시간 체킹하고.
+    else if(state!=intoLongStateLogic && pressed == Pressed && now - downTime > longPressTime) { // 버튼이 꾸욱 눌리고 있으면 LongState 로직으로 들어가고.
+      // 시간 체킹하고. 루프가 느려서 늦게 들어왔어도 롱 로직이 시작됐어야 할 시각으로 적는다.
+      longLogicTime = downTime + longPressTime + 1;
       state = intoLongStateLogic; // LongState 로직으로 들어간다.
     }
 
@@ -254,7 +397,7 @@ int8_t Button::event() {
     case intoShortStateLogic:
       // 현재 시점과 최근 짧게 누름 시간의 차이가 재누름 시간 한도보다 초과했다면 액션을 수행한다.
       // 아직 재누름 시간 초과 안했으면 아무것도 안한다.
-      if(now-shortCallTime > SHORT_REPRESS_TIME) {
+      if(now-shortCallTime > shortRepressTime) {
         switch (clickCount) {
         case 1: action = CLICK; break;
         case 2: action = DOUBLECLICK; break;
@@ -276,11 +419,40 @@ int8_t Button::event() {
       // 버튼이 눌려있고, 연속 누름이 활성화되었다면,
       if(pressed && manyTriggered) {
         // 연속 누름 시간이 되면 계속 수행.
-        if(now-actionTime[MANYPRESS] >= MANY_REPRESS_TIME) action = MANYPRESS;
+        // 지난 보고 이후 반복 간격이 몇 번 지나갔는지 센다. 루프가 느리면 여러 번, 빠르면 아직 0번.
+        // 경계 시간(phase)을 간격 단위로 나아가게 해서 자투리 시간이 버려지지 않는다.
+        unsigned long phase = manyPhaseTime;
+        unsigned long interval = manyRepressInterval(phase, manyRepressTime);
+        while(now - phase >= interval && manyCount < MAX_REPEAT_COUNT) {
+          phase += interval;
+          manyCount++;
+          interval = manyRepressInterval(phase, manyRepressTime);
+        }
+        // 너무 밀렸으면 밀린 건 버리고 지금부터 다시 센다.
+        if(manyCount >= MAX_REPEAT_COUNT) phase = now;
+        if(manyCount) {
+          action = MANYPRESS;
+          manyNextPhase = phase;
+        }
       }
       // 버튼이 눌려있고, 현재 재누름 시간이 지났다면,
-      else if(pressed && now-longLogicTime >= MANY_TRIGGER_TIME) {
+      else if(pressed && now-longLogicTime >= manyTriggerTime) {
         manyTriggered = true; // 연속 누름 활성화.
+        // 연속 누름은 now가 아니라 시작됐어야 할 경계 시각부터 센다.
+        // 루프가 늦게 와서 그 사이 지나간 반복 간격도 첫 MANYPRESS의 반복 횟수에 합친다.
+        unsigned long phase = longLogicTime + manyTriggerTime;
+        manyStartTime = phase;
+        manyCount = 1;
+        unsigned long interval = manyRepressInterval(phase, manyRepressTime);
+        while(now - phase >= interval && manyCount < MAX_REPEAT_COUNT) {
+          phase += interval;
+          manyCount++;
+          interval = manyRepressInterval(phase, manyRepressTime);
+        }
+        if(manyCount >= MAX_REPEAT_COUNT) phase = now;
+        manyPhaseTime = phase;
+        manyNextPhase = phase;
+        manyFirst = true;
         action = MANYPRESS;
       }
       // 그 전에 버튼이 떼어졌다면,
@@ -301,6 +473,18 @@ int8_t Button::event() {
   if (action!=NO_ACTION && !debounceActive) {
     // debugPrint(); // 디버깅용..
     actionTime[action] = now; // 시간 체킹하기.
+    lastAction = action;
+    if (latencyTracking) {
+      d->latency.detect = micros();
+      // 두 번째 MANYPRESS부터는 핀 변화가 없으니 판정 시점부터 잰다. 누른 시점부터 재면 누르고 있는 시간이 된다.
+      if (action == MANYPRESS && !manyFirst) { d->latency.edge = d->latency.detect; d->latency.scanGap = 0; }
+    }
+    // 반복 횟수 기록. 디바운싱으로 막힌 MANYPRESS는 경계 시간이 안 옮겨져서 다음 호출 때 함께 세어진다.
+    if (action == MANYPRESS) {
+      manyPhaseTime = manyNextPhase;
+      repeatCount = manyCount;
+    }
+    else repeatCount = 1;
     // 판정된 게 MANYPRESS일 경우에는 디바운싱 체킹 안하고 바로 통과.
     if (action!=MANYPRESS) { // 1.0.3버전에서 MANYPRESS일 때에는 디바운싱이 동작하지 않게 되도록 수정한 부분.
       debounceActive = true;
@@ -310,6 +494,7 @@ int8_t Button::event() {
   // 감지된 게 있지만, 디바운싱이 활성화돼있는 상태이거나,
   // 감지된 게 없으면, action은 NO_ACTION이 된다.
   else action = NO_ACTION;
+  if (trace && (action != NO_ACTION || state != stateBefore || pressed != pressedBefore)) trace->record(makeTraceRecord(0));
   return action; // action을 반환
 }
 
@@ -327,6 +512,12 @@ int8_t Button::event() {
 void Button::doIt(int8_t a) {
   // Serial.println(a); // 디버깅.. 이 함수가 실행은 되었는지, 어느 액션 번호를 받았는지 확인.
   // if(a != NO_ACTION) debugPrint(); // 디버깅..
+  // 설정에 핸들러가 있으면 그걸 먼저 쓴다.
+  const ButtonProfile* profile = getProfile();
+  if (profile && a > NO_ACTION && a < NUMBER_OF_ACTIONS && profile->handlers[a]) {
+    profile->handlers[a]();
+    return;
+  }
   if (a != NO_ACTION) {
     switch (a) {
       case NO_ACTION: break;
@@ -347,6 +538,143 @@ void Button::doIt(int8_t a) {
   }
 }
 
+// MANYPRESS는 반복 횟수만큼 수행한다.
+void Button::doIt(int8_t a, uint8_t repeat) {
+  if (a != MANYPRESS) repeat = 1;
+  for (uint8_t i = 0; i < repeat; i++) doIt(a);
+}
+
+uint8_t Button::getRepeatCount() { return repeatCount; }
+
+void Button::setManyPressAcceleration(unsigned long minRepressTime, unsigned long rampTime) {
+  manyRepressMin = (minRepressTime > 0) ? minRepressTime : 1;
+  manyAccelTime = rampTime;
+}
+
+void Button::setProfile(decltype(nullptr), uint8_t index) {
+  profileSource = nullptr;
+  profileRead = nullptr;
+  profileIndex = index;
+}
+
+const ButtonProfile* Button::getProfile() {
+  if (!profileRead) return nullptr;
+  const ButtonProfile* p = profileRead(profileSource);
+  return p ? &p[profileIndex] : nullptr;
+}
+
+void Button::setLatencyTracking(bool enabled) {
+  ButtonDiagnostics* d = enabled ? diag.attach() : diag.get();
+  if (!d) return;
+  d->latencyTracking = enabled;
+  d->lastScanMicros = micros(); // 켜자마자의 첫 호출에서 앞 호출 간격이 엉뚱하게 크게 잡히지 않도록.
+}
+
+bool Button::isLatencyTracking() {
+  ButtonDiagnostics* d = diag.get();
+  return d && d->latencyTracking;
+}
+
+LatencyStamp Button::getLatencyStamp() {
+  ButtonDiagnostics* d = diag.get();
+  if (d) return d->latency;
+  LatencyStamp none = {0, 0, 0};
+  return none;
+}
+
+void Button::setAdaptiveDebounce(bool enabled, unsigned long minWindow) {
+  ButtonDiagnostics* d = enabled ? diag.attach() : diag.get();
+  if (d) {
+    d->adaptiveDebounce = enabled;
+    d->bounceMinWindow = static_cast<uint16_t>(minWindow > 0xFFFF ? 0xFFFF : minWindow);
+  }
+  resetAdaptiveDebounce();
+}
+
+bool Button::isAdaptiveDebounce() {
+  ButtonDiagnostics* d = diag.get();
+  return d && d->adaptiveDebounce;
+}
+
+void Button::resetAdaptiveDebounce() {
+  // 처음에는 설정값 그대로 쓰도록, 무시 시간이 상한이 되는 추정값에서 시작한다.
+  const ButtonProfile* profile = getProfile();
+  unsigned long limit = profile ? profile->discardShortPressDuration : DISCARD_SHORT_PRESS_DURATION;
+  unsigned long start = limit * 16 * 2 / 3;
+  rejectedPresses = 0;
+  ButtonDiagnostics* d = diag.get();
+  if (!d) return;
+  d->bounceEstimate16 = static_cast<uint16_t>(start > 0xFFFF ? 0xFFFF : start);
+  d->burstEdges = 0;
+  d->bounceBursts = 0;
+}
+
+unsigned long Button::getBounceEstimate() {
+  ButtonDiagnostics* d = diag.get();
+  return d ? (d->bounceEstimate16 + 15) / 16 : 0;
+}
+
+unsigned long Button::getDiscardWindow() {
+  const ButtonProfile* profile = getProfile();
+  unsigned long limit = profile ? profile->discardShortPressDuration : DISCARD_SHORT_PRESS_DURATION;
+  ButtonDiagnostics* d = diag.get();
+  return (d && d->adaptiveDebounce) ? adaptiveWindow(*d, limit) : limit;
+}
+
+unsigned long Button::getDebounceWindow() {
+  const ButtonProfile* profile = getProfile();
+  unsigned long discardLimit = profile ? profile->discardShortPressDuration : DISCARD_SHORT_PRESS_DURATION;
+  unsigned long debounceLimit = profile ? profile->debounceTime : debounceInterval;
+  ButtonDiagnostics* d = diag.get();
+  if (!d || !d->adaptiveDebounce || !discardLimit) return debounceLimit;
+  return debounceLimit * adaptiveWindow(*d, discardLimit) / discardLimit;
+}
+
+uint16_t Button::getBounceBursts() {
+  ButtonDiagnostics* d = diag.get();
+  return d ? d->bounceBursts : 0;
+}
+uint16_t Button::getRejectedPresses() { return rejectedPresses; }
+
+// 앞 변화와 limit 안에 붙어 있으면 같은 묶음. 누르고 떼는 깨끗한 짧은 누름은 변화가 두 번뿐이라 바운스로 안 센다.
+void Button::noteEdge(ButtonDiagnostics& d, unsigned long limit) {
+  if (d.burstEdges > 0 && now - d.lastEdgeTime <= limit) {
+    if (d.burstEdges < 0xFF) d.burstEdges++;
+    if (d.burstEdges >= 3) {
+      if (d.burstEdges == 3 && d.bounceBursts < 0xFFFF) d.bounceBursts++;
+      unsigned long len = (now - d.burstStart) * 16;
+      if (len > 0xFFFF) len = 0xFFFF;
+      if (len > d.bounceEstimate16) d.bounceEstimate16 = static_cast<uint16_t>(len);
+    }
+  } else {
+    // 앞 묶음과 떨어진 깨끗한 변화. 추정값을 조금씩 줄인다.
+    d.bounceEstimate16 = static_cast<uint16_t>(d.bounceEstimate16 - d.bounceEstimate16 / 16);
+    d.burstEdges = 1;
+    d.burstStart = now;
+  }
+  d.lastEdgeTime = now;
+}
+
+unsigned long Button::adaptiveWindow(const ButtonDiagnostics& d, unsigned long limit) {
+  unsigned long estimate = (d.bounceEstimate16 + 15) / 16;
+  unsigned long window = estimate + estimate / 2 + 1;
+  if (window < d.bounceMinWindow) window = d.bounceMinWindow;
+  if (window > limit) window = limit;
+  return window;
+}
+
+// 연속 누름이 시작된 뒤 phase까지 지난 시간에 따라 반복 간격을 정한다.
+// 가속이 없으면 항상 base (MANY_REPRESS_TIME 또는 설정의 manyRepressTime).
+unsigned long Button::manyRepressInterval(unsigned long phase, unsigned long base) {
+  unsigned long interval = base;
+  if (manyAccelTime > 0 && manyRepressMin < interval) {
+    unsigned long held = phase - manyStartTime;
+    if (held >= manyAccelTime) interval = manyRepressMin;
+    else interval -= (interval - manyRepressMin) * held / manyAccelTime;
+  }
+  return (interval > 0) ? interval : 1;
+}
+
 // pin
 // uint8_t Button::getPin() { return pin; }
 // void Button::setPin(uint8_t p) { pin = p; }
@@ -365,19 +693,19 @@ void Button::setLOWHIGH(uint8_t lh) { LOWHIGH = lh; }
 // uint8_t Button::getState() { return state; }
 // void Button::setState(uint8_t s) { state = s; }
 // // clickCount
-// uint8_t Button::getClickCount() { return clickCount; }
+uint8_t Button::getClickCount() { return clickCount; }
 // void Button::setClickCount(uint8_t count) { clickCount = count; }
 // // exClickCount
 // uint8_t Button::getActionClickCount() { return actionClickCount; }
 // void Button::setActionClickCount(uint8_t count) { actionClickCount = count; }
 // // action
-// int8_t Button::getAction() { return action; }
+int8_t Button::getAction() { return action; }
 // void Button::setAction(int8_t a) { action = a; }
 // // now
 // unsigned long Button::getNow() { return now; }
 // void Button::setNow(unsigned long n) { now = n; }
 // // downTime
-// unsigned long Button::getDownTime() { return downTime; }
+unsigned long Button::getDownTime() { return downTime; }
 // void Button::setDownTime(unsigned long t) { downTime = t; }
 // // upTime
 // unsigned long Button::getUpTime() { return upTime; }
@@ -397,8 +725,9 @@ void Button::setLOWHIGH(uint8_t lh) { LOWHIGH = lh; }
 // actionTime
 unsigned long Button::getActionTime(int8_t i) { return actionTime[i]; }
 // void Button::setActionTime(int8_t i, unsigned long t) { actionTime[i] = t; }
+int8_t Button::getLastAction() { return lastAction; }
 // // pressed
-// bool Button::isPressed() { return pressed; }
+bool Button::isPressed() { return pressed; }
 // void Button::setPressed(bool p) { pressed = p; }
 // // manyTriggered
 // bool Button::isManyTriggered() { return manyTriggered; }
@@ -408,12 +737,19 @@ unsigned long Button::getActionTime(int8_t i) { return actionTime[i]; }
 void Button::setLastActionTime(unsigned long t) { lastActionTime = t; }
 // debounceActive
 bool Button::isDebounceActive() { return debounceActive; }
+bool Button::isIdle() { return !pressed && state == noneState; }
 void Button::setDebounceActive(bool active) { debounceActive = active; }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 
 // twoButtonCombo 관련.
 
+// 모아둔 반복 횟수를 uint8_t에 담는다. 0이면 1로.
+static uint8_t clampRepeat(uint16_t count) {
+  if (count == 0) return 1;
+  return (count > MAX_REPEAT_COUNT) ? MAX_REPEAT_COUNT : static_cast<uint8_t>(count);
+}
+
 // TwoButtonCombo buttonCombo(button1, button2); // 두 버튼 조합키를 쓰는 경우.
 // TwoButtonCombo buttonCombo1(button[12], button[13], &mux, 12, 13); // CD74HC4067의 채널을 이용해서 두 버튼 조합키를 쓰는 경우.
 // TwoButtonCombo buttonCombo2(button[14], button[15], &mux, 14, 15);
@@ -475,6 +811,10 @@ void TwoButtonCombo::decaClick() { if (onDecaClick) onDecaClick(); }
 // 각각의 버튼 객체를 만들어서.
 // 입력 감지로 그냥 각 버튼들의 button.event() 함수를 쓰면 된다.
 int8_t* TwoButtonCombo::event() {
+  return event(millis());
+}
+
+int8_t* TwoButtonCombo::event(unsigned long at) {
   // twoButtonEventDetected[] 배열의 초기화.
   resetTwoButtonEventDetected();
   // event()함수를 거쳐서 받은 반환값이 NO_ACTION(0)이 아니면 어떤 동작이란 소린데.
@@ -484,13 +824,13 @@ int8_t* TwoButtonCombo::event() {
   if (cd4067!=nullptr) {
     cd4067->selectChannel(cd4067_channel1);
     delay(3); // 안정화를 위한 약간의 딜레이가 필요하다.
-    currentEvent1 = bt1.event(); // 버튼1의 이벤트 감지.
+    currentEvent1 = bt1.event(at); // 버튼1의 이벤트 감지.
     cd4067->selectChannel(cd4067_channel2);
     delay(3); // 안정화를 위한 약간의 딜레이가 필요하다.
-    currentEvent2 = bt2.event(); // 버튼2의 이벤트 감지.
+    currentEvent2 = bt2.event(at); // 버튼2의 이벤트 감지.
   } else {
-    currentEvent1 = bt1.event(); // 버튼1의 이벤트 감지.
-    currentEvent2 = bt2.event(); // 버튼2의 이벤트 감지.
+    currentEvent1 = bt1.event(at); // 버튼1의 이벤트 감지.
+    currentEvent2 = bt2.event(at); // 버튼2의 이벤트 감지.
   }
   // 여기 now라고 해서 시간 체킹을 해서 쓰는데.
   // event() 함수 내에서 실은 이벤트 발생 시간을 기록하고 있다.
@@ -503,7 +843,8 @@ int8_t* TwoButtonCombo::event() {
   // 만약에 그래도 코드가 돌고 작동을 하는 데에 지장이 없다면 뭐 상관 없지만.
   // 그래도 이렇게 두는 것이 계산을 하는 데에 있어서, 더 예측가능하고 안정적이다.
   // 이 now를 event() 앞에 두지 말 것.
-  unsigned long now = millis();
+  // 지금은 두 버튼과 조합이 같은 시각 at을 쓰므로 now가 액션 시간보다 작아질 일이 없다.
+  unsigned long now = at;
 
   // currentEvent1이 뭔가 들어온다면, 그걸 잠시 받아놓고.
   // TWO_BUTTON_TOLLERANCE_TIME 동안은 가만히 currentEvent2가 그거랑 동일한 게 들어오는지를 본다.
@@ -522,6 +863,9 @@ int8_t* TwoButtonCombo::event() {
   // 두 버튼의 연계를 위해서 NO_ACTION(0) 아닌 것이 들어왔을 때에 따로 저장을 해준다.
   if(currentEvent1) actionSaved1 = currentEvent1;
   if(currentEvent2) actionSaved2 = currentEvent2;
+  // MANYPRESS 반복 횟수는 판정을 기다리는 동안 계속 모은다. 다른 액션이 들어오면 새로 센다.
+  if(currentEvent1) repeatSaved1 = (currentEvent1 == MANYPRESS && pre_actionSaved1 == MANYPRESS) ? repeatSaved1 + bt1.getRepeatCount() : bt1.getRepeatCount();
+  if(currentEvent2) repeatSaved2 = (currentEvent2 == MANYPRESS && pre_actionSaved2 == MANYPRESS) ? repeatSaved2 + bt2.getRepeatCount() : bt2.getRepeatCount();
 
   ///// 한 버튼에 액션이 들어온 순간 일단 대기하기 위한 시간 컨트롤.
 
@@ -596,6 +940,7 @@ int8_t* TwoButtonCombo::event() {
   // 조합 액션 판정.
   if(combinationWork == YES_COMBINATION) {
     twoButtonEventDetected[2] = actionSaved1; // 버튼들의 조합 액션을 twoButtonEventDetected[2]에 저장.
+    twoButtonRepeatCount[2] = clampRepeat(repeatSaved1 > repeatSaved2 ? repeatSaved1 : repeatSaved2);
     if(actionSaved1==MANYPRESS) twoButtonManyPressTime = now; // 두 버튼 manyPress 작동 시 시간을 저장.
     // 액션 들어오는 것 체킹 초기화.
     actionSaved1 = NO_ACTION;
@@ -611,6 +956,7 @@ int8_t* TwoButtonCombo::event() {
     // 그렇지 않으면 수행한다.
     else{
       twoButtonEventDetected[0] = actionSaved1; // 버튼1의 액션을 twoButtonEventDetected[0]에 저장.
+      twoButtonRepeatCount[0] = clampRepeat(repeatSaved1);
     }
     // 억제하는 기작이 효율적으로 작동하도록 버튼1과 버튼2를 따로 한다.
     // 버튼2.
@@ -619,6 +965,7 @@ int8_t* TwoButtonCombo::event() {
       now-twoButtonManyPressTime < ACTION_SUPPRESS_TIME+TWO_BUTTON_TOLLERANCE_TIME){}
     else{
       twoButtonEventDetected[1] = actionSaved2; // 버튼2의 액션을 twoButtonEventDetected[1]에 저장.
+      twoButtonRepeatCount[1] = clampRepeat(repeatSaved2);
     }
 
     // 액션 들어오는 것 체킹 초기화.
@@ -672,6 +1019,31 @@ void TwoButtonCombo::doIt(int8_t a) {
   }
 }
 
+void TwoButtonCombo::doIt(int8_t a, uint8_t repeat) {
+  if (a != MANYPRESS) repeat = 1;
+  for (uint8_t i = 0; i < repeat; i++) doIt(a);
+}
+
+uint8_t TwoButtonCombo::getRepeatCount(int index) {
+  return (index >= 0 && index < 3) ? twoButtonRepeatCount[index] : 1;
+}
+
+bool TwoButtonCombo::isIdle() {
+  return bt1.isIdle() && bt2.isIdle() && actionSaved1 == NO_ACTION && actionSaved2 == NO_ACTION && !waitForOtherButton;
+}
+
+LatencyStamp TwoButtonCombo::getLatencyStamp(int index) {
+  if (index == 0) return bt1.getLatencyStamp();
+  if (index == 1) return bt2.getLatencyStamp();
+  // 조합은 두 버튼이 모두 판정돼야 나오므로 늦은 쪽 기준. micros()가 돌아 넘어가도 되도록 차이로 비교한다.
+  LatencyStamp a = bt1.getLatencyStamp();
+  LatencyStamp b = bt2.getLatencyStamp();
+  LatencyStamp s = a;
+  if (static_cast<int32_t>(b.edge - a.edge) > 0) { s.edge = b.edge; s.scanGap = b.scanGap; }
+  if (static_cast<int32_t>(b.detect - a.detect) > 0) s.detect = b.detect;
+  return s;
+}
+
 Button& TwoButtonCombo::getBt1() { return bt1; }
 void TwoButtonCombo::setBt1(Button& b) { bt1 = b; }
 Button& TwoButtonCombo::getBt2() { return bt2; }
@@ -692,4 +1064,5 @@ void TwoButtonCombo::setTwoButtonEventDetected(int index, int8_t value) {
 }
 void TwoButtonCombo::resetTwoButtonEventDetected() {
   for (int8_t &val : twoButtonEventDetected) val = NO_ACTION;
+  for (uint8_t &val : twoButtonRepeatCount) val = 1;
 }
\ No newline at end of file
@@ -25,6 +25,11 @@
 // manyPress 반복 시간. 연속 누름 동작 판정되면 이후 되풀이에 걸리는 시간. 하지만 체크하는 루프가 이거보다 늦게 돌 경우 당연히 그 속도로 수행되게 될 거다.
 // 버튼 누르고 있으면 다다다다다!! 수행되는데 이걸 크게 하면 반복이 느려지고, 작게 하면 빨라진다.
 #define MANY_REPRESS_TIME 20
+// 한 번의 event() 호출 사이에 반복 간격이 여러 번 지나갔으면 MANYPRESS 하나에 그 횟수를 담아서 준다. getRepeatCount()로 읽는다.
+// 루프가 MANY_REPRESS_TIME보다 느리게 돌아도 반복 횟수가 줄지 않고, 빠르게 돌아도 한 번의 호출에 MANYPRESS는 최대 하나다.
+// 첫 MANYPRESS도 연속 누름이 시작됐어야 할 시각부터 센다. 루프가 늦게 와서 첫 판정이 늦어도 그 사이의 반복이 담긴다.
+// 한 번에 담을 수 있는 최대 반복 횟수. 이걸 넘게 밀리면 밀린 건 버리고 지금부터 다시 센다.
+#define MAX_REPEAT_COUNT 255
 // 버튼을 눌렀다가 이 시간 안에 떼면 무효처리.
 // 동일 버튼이 연속으로 잘못 눌린 경우 이 정도 시간 안에 버튼이 떼어지기 때문에.
 // 버튼이 눌렸다가 이 시간 안에 떼어지면 잘못 눌린 걸로 간주한다.
@@ -46,6 +51,20 @@ enum ACTION {
   NUMBER_OF_ACTIONS // 총 개수는 NO_ACTION(0)을 포함해서 13
 };
 
+// 이벤트 큐 우선순위 단계. 숫자가 작을수록 먼저 처리된다. PriorityQueue의 단계 번호로 쓴다.
+enum ACTION_PRIORITY {
+  PRIORITY_DISCRETE, // 0. 한 버튼 CLICK ~ DECACLICK, LONGPRESS. 놓치면 안되는 한 번짜리 액션.
+  PRIORITY_COMBO,    // 1. 두 버튼 조합 액션.
+  PRIORITY_REPEAT,   // 2. MANYPRESS. 밀리거나 몇 개 버려져도 되는 반복 액션.
+  NUMBER_OF_PRIORITIES
+};
+
+// 액션 번호와 조합 여부로 우선순위 단계를 정한다. 조합 MANYPRESS도 반복 단계.
+inline uint8_t actionPriority(int8_t action, bool combo = false) {
+  if (action == MANYPRESS) return PRIORITY_REPEAT;
+  return combo ? PRIORITY_COMBO : PRIORITY_DISCRETE;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 
 #define ANALOG_INPUT 99
@@ -55,6 +74,7 @@ class CD74HC4067 {
 public:
     CD74HC4067(uint8_t sig, uint8_t p0, uint8_t p1, uint8_t p2, uint8_t p3, uint8_t mode = INPUT_PULLUP);
     void changeMode(uint8_t mode);
+    uint8_t getMode();
     void selectChannel(uint8_t channel);
     int dRead();
     int dRead(uint8_t channel);
@@ -76,9 +96,107 @@ protected:
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 
+// RcuPointer는 RcuPointer.h에 있다. <atomic>이 필요해서 AVR에서도 되는 이 헤더와 나눠놓았다.
+// Button::setProfile()이 받을 수 있도록 이름만 알려둔다. MaxReaders 기본값은 여기서 정한다.
+template <typename T, size_t MaxReaders = 4>
+class RcuPointer;
+
+// ButtonProfile
+// - 버튼 하나의 타이밍 설정과 액션별 핸들러를 묶은 것. RcuPointer<ButtonProfile>로 통째로 바꾼다.
+// - 기본값은 위의 #define 값들과 같다. handlers[ACTION]이 nullptr면 버튼의 onClick 같은 멤버 함수 포인터를 그대로 쓴다.
+// - 버튼마다 다른 키맵이면 ButtonProfile 배열을 하나의 설정으로 publish하고, 버튼마다 setProfile(&rcu, 배열 인덱스)를 준다.
+//
+// #include "RcuPointer.h"
+// ButtonProfile keymapA[16], keymapB[16];
+// RcuPointer<ButtonProfile> keymap(keymapA);
+// int8_t scanReader, actionReader;
+//
+// void setup() {
+//   for (int i = 0; i < 16; i++) buttons[i].setProfile(&keymap, i);
+//   scanReader = keymap.registerReader();   // 스캔 코어
+//   actionReader = keymap.registerReader(); // 수행 코어
+// }
+// // 스캔 코어 loop() 맨 위: keymap.quiescent(scanReader);
+// // 수행 코어 loop1() 맨 위: keymap.quiescent(actionReader);
+//
+// // 모드 바꾸기. 어느 코어에서든.
+// keymapB[3].handlers[CLICK] = volumeUp;
+// keymapB[3].longPressTime = 800;
+// keymap.publish(keymapB);
+// ButtonProfile* old = keymap.synchronize(100); // old == keymapA. 이제 keymapA를 고쳐서 다음에 쓸 수 있다.
+struct ButtonProfile {
+  unsigned long longPressTime = LONG_PRESS_TIME;
+  unsigned long manyTriggerTime = MANY_TRIGGER_TIME;
+  unsigned long manyRepressTime = MANY_REPRESS_TIME;
+  unsigned long shortRepressTime = SHORT_REPRESS_TIME;
+  unsigned long discardShortPressDuration = DISCARD_SHORT_PRESS_DURATION;
+  unsigned long debounceTime = debounceInterval;
+  void (*handlers[NUMBER_OF_ACTIONS])() = {nullptr}; // 인덱스는 enum ACTION.
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// 지연 측정용 타임스탬프. 모두 micros() 값. Button::setLatencyTracking(true)일 때만 기록된다.
+// 이걸 RamjiLatency.h의 LatencyStats::detected()에 넘긴다.
+struct LatencyStamp {
+  uint32_t edge;    // 마지막 핀 변화(누름/뗌)를 알아챈 event() 호출 시점. 두 번째 MANYPRESS부터는 판정 시점과 같다.
+  uint32_t scanGap; // 그 호출과 바로 앞 호출 사이. 실제 핀 변화는 이 사이 어딘가에서 일어났다.
+  uint32_t detect;  // 버튼 FSM이 액션을 돌려준 시점.
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// 트레이스 레코드의 flags 비트.
+#define TRACE_STATE_MASK 0x03 // noneState, intoShortStateLogic, intoLongStateLogic
+#define TRACE_PRESSED 0x04
+#define TRACE_DEBOUNCE 0x08
+#define TRACE_DISCARDED 0x10 // DISCARD_SHORT_PRESS_DURATION보다 짧은 누름이 무효 처리됐다.
+#define TRACE_MANY_TRIGGERED 0x20
+
+// 시간 차이는 ms, 65535에서 멈춘다.
+struct TraceRecord {
+  uint32_t now;
+  uint16_t pressDuration;  // upTime - downTime
+  uint16_t sinceDown;      // now - downTime
+  uint16_t sinceShortCall; // now - shortCallTime
+  uint16_t sinceLongLogic; // now - longLogicTime
+  uint16_t sinceManyPress; // now - actionTime[MANYPRESS]
+  uint8_t id;              // setTrace()에 준 번호. 기본은 핀 번호.
+  uint8_t flags;           // TRACE_*
+  uint8_t clickCount;      // 액션과 함께 기록된 연속 클릭 수.
+  int8_t action;           // 이번 호출의 판정. 없으면 NO_ACTION.
+  uint8_t reserved[2];
+};
+
+// 트레이스 레코드를 받는 쪽. ButtonTrace.h의 ButtonTrace(링 버퍼)가 이걸 구현한다. 직접 만들어 붙여도 된다.
+// event() 안에서 불리므로 복사만 하고 바로 돌아와야 한다. 받지 못했으면 false.
+class TraceSink {
+public:
+  virtual bool record(const TraceRecord& r) = 0;
+
+protected:
+  ~TraceSink() {}
+};
+
+// formatTraceRecord()가 만드는 가장 긴 줄(212자) + 끝의 '\0'. 줄 버퍼는 이 크기로 잡는다.
+#define TRACE_LINE_SIZE 213
+
+// 레코드 하나를 예전 debugPrint()와 같은 모양의 한 줄로. 쓴 길이를 돌려준다.
+// size가 모자라서 잘릴 것 같으면 잘린 줄 대신 빈 문자열을 남기고 -1.
+int formatTraceRecord(const TraceRecord& r, char* buf, size_t size);
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// 핀이 없는 버튼. 키 매트릭스나 시프트 레지스터처럼 다른 곳에서 읽은 비트로 도는 버튼은 이걸로 만들고 setInput()을 준다.
+// 이 값이면 생성자가 pinMode()를 부르지 않는다.
+#define BUTTON_NO_PIN 0xFF
+
+// 지연 측정, 트레이스, 적응형 디바운스가 쓰는 상태. RamjiButton.cpp에만 있다.
+struct ButtonDiagnostics;
+
 class Button {
 public:
-    Button(uint8_t pin
+    Button(uint8_t pin = BUTTON_NO_PIN
            , uint8_t pinModeValue = INPUT_PULLUP
            , void (*onLongPress)() = nullptr
            , void (*onManyPress)() = nullptr
@@ -94,7 +212,12 @@ public:
            , void (*onDecaClick)() = nullptr
     );
 
+    // 지금 FSM 상태를 한 줄 찍는다. setTrace()로 트레이스가 붙어 있으면 찍지 않고 레코드로 남긴다.
     void debugPrint();
+    // event()가 상태가 바뀔 때마다 trace에 레코드를 남긴다. id는 레코드에 들어갈 번호. 0xFF면 핀 번호. nullptr이면 해제.
+    // 보통은 ButtonTrace.h의 StaticButtonTrace<N>을 붙인다.
+    void setTrace(TraceSink* trace, uint8_t id = 0xFF);
+    TraceSink* getTrace();
 
     void longPress();
     void manyPress();
@@ -123,7 +246,50 @@ public:
 
     void update();
     int8_t event();
+    // at 시각(ms)으로 판정한다. 샘플러처럼 입력을 읽은 시각과 판정하는 시각이 다를 때. event()는 event(millis()).
+    int8_t event(unsigned long at);
     void doIt(int8_t a);
+    // MANYPRESS면 repeat번 만큼 수행. 나머지 액션은 한 번. button.doIt(event, button.getRepeatCount());
+    void doIt(int8_t a, uint8_t repeat);
+    // 마지막으로 판정된 액션의 반복 횟수. MANYPRESS는 지난 보고 이후 지나간 반복 간격 수, 나머지 액션은 1.
+    uint8_t getRepeatCount();
+    // 연속 누름 가속. 누르고 있을수록 반복 간격이 MANY_REPRESS_TIME에서 minRepressTime까지 rampTime 동안 일정하게 줄어든다.
+    // rampTime == 0 이면 가속 없음(기본).
+    void setManyPressAcceleration(unsigned long minRepressTime, unsigned long rampTime);
+    // 타이밍과 핸들러를 rcu가 가리키는 설정의 index번째 ButtonProfile에서 가져온다. nullptr이면 원래대로 #define 값과 멤버 함수 포인터.
+    // event()와 doIt()이 부를 때마다 새로 읽으므로, publish()하면 스캔을 멈추지 않고 바로 바뀐다.
+    // RcuPointer.h를 include해야 rcu를 만들 수 있다. 이 헤더는 RcuPointer를 이름으로만 알고, 읽는 함수 하나만 들고 있는다.
+    template <size_t MaxReaders>
+    void setProfile(RcuPointer<ButtonProfile, MaxReaders>* rcu, uint8_t index = 0) {
+      profileSource = rcu;
+      profileRead = rcu ? &readProfile<MaxReaders> : nullptr;
+      profileIndex = index;
+    }
+    void setProfile(decltype(nullptr), uint8_t index = 0);
+    const ButtonProfile* getProfile();
+    // 핀 대신 bitmap의 bit번째 비트(1 = 눌림)를 읽는다. KeyBitmap을 쓰는 입력 소스들이 attach()로 불러준다. nullptr이면 다시 핀.
+    void setInput(const uint8_t* bitmap, uint16_t bit = 0);
+    // 지연 측정. 켜면 event() 한 번에 micros()를 한 번 더 부르고, 핀 변화와 판정 시점을 LatencyStamp에 남긴다. 기본 꺼짐.
+    // 지연 측정, setTrace(), 적응형 디바운스 중 하나를 처음 켤 때 그 상태를 담을 작은 구조체를 힙에 하나 붙인다. 안 켜면 안 붙는다.
+    void setLatencyTracking(bool enabled);
+    bool isLatencyTracking();
+    LatencyStamp getLatencyStamp();
+    // 적응형 디바운스. 켜면 이 버튼의 실제 바운스 길이를 배워서 짧은 누름 무시 시간과 액션 뒤 디바운싱 시간을 줄인다.
+    // - 핀 변화가 DISCARD_SHORT_PRESS_DURATION 안에 세 번 이상 이어지면 바운스 묶음으로 보고 그 길이를 잰다. 추정값은 가장 긴 묶음.
+    //   깨끗한 변화(앞 변화와 멀리 떨어진)가 올 때마다 추정값을 1/16씩 줄인다. 낡아서 바운스가 길어지면 바로 다시 늘어난다.
+    // - 무시 시간 = 추정값 x 1.5 + 1ms. minWindow보다 작아지지 않고, 설정값(#define 또는 ButtonProfile)보다 커지지 않는다.
+    //   액션 뒤 디바운싱 시간도 같은 비율로 줄인다. 설정값이 안전한 상한이다.
+    // - 처음에는 설정값 그대로에서 시작한다. 스캔 주기보다 짧은 바운스는 안 보이므로 minWindow는 스캔 주기보다 크게.
+    void setAdaptiveDebounce(bool enabled, unsigned long minWindow = 10);
+    bool isAdaptiveDebounce();
+    void resetAdaptiveDebounce();
+    // 배운 바운스 길이(ms). 지금 쓰는 짧은 누름 무시 시간과 액션 뒤 디바운싱 시간(ms). 꺼져 있으면 설정값 그대로.
+    unsigned long getBounceEstimate();
+    unsigned long getDiscardWindow();
+    unsigned long getDebounceWindow();
+    // 바운스 묶음으로 본 횟수, 짧은 누름으로 무시한 횟수.
+    uint16_t getBounceBursts();
+    uint16_t getRejectedPresses();
     // // pin
     // uint8_t getPin();
     // void setPin(uint8_t p);
@@ -136,20 +302,20 @@ public:
     // // state
     // uint8_t getState();
     // void setState(uint8_t s);
-    // // clickCount
-    // uint8_t getClickCount();
+    // clickCount
+    uint8_t getClickCount();
     // void setClickCount(uint8_t count);
     // // exClickCount
     // uint8_t getActionClickCount();
     // void setActionClickCount(uint8_t count);
-    // // action
-    // int8_t getAction();
+    // action
+    int8_t getAction();
     // void setAction(int8_t a);
     // // now
     // unsigned long getNow();
     // void setNow(unsigned long n);
-    // // downTime
-    // unsigned long getDownTime();
+    // downTime
+    unsigned long getDownTime();
     // void setDownTime(unsigned long t);
     // // upTime
     // unsigned long getUpTime();
@@ -169,8 +335,10 @@ public:
     // actionTime
     unsigned long getActionTime(int8_t i);
     // void setActionTime(int8_t i, unsigned long t);
-    // // pressed
-    // bool isPressed();
+    // lastAction. 마지막으로 판정된 액션 번호. event()가 NO_ACTION을 돌려줘도 남아 있다.
+    int8_t getLastAction();
+    // pressed
+    bool isPressed();
     // void setPressed(bool p);
     // // manyTriggered
     // bool isManyTriggered();
@@ -180,6 +348,8 @@ public:
     void setLastActionTime(unsigned long t);
     // debounceActive
     bool isDebounceActive();
+    // 안 눌려 있고 판정을 기다리는 것도 없음(연속 클릭 대기, 롱프레스/연속 누름 중이 아님). 이럴 때는 천천히 훑어도 놓치는 판정이 없다.
+    bool isIdle();
     void setDebounceActive(bool active);
 
 private:
@@ -200,6 +370,41 @@ private:
     unsigned long actionTime[NUMBER_OF_ACTIONS] = {0}; // 이벤트 판정이 완료된 최근 시간. enum ACTION과 개수와 인덱스가 같다.
     bool pressed = Released;
     bool manyTriggered = false; // 두 번째 manyPress 이벤트를 빠르게 구동하기 위한 bool값.
+    unsigned long manyStartTime = 0; // 연속 누름이 시작된 시간. 가속 곡선의 기준.
+    unsigned long manyPhaseTime = 0; // 마지막으로 보고한 반복 간격의 경계. 실제 호출 시간이 아니라 간격 단위로 나아간다.
+    uint8_t repeatCount = 1; // 마지막으로 판정된 액션의 반복 횟수.
+    int8_t lastAction = NO_ACTION; // 마지막으로 판정된 액션 번호. action과 달리 다음 event()에서 지워지지 않는다.
+    unsigned long manyRepressMin = MANY_REPRESS_TIME; // 가속 시 최소 반복 간격.
+    unsigned long manyAccelTime = 0; // 가속에 걸리는 시간. 0이면 가속 없음.
+    unsigned long manyRepressInterval(unsigned long phase, unsigned long base); // phase 시점의 반복 간격. base는 가속 전 간격.
+    const void* profileSource = nullptr; // 설정을 가져올 곳(RcuPointer). nullptr이면 #define 값.
+    const ButtonProfile* (*profileRead)(const void* source) = nullptr; // profileSource의 read().
+    template <size_t MaxReaders>
+    static const ButtonProfile* readProfile(const void* source) {
+      return static_cast<const RcuPointer<ButtonProfile, MaxReaders>*>(source)->read();
+    }
+    uint8_t profileIndex = 0; // 설정 배열 안에서 이 버튼의 자리.
+    uint16_t inputBit = 0; // 작은 멤버끼리 붙여서 패딩을 줄인다.
+    uint16_t rejectedPresses = 0; // 짧은 누름으로 무시한 횟수.
+    const uint8_t* inputBitmap = nullptr; // nullptr이 아니면 핀 대신 여기서 읽는다.
+    bool readPressed(); // 지금 눌려 있는지. 핀이나 비트맵에서.
+    // 지연 측정, 트레이스, 적응형 디바운스 상태. 셋 중 하나를 처음 켤 때 할당해서 붙인다. 안 쓰는 버튼은 포인터 하나만 든다.
+    // 버튼을 복사하면 상태도 따로 복사된다.
+    class Diagnostics {
+    public:
+      Diagnostics() {}
+      Diagnostics(const Diagnostics& other);
+      Diagnostics& operator=(const Diagnostics& other);
+      ~Diagnostics();
+      ButtonDiagnostics* get() const { return p; }
+      ButtonDiagnostics* attach(); // 없으면 만든다. 못 만들면 nullptr.
+    private:
+      ButtonDiagnostics* p = nullptr;
+    };
+    Diagnostics diag;
+    TraceRecord makeTraceRecord(uint8_t extraFlags); // 지금 상태로 레코드를 채운다.
+    void noteEdge(ButtonDiagnostics& d, unsigned long limit); // 핀 변화가 있을 때 바운스 묶음을 센다. limit은 설정된 무시 시간.
+    unsigned long adaptiveWindow(const ButtonDiagnostics& d, unsigned long limit); // 배운 값으로 정한 무시 시간.
     unsigned long lastActionTime = 0; // 디바운싱을 위한 변수들.
     bool debounceActive = false;
 };
@@ -229,7 +434,16 @@ public:
 
     // 이벤트를 감지하고 내부 배열을 갱신하는 함수. 그 배열을 반환한다.
     int8_t* event();
+    // at 시각(ms)으로 두 버튼과 조합을 판정한다. event()는 event(millis()).
+    int8_t* event(unsigned long at);
     void doIt(int8_t a);
+    void doIt(int8_t a, uint8_t repeat);
+    // event()가 준 배열과 같은 인덱스의 반복 횟수. 0: 버튼1, 1: 버튼2, 2: 조합. MANYPRESS가 아니면 1.
+    uint8_t getRepeatCount(int index);
+    // index 0, 1: 버튼1, 2의 타임스탬프. 2: 조합. 두 버튼 중 늦은 핀 변화와 늦은 판정.
+    LatencyStamp getLatencyStamp(int index);
+    // 두 버튼이 다 isIdle()이고, 조합 판정을 위해 잡아둔 액션도 없음.
+    bool isIdle();
 
     void longPress();
     void manyPress();
@@ -292,6 +506,67 @@ private:
     uint8_t combinationWork = NOT_DECIDED;
 
     int8_t twoButtonEventDetected[3] = { NO_ACTION, NO_ACTION, NO_ACTION };
+    // actionSaved가 대기하는 동안 들어온 MANYPRESS 반복 횟수를 모아둔다.
+    uint16_t repeatSaved1 = 0;
+    uint16_t repeatSaved2 = 0;
+    uint8_t twoButtonRepeatCount[3] = { 1, 1, 1 };
 };
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// KeyBitmap<Keys>
+// - 키 매트릭스, 시프트 레지스터, I2C 확장 칩, 저항 사다리처럼 여러 키를 한 번에 읽는 입력 소스들의 공통 부분.
+//   소스가 scan()에서 키 상태를 비트맵(비트 1 = 눌림)에 써두면, attach()로 붙인 Button들은 핀 대신 그 비트를 읽는다.
+//   그래서 클릭/롱/연속 누름 판정과 TwoButtonCombo는 그대로 쓴다. 키마다 핀을 읽지 않는다.
+// - scan()과 버튼들의 event()는 같은 태스크에서 부른다. 보통 scan() 한 번 다음에 버튼들 event().
+//
+// Button keys[64]; // 핀 없는 버튼들.
+// matrix.attach(keys, 64);
+// loop: matrix.scan(); for (int i = 0; i < 64; i++) if (int8_t a = keys[i].event()) ...
+template <size_t Keys>
+class KeyBitmap {
+  static_assert(Keys > 0 && Keys <= 4096, "KeyBitmap supports 1 to 4096 keys.");
+
+public:
+  KeyBitmap() { memset(_bits, 0, sizeof(_bits)); }
+
+  // buttons[i]가 키 firstKey + i를 읽게 한다. 키 범위를 넘는 버튼은 건너뛴다.
+  void attach(Button* buttons, size_t count, uint16_t firstKey = 0) {
+    for (size_t i = 0; i < count && firstKey + i < Keys; ++i) buttons[i].setInput(_bits, static_cast<uint16_t>(firstKey + i));
+  }
+  void attach(Button& button, uint16_t key) {
+    if (key < Keys) button.setInput(_bits, key);
+  }
+
+  bool isPressed(uint16_t key) const { return key < Keys && ((_bits[key >> 3] >> (key & 7)) & 1u); }
+  const uint8_t* bitmap() const { return _bits; }
+  size_t keys() const { return Keys; }
+  // 눌린 키 수.
+  uint16_t pressedCount() const {
+    uint16_t n = 0;
+    for (size_t i = 0; i < sizeof(_bits); ++i) {
+      for (uint8_t b = _bits[i]; b; b &= b - 1) ++n;
+    }
+    return n;
+  }
+
+protected:
+  uint8_t _bits[(Keys + 7) / 8];
+
+  // 바뀌었으면 true.
+  bool setKey(uint16_t key, bool pressed) {
+    uint8_t& byte = _bits[key >> 3];
+    uint8_t mask = static_cast<uint8_t>(1u << (key & 7));
+    bool was = (byte & mask) != 0;
+    if (was == pressed) return false;
+    byte ^= mask;
+    return true;
+  }
+};
+
+// UniversalQueue.h를 먼저 포함했을 때. ActionNotifier는 MANYPRESS를 숫자로 들고 있다.
+#if defined(UNIVERSALQUEUE_H) && defined(USE_FREERTOS)
+static_assert(ActionNotifier::REPEAT_ACTION == MANYPRESS, "ActionNotifier::REPEAT_ACTION must match MANYPRESS.");
+#endif
+
 #endif //RAMJIBUTTON_H
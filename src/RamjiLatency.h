@@ -0,0 +1,286 @@
+#ifndef RAMJILATENCY_H
+#define RAMJILATENCY_H
+
+// RamjiLatency
+// - 버튼을 누르거나 뗀 순간부터 doIt()이 불릴 때까지를 단계별로 재서 액션마다 히스토그램으로 모은다.
+//   어느 대기(SHORT_REPRESS_TIME, 조합 대기, 스캔 주기, 큐, 소비자 깨어남)가 지연을 잡아먹는지 보려고.
+// - 단계 (enum LATENCY_STAGE)
+//   SCAN     : 핀 변화를 본 event() 호출과 그 앞 호출 사이. 실제 변화는 이 안의 어딘가라서 숨어 있는 지연의 상한.
+//   DETECT   : 핀 변화를 본 시점 ~ 버튼 FSM 판정. 클릭이면 SHORT_REPRESS_TIME 대기가 여기 들어간다.
+//   COMBO    : 버튼 FSM 판정 ~ detected() 호출. TwoButtonCombo를 거치면 TWO_BUTTON_TOLLERANCE_TIME 대기가 여기.
+//   DISPATCH : detected() ~ dispatched(). 큐나 알림에 넣기까지. dispatched()를 안 부르면 기록 안 함.
+//   QUEUE    : dispatched()(없으면 detected()) ~ handlerStart(). 큐에 머문 시간 + 소비자 태스크가 깨어나는 시간.
+//   HANDLER  : handlerStart() ~ handlerEnd(). 핸들러 자체의 실행 시간.
+//   TOTAL    : 핀 변화를 본 시점 ~ handlerStart().
+// - 히스토그램은 2의 거듭제곱 마이크로초 구간. 구간 i는 [2^(i-1), 2^i)us, 0번은 0us. 마지막 구간은 그 이상 전부.
+//   기록은 배열 칸 하나 올리는 정도라 스캔 루프에 켜놓아도 된다.
+// - 슬롯은 ActionNotifier처럼 "누가 보낸 액션인지" 번호. 버튼 하나나 조합 하나에 슬롯 하나.
+//   슬롯마다 마지막 액션의 타임스탬프 하나만 들고 있다. 소비자가 꺼내기 전에 같은 슬롯에서 또 판정되면 앞의 것은 잴 수 없다(getOverwritten()).
+// - 감지 쪽(detected/dispatched)은 한 태스크, 수행 쪽(handlerStart/handlerEnd)은 한 태스크에서 부른다고 가정한다. 락은 없다.
+//   읽기(read)는 아무 데서나. ButtonStateBank처럼 시퀀스 번호로 일관된 사본을 준다.
+// - 메모리: 액션 13개 x 단계 7개 x 히스토그램 약 120바이트 = 11KB 정도. ESP32, RP2040용. 작은 AVR에서는 쓰지 않는다.
+//
+// #include "RamjiLatency.h"
+// LatencyStats<3> latency; // 슬롯 0: 버튼1, 1: 버튼2, 2: 조합
+// button1.setLatencyTracking(true);
+// button2.setLatencyTracking(true);
+//
+// // 감지 태스크.
+// int8_t* events = buttonCombo.event();
+// for (int i = 0; i < 3; i++) {
+//   if (events[i] == NO_ACTION) continue;
+//   latency.detected(i, events[i], buttonCombo.getLatencyStamp(i));
+//   queue.push(...);
+//   latency.dispatched(i);
+// }
+//
+// // 수행 태스크.
+// latency.handlerStart(slot);
+// button1.doIt(action);
+// latency.handlerEnd(slot);
+//
+// // 가끔.
+// latency.print(); // 한 줄에 하나씩 JSON.
+
+#include <Arduino.h>
+#include <atomic>
+#include <cstring>
+#include "RamjiButton.h"
+
+#define LATENCY_BUCKETS 24 // 2^23us = 8.4초 이상은 마지막 구간.
+
+enum LATENCY_STAGE {
+  LATENCY_SCAN,
+  LATENCY_DETECT,
+  LATENCY_COMBO,
+  LATENCY_DISPATCH,
+  LATENCY_QUEUE,
+  LATENCY_HANDLER,
+  LATENCY_TOTAL,
+  NUMBER_OF_LATENCY_STAGES
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// 히스토그램 하나의 사본. LatencyHistogram::read()로 받는다.
+struct LatencySummary {
+  uint32_t count;
+  uint32_t max;   // us
+  uint64_t sum;   // us
+  uint32_t buckets[LATENCY_BUCKETS];
+
+  uint32_t mean() const { return count ? static_cast<uint32_t>(sum / count) : 0; }
+
+  // 구간 i의 윗 경계(us). 이 값 미만이 구간 i에 들어간다. 마지막 구간은 max를 준다.
+  uint32_t bucketLimit(uint8_t i) const {
+    if (i + 1 >= LATENCY_BUCKETS) return max;
+    return 1UL << i;
+  }
+
+  // p% 지점이 들어 있는 구간의 윗 경계. 구간 안에서는 구분이 안되므로 최대 두 배까지 크게 나온다. max보다 크지는 않다.
+  uint32_t percentile(uint8_t p) const {
+    if (count == 0) return 0;
+    if (p > 100) p = 100;
+    uint64_t target = (static_cast<uint64_t>(count) * p + 99) / 100;
+    if (target == 0) target = 1;
+    uint64_t seen = 0;
+    for (uint8_t i = 0; i < LATENCY_BUCKETS; ++i) {
+      seen += buckets[i];
+      if (seen >= target) {
+        uint32_t limit = bucketLimit(i);
+        return (limit < max) ? limit : max;
+      }
+    }
+    return max;
+  }
+};
+
+// LatencyHistogram
+// - 쓰는 쪽 하나, 읽는 쪽 여럿. 쓰는 쪽은 add()만, 읽는 쪽은 read()로 사본을 받는다.
+class LatencyHistogram {
+public:
+  LatencyHistogram() { reset(); }
+
+  void add(uint32_t us) {
+    uint32_t s = _seq.load(std::memory_order_relaxed);
+    _seq.store(s + 1, std::memory_order_relaxed); // 홀수: 쓰는 중.
+    std::atomic_thread_fence(std::memory_order_release);
+    _s.count++;
+    _s.sum += us;
+    if (us > _s.max) _s.max = us;
+    _s.buckets[bucketOf(us)]++;
+    _seq.store(s + 2, std::memory_order_release);
+  }
+
+  // 일관된 사본을 out에 복사한다. 쓰는 중이라 maxRetries번 다시 해도 안되면 false.
+  bool read(LatencySummary& out, uint8_t maxRetries = 8) const {
+    for (uint8_t i = 0; i <= maxRetries; ++i) {
+      uint32_t s1 = _seq.load(std::memory_order_acquire);
+      if (s1 & 1u) continue;
+      std::memcpy(&out, &_s, sizeof(out));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (_seq.load(std::memory_order_relaxed) == s1) return true;
+    }
+    return false;
+  }
+
+  uint32_t count() const { return _s.count; }
+
+  // 쓰는 쪽에서, 또는 쓰는 쪽이 멈춰 있을 때.
+  void reset() {
+    uint32_t s = _seq.load(std::memory_order_relaxed);
+    _seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memset(&_s, 0, sizeof(_s));
+    _seq.store(s + 2, std::memory_order_release);
+  }
+
+  static uint8_t bucketOf(uint32_t us) {
+    uint8_t i = 0;
+    while (us && i < LATENCY_BUCKETS - 1) {
+      us >>= 1;
+      ++i;
+    }
+    return i;
+  }
+
+private:
+  LatencySummary _s;
+  std::atomic<uint32_t> _seq{0};
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// LatencyStats<Slots>
+// - 액션(enum ACTION) x 단계(enum LATENCY_STAGE)마다 LatencyHistogram 하나.
+// - 슬롯은 0 ~ Slots-1. 범위 밖 슬롯이나 NO_ACTION은 무시한다.
+template <size_t Slots = 4>
+class LatencyStats {
+  static_assert(Slots > 0 && Slots <= 255, "LatencyStats supports 1 to 255 slots.");
+
+public:
+  LatencyStats() {}
+
+  // 감지 쪽. 버튼(또는 조합)이 액션을 돌려준 직후에. stamp는 button.getLatencyStamp() 또는 combo.getLatencyStamp(i).
+  void detected(uint8_t slot, int8_t action, const LatencyStamp& stamp) {
+    if (slot >= Slots || action <= NO_ACTION || action >= NUMBER_OF_ACTIONS) return;
+    uint32_t now = micros();
+    _hist[action][LATENCY_SCAN].add(stamp.scanGap);
+    _hist[action][LATENCY_DETECT].add(stamp.detect - stamp.edge);
+    _hist[action][LATENCY_COMBO].add(now - stamp.detect);
+    Pending& p = _pending[slot];
+    if (p.ready.load(std::memory_order_acquire)) ++_overwritten;
+    p.ready.store(false, std::memory_order_relaxed);
+    p.edge.store(stamp.edge, std::memory_order_relaxed);
+    p.dispatch.store(now, std::memory_order_relaxed);
+    p.action.store(action, std::memory_order_relaxed);
+    p.ready.store(true, std::memory_order_release);
+  }
+
+  // 감지 쪽. 큐에 넣거나 알림을 보낸 직후에. 안 불러도 된다. 그러면 QUEUE가 detected()부터 잰다.
+  void dispatched(uint8_t slot) {
+    if (slot >= Slots) return;
+    Pending& p = _pending[slot];
+    if (!p.ready.load(std::memory_order_acquire)) return;
+    int8_t action = p.action.load(std::memory_order_relaxed);
+    uint32_t now = micros();
+    _hist[action][LATENCY_DISPATCH].add(now - p.dispatch.load(std::memory_order_relaxed));
+    p.dispatch.store(now, std::memory_order_release);
+  }
+
+  // 수행 쪽. doIt() 바로 앞에서.
+  void handlerStart(uint8_t slot) {
+    if (slot >= Slots) return;
+    Pending& p = _pending[slot];
+    _running[slot] = NO_ACTION;
+    if (!p.ready.load(std::memory_order_acquire)) return;
+    uint32_t now = micros();
+    int8_t action = p.action.load(std::memory_order_relaxed);
+    _hist[action][LATENCY_QUEUE].add(now - p.dispatch.load(std::memory_order_acquire));
+    _hist[action][LATENCY_TOTAL].add(now - p.edge.load(std::memory_order_relaxed));
+    p.ready.store(false, std::memory_order_release);
+    _running[slot] = action;
+    _startedAt[slot] = now;
+  }
+
+  // 수행 쪽. doIt()이 끝난 뒤에.
+  void handlerEnd(uint8_t slot) {
+    if (slot >= Slots || _running[slot] == NO_ACTION) return;
+    _hist[_running[slot]][LATENCY_HANDLER].add(micros() - _startedAt[slot]);
+    _running[slot] = NO_ACTION;
+  }
+
+  const LatencyHistogram& getHistogram(int8_t action, uint8_t stage) const {
+    if (action < 0 || action >= NUMBER_OF_ACTIONS) action = NO_ACTION;
+    if (stage >= NUMBER_OF_LATENCY_STAGES) stage = LATENCY_TOTAL;
+    return _hist[action][stage];
+  }
+
+  bool read(int8_t action, uint8_t stage, LatencySummary& out) const {
+    return getHistogram(action, stage).read(out);
+  }
+
+  // 소비자가 꺼내기 전에 같은 슬롯에서 다시 판정돼서 잴 수 없게 된 액션 수.
+  uint32_t getOverwritten() const { return _overwritten; }
+
+  // 측정을 멈춘 상태에서.
+  void reset() {
+    for (size_t a = 0; a < NUMBER_OF_ACTIONS; ++a) {
+      for (size_t s = 0; s < NUMBER_OF_LATENCY_STAGES; ++s) _hist[a][s].reset();
+    }
+    for (size_t i = 0; i < Slots; ++i) {
+      _pending[i].ready.store(false, std::memory_order_relaxed);
+      _running[i] = NO_ACTION;
+    }
+    _overwritten = 0;
+  }
+
+  // 기록이 있는 (액션, 단계)마다 한 줄씩 JSON으로 찍는다. 단위는 us.
+  // {"action":"CLICK","stage":"detect","count":12,"mean_us":402113,"p50_us":524288,"p99_us":524288,"max_us":405120}
+  void print() const {
+    static const char* const actionNames[NUMBER_OF_ACTIONS] = {
+      "NO_ACTION", "CLICK", "DOUBLECLICK", "TRIPLECLICK", "QUADCLICK", "PENTACLICK",
+      "HEXACLICK", "HEPTACLICK", "OCTACLICK", "NONACLICK", "DECACLICK", "LONGPRESS", "MANYPRESS"
+    };
+    static const char* const stageNames[NUMBER_OF_LATENCY_STAGES] = {
+      "scan", "detect", "combo", "dispatch", "queue", "handler", "total"
+    };
+    LatencySummary s;
+    for (uint8_t a = 1; a < NUMBER_OF_ACTIONS; ++a) {
+      for (uint8_t st = 0; st < NUMBER_OF_LATENCY_STAGES; ++st) {
+        if (!_hist[a][st].read(s) || s.count == 0) continue;
+        Serial.print("{\"action\":\"");
+        Serial.print(actionNames[a]);
+        Serial.print("\",\"stage\":\"");
+        Serial.print(stageNames[st]);
+        Serial.print("\",\"count\":");
+        Serial.print(static_cast<unsigned long>(s.count));
+        Serial.print(",\"mean_us\":");
+        Serial.print(static_cast<unsigned long>(s.mean()));
+        Serial.print(",\"p50_us\":");
+        Serial.print(static_cast<unsigned long>(s.percentile(50)));
+        Serial.print(",\"p99_us\":");
+        Serial.print(static_cast<unsigned long>(s.percentile(99)));
+        Serial.print(",\"max_us\":");
+        Serial.print(static_cast<unsigned long>(s.max));
+        Serial.println("}");
+      }
+    }
+  }
+
+private:
+  struct Pending {
+    std::atomic<uint32_t> edge{0};
+    std::atomic<uint32_t> dispatch{0}; // dispatched()가 불렸으면 그 시점, 아니면 detected() 시점.
+    std::atomic<int8_t> action{NO_ACTION};
+    std::atomic<bool> ready{false};
+  };
+
+  LatencyHistogram _hist[NUMBER_OF_ACTIONS][NUMBER_OF_LATENCY_STAGES];
+  Pending _pending[Slots];
+  int8_t _running[Slots] = {NO_ACTION}; // 수행 쪽만 쓴다.
+  uint32_t _startedAt[Slots] = {0};
+  uint32_t _overwritten = 0;
+};
+
+#endif //RAMJILATENCY_H
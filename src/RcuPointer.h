@@ -0,0 +1,113 @@
+#ifndef RCUPOINTER_H
+#define RCUPOINTER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "RamjiButton.h"
+
+// RcuPointer<T, MaxReaders>
+// - 실행 중에 키맵이나 타이밍 설정을 통째로 바꾸기 위한 포인터. (RCU: read-copy-update 방식)
+// - 새 설정은 옆에서 다 만들어두고 publish()로 포인터 하나만 원자적으로 바꾼다. 읽는 쪽(스캔, 수행 코어)은 락 없이 read()만 한다.
+// - 옛 설정은 바로 못 지운다. 읽는 쪽이 아직 들고 있을 수 있어서.
+//   읽는 쪽마다 registerReader()로 번호를 받고, 루프 맨 위(설정 포인터를 들고 있지 않은 곳)에서 quiescent()를 불러준다.
+//   publish() 이후 등록된 읽는 쪽이 모두 quiescent()를 한 번씩 지나가면(grace point) reclaim()이 옛 설정을 돌려준다.
+// - 힙을 쓰지 않는다. 설정 두 개를 정적으로 만들어두고 번갈아 쓰면 된다. reclaim()으로 돌려받은 걸 다음에 고쳐서 publish.
+// - 쓰는 쪽(publish/reclaim)은 하나라고 가정한다. 회수가 안 끝난 옛 설정이 있으면 publish()는 false.
+// - 등록해놓고 quiescent()를 안 부르는 읽는 쪽이 있으면 회수가 영영 안된다. 멈출 때는 unregisterReader().
+// - MaxReaders 기본값 4는 RamjiButton.h의 앞선 선언에 있다. Button::setProfile()이 이 헤더 없이도 이름을 알아야 해서.
+// - 쓰는 법은 RamjiButton.h의 ButtonProfile 설명.
+template <typename T, size_t MaxReaders>
+class RcuPointer {
+  static_assert(MaxReaders > 0 && MaxReaders <= 32, "RcuPointer supports 1 to 32 readers.");
+
+public:
+  explicit RcuPointer(T* initial = nullptr) : _current(initial), _epoch(1) {
+    for (size_t i = 0; i < MaxReaders; ++i) {
+      _used[i] = false;
+      _seen[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // non-copyable
+  RcuPointer(const RcuPointer&) = delete;
+  RcuPointer& operator=(const RcuPointer&) = delete;
+
+  // 읽는 쪽 번호. setup()에서 받아둔다. 자리가 없으면 -1.
+  int8_t registerReader() {
+    for (size_t i = 0; i < MaxReaders; ++i) {
+      if (_used[i]) continue;
+      _seen[i].store(_epoch.load(std::memory_order_acquire), std::memory_order_release);
+      _used[i] = true;
+      return static_cast<int8_t>(i);
+    }
+    return -1;
+  }
+
+  void unregisterReader(int8_t reader) {
+    if (reader >= 0 && static_cast<size_t>(reader) < MaxReaders) _used[reader] = false;
+  }
+
+  // 지금 설정. 다음 quiescent()까지만 들고 있는다.
+  const T* read() const { return _current.load(std::memory_order_acquire); }
+
+  // 읽는 쪽이 "이제 옛 포인터를 안 들고 있다"고 알린다. 루프 한 바퀴에 한 번.
+  void quiescent(int8_t reader) {
+    if (reader < 0 || static_cast<size_t>(reader) >= MaxReaders) return;
+    _seen[reader].store(_epoch.load(std::memory_order_acquire), std::memory_order_release);
+  }
+
+  /**
+   * publish(next)
+   * - next로 바꾼다. 읽는 쪽은 다음 read()부터 next를 본다.
+   * - 앞에서 바꾼 옛 설정이 아직 회수 안됐으면 바꾸지 않고 false. reclaim()을 먼저 해준다.
+   */
+  bool publish(T* next) {
+    if (_retired) return false;
+    _retired = _current.load(std::memory_order_relaxed);
+    _current.store(next, std::memory_order_release);
+    _retireEpoch = _epoch.load(std::memory_order_relaxed) + 1;
+    _epoch.store(_retireEpoch, std::memory_order_release);
+    return true;
+  }
+
+  // 모든 읽는 쪽이 grace point를 지났으면 옛 설정을 돌려주고(다시 고쳐 써도 된다) 비운다. 아직이면 nullptr.
+  T* reclaim() {
+    if (!_retired || !isGracePassed()) return nullptr;
+    T* old = _retired;
+    _retired = nullptr;
+    return old;
+  }
+
+  // 옛 설정이 회수될 때까지 timeout_ms 동안 기다린다. 회수되면 그 포인터, 못하면 nullptr.
+  // 읽는 코어를 멈추게 하지 않는다. 기다리는 건 publish한 쪽뿐.
+  T* synchronize(unsigned long timeout_ms) {
+    unsigned long start = millis();
+    for (;;) {
+      T* old = reclaim();
+      if (old || !_retired) return old;
+      if (millis() - start >= timeout_ms) return nullptr;
+      delay(1);
+    }
+  }
+
+  bool hasRetired() const { return _retired != nullptr; }
+
+private:
+  std::atomic<T*> _current;
+  std::atomic<uint32_t> _epoch;            // publish()마다 하나씩 오른다.
+  std::atomic<uint32_t> _seen[MaxReaders]; // 읽는 쪽이 마지막으로 quiescent()에서 본 epoch.
+  bool _used[MaxReaders];
+  T* _retired = nullptr;                   // 회수를 기다리는 옛 설정.
+  uint32_t _retireEpoch = 0;
+
+  bool isGracePassed() {
+    for (size_t i = 0; i < MaxReaders; ++i) {
+      if (!_used[i]) continue;
+      uint32_t seen = _seen[i].load(std::memory_order_acquire);
+      if (static_cast<int32_t>(seen - _retireEpoch) < 0) return false;
+    }
+    return true;
+  }
+};
+
+#endif //RCUPOINTER_H
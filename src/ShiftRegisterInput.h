@@ -0,0 +1,125 @@
+#ifndef SHIFTREGISTERINPUT_H
+#define SHIFTREGISTERINPUT_H
+
+// ShiftRegisterInput<Chips>
+// - 74HC165(병렬 입력, 직렬 출력) 데이지 체인을 읽는 입력 소스. 칩 하나에 키 8개.
+//   SH/LD를 한 번 내려서 모든 입력을 동시에 래치하고, 칩 수만큼의 바이트를 한 번에 클럭해서 읽는다.
+//   키마다 GPIO를 읽지 않으므로 칩이 늘어도 비용은 바이트당 클럭 8번만 는다. SPI면 64키에 몇 us.
+// - 결과는 KeyBitmap에 들어간다. attach()한 Button들과 TwoButtonCombo가 그대로 판정한다.
+// - 키 번호는 chip * 8 + 입력(A = 0 ... H = 7). chip 0은 QH가 MCU에 바로 물린 칩, 체인 끝으로 갈수록 번호가 커진다.
+// - 읽는 방법
+//   1) 기본: 비트뱅. data 핀을 읽고 clock 핀을 올렸다 내리기를 8 x Chips번.
+//   2) setBulkReader(): 바이트들을 한 번에 읽어주는 함수와 그 함수에 넘길 ctx. 래치(SH/LD)는 이 클래스가 한다.
+//   3) SPI: ShiftRegisterSPI.h의 ShiftRegisterSPI가 2)의 읽기 함수를 SPI 트랜잭션 하나로 채워준다.
+//      이 헤더는 <SPI.h>에 의존하지 않아서, SPI를 include하든 안 하든 모든 번역 단위에서 클래스 모양이 같다.
+// - 버튼이 GND로 눌리고 풀업이 달린 보통 배선이면 눌림 = 0. 반대 배선이면 setActiveLow(false).
+//
+// ShiftRegisterInput<8> shift(latchPin, clockPin, dataPin); // 칩 8개 = 키 64개
+// Button keys[64];
+// setup: shift.begin(); shift.attach(keys, 64);
+// loop: shift.scan(); for (int i = 0; i < 64; i++) { int8_t a = keys[i].event(); if (a) keys[i].doIt(a); }
+
+#include <Arduino.h>
+#include "RamjiButton.h"
+
+// 칩 수만큼의 바이트를 buf에 채우는 함수. buf[0]이 chip 0, 각 바이트의 비트 7이 H.
+typedef void (*ShiftBulkReader)(uint8_t* buf, size_t bytes, void* ctx);
+
+template <size_t Chips>
+class ShiftRegisterInput : public KeyBitmap<Chips * 8> {
+  static_assert(Chips > 0 && Chips <= 64, "ShiftRegisterInput supports 1 to 64 chips.");
+
+public:
+  // clockInhibitPin: CLK INH를 MCU에 연결했으면 그 핀. GND에 묶었으면 안 준다.
+  ShiftRegisterInput(uint8_t latchPin, uint8_t clockPin, uint8_t dataPin, uint8_t clockInhibitPin = 0xFF)
+    : _latch(latchPin), _clock(clockPin), _data(dataPin), _inhibit(clockInhibitPin) {
+    memset(_raw, 0, sizeof(_raw));
+  }
+
+  void begin() {
+    pinMode(_latch, OUTPUT);
+    digitalWrite(_latch, HIGH);
+    if (_inhibit != 0xFF) {
+      pinMode(_inhibit, OUTPUT);
+      digitalWrite(_inhibit, HIGH);
+    }
+    if (!_bulk) {
+      pinMode(_clock, OUTPUT);
+      digitalWrite(_clock, LOW);
+      pinMode(_data, INPUT);
+    }
+  }
+
+  // nullptr이면 다시 비트뱅. begin()보다 먼저 준다. 주면 begin()이 clock/data 핀을 건드리지 않는다.
+  void setBulkReader(ShiftBulkReader reader, void* ctx = nullptr) {
+    _bulk = reader;
+    _bulkCtx = ctx;
+  }
+
+  void setActiveLow(bool activeLow) { _activeLow = activeLow; }
+
+  // 체인 전체를 래치해서 읽고 비트맵을 갱신한다. 바뀐 키가 있으면 true.
+  bool scan() {
+    uint32_t start = micros();
+    latch();
+    if (_inhibit != 0xFF) digitalWrite(_inhibit, LOW);
+    readChain(_raw, Chips);
+    if (_inhibit != 0xFF) digitalWrite(_inhibit, HIGH);
+    _lastReadUs = micros() - start;
+
+    bool changed = false;
+    for (size_t i = 0; i < Chips; ++i) {
+      uint8_t pressed = _activeLow ? static_cast<uint8_t>(~_raw[i]) : _raw[i];
+      if (this->_bits[i] != pressed) {
+        this->_bits[i] = pressed;
+        changed = true;
+      }
+    }
+    ++_scans;
+    return changed;
+  }
+
+  // 마지막으로 읽은 칩 i의 입력 레벨 그대로(비트 j = 입력 j, 1 = HIGH).
+  uint8_t getRaw(uint8_t chip) { return (chip < Chips) ? _raw[chip] : 0; }
+  // 마지막 scan()에서 래치부터 다 읽기까지 걸린 시간.
+  uint32_t getLastReadMicros() { return _lastReadUs; }
+  uint32_t getScans() { return _scans; }
+
+private:
+  uint8_t _latch;
+  uint8_t _clock;
+  uint8_t _data;
+  uint8_t _inhibit;
+  bool _activeLow = true;
+  uint8_t _raw[Chips];
+  uint32_t _lastReadUs = 0;
+  uint32_t _scans = 0;
+  ShiftBulkReader _bulk = nullptr;
+  void* _bulkCtx = nullptr;
+
+  // SH/LD를 LOW로 내렸다 올리면 모든 입력이 동시에 래치된다. 그 뒤 QH에 chip 0의 H가 바로 나와 있다.
+  void latch() {
+    digitalWrite(_latch, LOW);
+    delayMicroseconds(1);
+    digitalWrite(_latch, HIGH);
+  }
+
+  void readChain(uint8_t* buf, size_t bytes) {
+    if (_bulk) {
+      _bulk(buf, bytes, _bulkCtx);
+      return;
+    }
+    // 비트뱅. 읽고 나서 클럭을 올려야 다음 비트가 나온다.
+    for (size_t i = 0; i < bytes; ++i) {
+      uint8_t v = 0;
+      for (uint8_t b = 0; b < 8; ++b) {
+        v = static_cast<uint8_t>((v << 1) | (digitalRead(_data) ? 1 : 0));
+        digitalWrite(_clock, HIGH);
+        digitalWrite(_clock, LOW);
+      }
+      buf[i] = v;
+    }
+  }
+};
+
+#endif //SHIFTREGISTERINPUT_H
@@ -0,0 +1,46 @@
+#ifndef SHIFTREGISTERSPI_H
+#define SHIFTREGISTERSPI_H
+
+// ShiftRegisterSPI
+// - ShiftRegisterInput의 체인을 SPI 버스로 읽는다. 읽기 한 번이 SPI 트랜잭션 하나. data = MISO, clock = SCK.
+// - ShiftRegisterInput에는 setBulkReader()로 붙는다. 그래서 ShiftRegisterInput.h는 <SPI.h>와 상관없이 늘 같은 모양이고,
+//   SPI가 필요한 스케치만 이 헤더를 include한다. 호스트 빌드에는 SPI가 없으므로 쓰지 않는다.
+// - 74HC165는 클럭 상승에서 밀리므로 SPI_MODE0, MSBFIRST.
+//
+// #include <SPI.h>
+// #include "ShiftRegisterSPI.h"
+// ShiftRegisterInput<8> shift(latchPin, SCK, MISO);
+// ShiftRegisterSPI shiftBus;            // SPI, 4MHz
+// setup: shiftBus.begin(shift); shift.attach(keys, 64);
+// loop: shift.scan(); ...
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "ShiftRegisterInput.h"
+
+class ShiftRegisterSPI {
+public:
+  explicit ShiftRegisterSPI(SPIClass& spi = SPI, uint32_t clockHz = 4000000)
+    : _spi(spi), _settings(clockHz, MSBFIRST, SPI_MODE0) {}
+
+  // SPI.begin()을 부르고 input의 읽기를 이 버스로 바꾼 뒤 input.begin()까지 한다.
+  template <size_t Chips>
+  void begin(ShiftRegisterInput<Chips>& input) {
+    _spi.begin();
+    input.setBulkReader(&ShiftRegisterSPI::read, this);
+    input.begin();
+  }
+
+  static void read(uint8_t* buf, size_t bytes, void* ctx) {
+    ShiftRegisterSPI* self = static_cast<ShiftRegisterSPI*>(ctx);
+    self->_spi.beginTransaction(self->_settings);
+    for (size_t i = 0; i < bytes; ++i) buf[i] = self->_spi.transfer(0);
+    self->_spi.endTransaction();
+  }
+
+private:
+  SPIClass& _spi;
+  SPISettings _settings;
+};
+
+#endif //SHIFTREGISTERSPI_H
@@ -4,6 +4,10 @@
 // 함수	설명
 // push()	데이터 삽입
 // pop()	데이터 꺼내기
+// pushN()	여러 개를 한 번에 삽입. 실제로 들어간 개수 반환
+// popN()	여러 개를 한 번에 꺼내기. 실제로 꺼낸 개수 반환
+// setOverflowPolicy()	큐가 가득 찼을 때 push() 동작 지정 (버리기, 오래된 것 밀어내기, 최신만 남기기, 합치기)
+// getStats()	정책별 카운터 (들어간 수, 버려진 수, 밀려난 수 등)
 // isEmpty()	큐가 비어 있으면 true
 // isFull()	큐가 가득 차 있으면 true
 // size()	현재 큐에 들어 있는 아이템 개수
@@ -63,6 +67,34 @@
 //     delete r;
 // }
 // 그리고 포인터, 참조형 데이터를 담으면 그 대상이 소멸되지 않는지 유의한다.
+//
+// // 예3) 여러 개 한 번에 넣고 빼기. 32개 버튼이 한 번에 떴을 때나, 쌓인 걸 한 번에 다 꺼내 처리할 때.
+// int8_t events[8] = { CLICK, CLICK, LONGPRESS };
+// size_t pushed = intQueue.pushN(events, 3); // 들어간 개수 반환. 큐가 꽉 차면 3보다 작을 수 있다.
+//
+// int8_t outs[10];
+// size_t n = intQueue.popN(outs, 10); // 쌓여있는 걸 최대 10개까지 한 번에 꺼낸다.
+// for (size_t i = 0; i < n; ++i) button.doIt(outs[i]);
+//
+// // 예4) 큐가 가득 찼을 때의 정책. 기본은 OVERFLOW_REJECT (새로 들어오는 걸 버림, 원래 동작).
+// // 정책이 REJECT가 아니면 push()는 timeout_ms와 상관없이 절대 기다리지 않는다. 생산자 코어가 멈추지 않는다.
+// intQueue.setOverflowPolicy(OVERFLOW_DROP_OLDEST); // 가장 오래된 걸 버리고 새 걸 넣는다.
+// intQueue.setOverflowPolicy(OVERFLOW_KEEP_LATEST); // 쌓인 걸 다 비우고 최신 하나만 남긴다. (xQueueOverwrite 방식)
+//
+// // 같은 게 연속으로 들어오면 하나로 합치기. 반복 횟수를 담을 수 있는 타입을 쓰고 합치는 함수를 넘겨준다(꼭 있어야 한다).
+// // 가득 찬 동안 들어온 것은 큐 밖의 대기 슬롯 1칸에 모인다. 자리가 나면 다음 push()나 flushPending() 때 들어가고,
+// // 소비자가 큐를 다 비우면 pop()/popN()이 대기 슬롯에 있던 걸 바로 가져간다. 마지막 것이 슬롯에 갇히지 않는다.
+// // 합칠 수 없는 게 오면 모여 있던 걸 큐에 넣고(자리가 없으면 가장 오래된 걸 밀어내고) 새 것부터 다시 모은다.
+// struct ActionCount { int8_t action; uint8_t repeat; };
+// bool mergeAction(ActionCount& pending, const ActionCount& incoming) {
+//     if (pending.action != incoming.action) return false; // 다르면 못 합침 -> 모인 건 큐로, 새 것부터 다시 모은다.
+//     pending.repeat += incoming.repeat;
+//     return true;
+// }
+// UniversalQueue<ActionCount> actionQueue(10);
+// actionQueue.setOverflowPolicy(OVERFLOW_COALESCE, mergeAction); // 합치는 함수 없이 OVERFLOW_COALESCE면 false, 정책은 그대로.
+//
+// QueueStats st = actionQueue.getStats(); // st.pushed, st.rejected, st.droppedOldest, st.overwritten, st.coalesced
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -72,6 +104,8 @@
 // 주요 사용법.
 // - ESP32에서는 자동으로 FreeRTOS 분기가 활성화됨(따로 define 안 해도 됨).
 // - RP2040(ARDUINO_ARCH_RP2040) 분기도 유지됨.
+// - 호스트(PC) 빌드(RAMJI_HOST)에서는 std::mutex/std::condition_variable로 동작해서 std::thread 사이에서 쓸 수 있다.
+//   timeout_ms는 FreeRTOS처럼 실제 시간으로 기다린다. 가상 시계(millis)와는 상관없다.
 // - ISR에서 사용하려면 FreeRTOS 분기에서 제공하는 pushFromISR/popFromISR 사용 권장.
 //
 // 주의:
@@ -79,9 +113,16 @@
 // - MemoryPool의 allocate/free 짝은 반드시 지켜야 합니다.
 // - RP2040의 blocking queue API는 timeout_ms != 0 인 경우 '무한 대기'가 되므로 동작 차이가 있음.
 // - ISR에서 메모리풀 alloc 호출은 안전하지 않습니다(일반적으로 사용 금지).
+// - 오버플로 정책(setOverflowPolicy)은 생산자가 하나(한 태스크/한 코어)라고 가정합니다.
+//   정책은 push()/pushN()에만 적용되고, pushFromISR()는 기존처럼 가득 차면 실패(카운터만 올림)합니다.
+//   정책이 있으면 push()/pushN()의 timeout_ms는 무시되고 기다리지 않습니다.
+//   카운터는 원자 변수라서 pushFromISR()와 태스크, 소비자 쪽에서 같이 올려도 된다.
 
 #include <cstdint>
 #include <cstddef>
+#include <atomic>
+#include <cstring>
+#include <new>
 #include <type_traits>
 
 //
@@ -113,8 +154,44 @@
   #include "pico/util/queue.h"
   #include "pico/mutex.h"
   #include "pico/stdlib.h"
+#elif defined(RAMJI_HOST)
+  // 호스트(PC) 빌드. CMakeLists.txt가 정의한다. std::thread 사이에서 쓸 수 있게 mutex와 condition_variable로 만든다.
+  #include <chrono>
+  #include <condition_variable>
+  #include <mutex>
+  #include <thread>
+#endif
+
+// 정적 할당(StaticUniversalQueue, 힙 없는 MemoryPool 뮤텍스) 가능 여부.
+// FreeRTOS는 FreeRTOSConfig.h에서 configSUPPORT_STATIC_ALLOCATION을 1로 켜야 한다 (Arduino-ESP32는 기본으로 켜져 있다).
+// RP2040은 queue_t의 저장 공간을 직접 넘겨주므로 항상 가능.
+#if defined(USE_FREERTOS)
+  #if defined(configSUPPORT_STATIC_ALLOCATION) && (configSUPPORT_STATIC_ALLOCATION == 1)
+    #define UNIVERSALQUEUE_STATIC_ALLOCATION 1
+  #else
+    #define UNIVERSALQUEUE_STATIC_ALLOCATION 0
+  #endif
+#else
+  #define UNIVERSALQUEUE_STATIC_ALLOCATION 1
 #endif
 
+// 큐가 가득 찼을 때 push()가 어떻게 할지.
+enum QUEUE_OVERFLOW {
+  OVERFLOW_REJECT,       // 새로 들어오는 걸 버린다. push()는 false. (기본, 원래 동작)
+  OVERFLOW_DROP_OLDEST,  // 가장 오래된 걸 버리고 새 걸 넣는다.
+  OVERFLOW_KEEP_LATEST,  // 쌓여 있던 걸 다 비우고 새 것 하나만 남긴다. 용량 1이면 xQueueOverwrite와 같다.
+  OVERFLOW_COALESCE      // 연속으로 합칠 수 있는 게 들어오면 큐 밖 대기 슬롯에서 하나로 합친다.
+};
+
+// 정책별 카운터. getStats()가 그 순간의 값을 복사해 준다.
+struct QueueStats {
+  uint32_t pushed = 0;        // 큐에 들어간 개수.
+  uint32_t rejected = 0;      // 못 들어가고 버려진 새 아이템 개수.
+  uint32_t droppedOldest = 0; // OVERFLOW_DROP_OLDEST로 밀려난 오래된 아이템 개수.
+  uint32_t overwritten = 0;   // OVERFLOW_KEEP_LATEST로 지워진 아이템 개수.
+  uint32_t coalesced = 0;     // OVERFLOW_COALESCE로 대기 슬롯에 합쳐진 아이템 개수.
+};
+
 /**
  * UniversalQueue<T>: FreeRTOS 또는 RP2040 듀얼코어에서 안전하게 사용할 수 있는 템플릿 큐
  * FreeRTOS의 xQueue 또는 RP2040의 queue_t를 래핑하여 사용.
@@ -138,6 +215,12 @@ class UniversalQueue {
 #elif defined(ARDUINO_ARCH_RP2040)
     queue_init(&_queue, sizeof(T), static_cast<int>(_capacity));
     _initialized = true;
+#elif defined(RAMJI_HOST)
+    if (_capacity > 0) {
+      _buf = new uint8_t[_capacity * sizeof(T)];
+      _ownsBuf = true;
+    }
+    _initialized = (_buf != nullptr);
 #else
     // No RTOS / unsupported platform: 초기화 실패로 처리.
     _initialized = false;
@@ -147,9 +230,11 @@ class UniversalQueue {
   ~UniversalQueue() {
 #if defined(USE_FREERTOS)
     if (_queue) {
-      vQueueDelete(_queue);
+      vQueueDelete(_queue); // 정적 큐도 vQueueDelete로 지운다. 저장 공간은 반환하지 않는다.
       _queue = nullptr;
     }
+#elif defined(RAMJI_HOST)
+    if (_ownsBuf) delete[] _buf;
 #endif
   }
 
@@ -159,51 +244,113 @@ class UniversalQueue {
 
   bool isInitialized() { return _initialized; }
 
+ protected:
   /**
-   * push(item, timeout_ms)
-   * - FreeRTOS: timeout_ms 밀리초만큼 대기 (timeout_ms == 0 -> 즉시)
-   * - RP2040: timeout_ms == 0 -> try, timeout_ms != 0 -> blocking (무한대기)
+   * 저장 공간을 밖에서 받는 생성자. StaticUniversalQueue에서 쓴다. 힙을 전혀 쓰지 않는다.
+   * - FreeRTOS: storage는 capacity * sizeof(T) 바이트, control은 StaticQueue_t. xQueueCreateStatic 사용.
+   * - RP2040: storage는 (capacity + 1) * sizeof(T) 바이트. queue_init()이 하는 calloc 대신 이걸 쓴다.
+   * - 호스트: storage는 capacity * sizeof(T) 바이트.
    */
-  bool push(T& item, uint32_t timeout_ms = 0) {
+  UniversalQueue(size_t capacity, uint8_t* storage, void* control)
+    : _capacity(capacity), _initialized(false)
 #if defined(USE_FREERTOS)
-    if (!_queue) return false;
-    TickType_t ticks = (timeout_ms == 0) ? 0 : pdMS_TO_TICKS(timeout_ms);
-    return xQueueSend(_queue, &item, ticks) == pdPASS;
+    , _queue(nullptr)
+#endif
+  {
+#if defined(USE_FREERTOS) && UNIVERSALQUEUE_STATIC_ALLOCATION
+    _queue = xQueueCreateStatic(static_cast<UBaseType_t>(_capacity), sizeof(T), storage,
+                                static_cast<StaticQueue_t*>(control));
+    _initialized = (_queue != nullptr);
 #elif defined(ARDUINO_ARCH_RP2040)
-    if (timeout_ms == 0) {
-        return queue_try_add(&_queue, &item);  // 반환형 bool
-    } else {
-      // Pico SDK는 timeout 기능이 없음 -> blocking (무한 대기)
-      queue_add_blocking(&_queue, &item);      // 반환형 void
-      return true;
-    }
+    (void)control;
+    // pico-sdk의 queue_init_with_spinlock()과 같은 초기화. 데이터 영역만 우리 것을 쓴다.
+    lock_init(&_queue.core, next_striped_spin_lock_num());
+    _queue.data = storage;
+    _queue.element_count = static_cast<uint16_t>(_capacity);
+    _queue.element_size = static_cast<uint16_t>(sizeof(T));
+    _queue.wptr = 0;
+    _queue.rptr = 0;
+#if PICO_QUEUE_MAX_LEVEL
+    _queue.max_level = 0;
+#endif
+    _initialized = true;
+#elif defined(RAMJI_HOST)
+    (void)control;
+    _buf = storage;
+    _initialized = (_capacity > 0);
 #else
-    (void)item; (void)timeout_ms;
-    return false;
+    (void)storage; (void)control;
+    _initialized = false;
 #endif
   }
 
+ public:
+
+  /**
+   * push(item, timeout_ms)
+   * - FreeRTOS: timeout_ms 밀리초만큼 대기 (timeout_ms == 0 -> 즉시)
+   * - RP2040: timeout_ms == 0 -> try, timeout_ms != 0 -> blocking (무한대기)
+   * - 오버플로 정책이 OVERFLOW_REJECT가 아니면 timeout_ms는 무시되고 가득 찬 경우 정책대로 처리한다.
+   */
+  bool push(T& item, uint32_t timeout_ms = 0) {
+    if (_policy != OVERFLOW_REJECT) return pushWithPolicy(item); // 정책이 있으면 기다리지 않는다.
+    bool ok = pushRaw(item, timeout_ms);
+    bump(ok ? _stats.pushed : _stats.rejected);
+    return ok;
+  }
+
   /**
    * pop(item, timeout_ms)
    * - FreeRTOS: timeout_ms 밀리초만큼 대기 (timeout_ms == 0 -> 즉시)
    * - RP2040: timeout_ms == 0 -> try, timeout_ms != 0 -> blocking(무한대기)
+   * - 큐가 비었는데 OVERFLOW_COALESCE 대기 슬롯에 모인 게 있으면 그걸 꺼낸다.
    */
   bool pop(T& item, uint32_t timeout_ms = 0) {
-#if defined(USE_FREERTOS)
-    if (!_queue) return false;
-    TickType_t ticks = (timeout_ms == 0) ? 0 : pdMS_TO_TICKS(timeout_ms);
-    return xQueueReceive(_queue, &item, ticks) == pdPASS;
-#elif defined(ARDUINO_ARCH_RP2040)
-    if (timeout_ms == 0) {
-        return queue_try_remove(&_queue, &item); // bool 반환
-    } else {
-        queue_remove_blocking(&_queue, &item);   // void 반환
-        return true;                             // 성공했다고 가정
+    if (popRaw(item, 0) || takePending(item)) return true;
+    if (timeout_ms == 0) return false;
+    return popRaw(item, timeout_ms) || takePending(item);
+  }
+
+  /**
+   * pushN(items, count, timeout_ms)
+   * - items[0]부터 순서대로 최대 count개를 넣고, 실제로 들어간 개수를 반환한다.
+   * - timeout_ms는 첫 번째 아이템에만 적용되고, 나머지는 자리가 있는 만큼만 즉시 넣는다.
+   * - 오버플로 정책이 OVERFLOW_REJECT가 아니면 push()와 같이 timeout_ms는 무시된다. 첫 번째 아이템도 기다리지 않고,
+   *   자리가 없는 아이템은 정책대로 처리한다. 정책이 있는 큐에서 pushN()은 항상 즉시 돌아온다.
+   * - FreeRTOS: 스케줄러를 잠근 채로 한꺼번에 넣어서 중간에 소비자 태스크로 문맥 전환이 일어나지 않는다.
+   * - RP2040: 큐의 spin lock을 한 번만 잡고 링버퍼에 바로 복사한다. 기다리던 코어는 마지막에 한 번만 깨운다.
+   */
+  size_t pushN(const T* items, size_t count, uint32_t timeout_ms = 0) {
+    if (!items || count == 0) return 0;
+    if (_policy == OVERFLOW_REJECT) {
+      size_t n = pushNRaw(items, count, timeout_ms);
+      bump(_stats.pushed, static_cast<uint32_t>(n));
+      bump(_stats.rejected, static_cast<uint32_t>(count - n));
+      return n;
     }
-#else
-    (void)item; (void)timeout_ms;
-    return false;
-#endif
+    // 정책이 있으면: 대기 슬롯이 비어 있을 때만 한꺼번에 넣고, 남은 건 하나씩 정책대로 처리한다.
+    // 가득 찼을 때 기다리는 대신 정책을 쓰는 것이므로 timeout_ms는 쓰지 않는다 (push()와 같다).
+    flushPending();
+    size_t n = hasPending() ? 0 : pushNRaw(items, count, 0);
+    bump(_stats.pushed, static_cast<uint32_t>(n));
+    size_t accepted = n;
+    for (; n < count; ++n) {
+      if (pushWithPolicy(items[n])) ++accepted;
+    }
+    return accepted;
+  }
+  /**
+   * popN(items, maxCount, timeout_ms)
+   * - 큐에 쌓여 있는 것을 최대 maxCount개까지 한 번에 꺼내 items[]에 순서대로 담고, 꺼낸 개수를 반환한다.
+   * - timeout_ms는 첫 번째 아이템에만 적용된다. 나머지는 이미 들어와 있는 만큼만 꺼낸다.
+   * - 큐를 다 비웠고 자리가 남으면 OVERFLOW_COALESCE 대기 슬롯에 모인 것도 마지막에 꺼낸다.
+   */
+  size_t popN(T* items, size_t maxCount, uint32_t timeout_ms = 0) {
+    if (!items || maxCount == 0) return 0;
+    size_t n = popNRaw(items, maxCount, 0);
+    if (n == 0 && timeout_ms != 0 && !hasPending()) n = popNRaw(items, maxCount, timeout_ms);
+    if (n < maxCount && takePending(items[n])) ++n;
+    return n;
   }
 
 #if defined(USE_FREERTOS)
@@ -217,7 +364,9 @@ class UniversalQueue {
     BaseType_t xHigher = pdFALSE;
     BaseType_t res = xQueueSendFromISR(_queue, &item, &xHigher);
     if (pxHigherPriorityTaskWoken) *pxHigherPriorityTaskWoken = xHigher;
-    return (res == pdTRUE) || (res == pdPASS);
+    bool ok = (res == pdTRUE) || (res == pdPASS);
+    bump(ok ? _stats.pushed : _stats.rejected);
+    return ok;
   }
 
   bool popFromISR(T& item, BaseType_t* pxHigherPriorityTaskWoken = nullptr) {
@@ -227,14 +376,48 @@ class UniversalQueue {
     if (pxHigherPriorityTaskWoken) *pxHigherPriorityTaskWoken = xHigher;
     return (res == pdTRUE) || (res == pdPASS);
   }
+
+  // pushN/popN의 ISR 버전. 깨어난 태스크가 있는지는 모든 아이템을 처리한 뒤 한 번만 알려준다.
+  size_t pushNFromISR(const T* items, size_t count, BaseType_t* pxHigherPriorityTaskWoken = nullptr) {
+    if (!_queue || !items) return 0;
+    BaseType_t xHigher = pdFALSE;
+    size_t n = 0;
+    while (n < count) {
+      BaseType_t woken = pdFALSE;
+      if (xQueueSendFromISR(_queue, &items[n], &woken) != pdPASS) break;
+      if (woken == pdTRUE) xHigher = pdTRUE;
+      ++n;
+    }
+    if (pxHigherPriorityTaskWoken) *pxHigherPriorityTaskWoken = xHigher;
+    return n;
+  }
+
+  size_t popNFromISR(T* items, size_t maxCount, BaseType_t* pxHigherPriorityTaskWoken = nullptr) {
+    if (!_queue || !items) return 0;
+    BaseType_t xHigher = pdFALSE;
+    size_t n = 0;
+    while (n < maxCount) {
+      BaseType_t woken = pdFALSE;
+      if (xQueueReceiveFromISR(_queue, &items[n], &woken) != pdPASS) break;
+      if (woken == pdTRUE) xHigher = pdTRUE;
+      ++n;
+    }
+    if (pxHigherPriorityTaskWoken) *pxHigherPriorityTaskWoken = xHigher;
+    return n;
+  }
 #endif
 
+  // OVERFLOW_COALESCE 대기 슬롯에 모인 것도 pop()으로 꺼낼 수 있으니 센다. while (!isEmpty()) pop(...)이 슬롯까지 비운다.
   bool isEmpty() {
+    if (hasPending()) return false;
 #if defined(USE_FREERTOS)
     if (!_queue) return true;
     return uxQueueMessagesWaiting(_queue) == 0;
 #elif defined(ARDUINO_ARCH_RP2040)
     return queue_get_level(&_queue) == 0;
+#elif defined(RAMJI_HOST)
+    std::lock_guard<std::mutex> lock(_mtx);
+    return _count == 0;
 #else
     return true;
 #endif
@@ -246,39 +429,495 @@ class UniversalQueue {
     return uxQueueSpacesAvailable(_queue) == 0;
 #elif defined(ARDUINO_ARCH_RP2040)
     return queue_get_level(&_queue) >= static_cast<int>(_capacity);
+#elif defined(RAMJI_HOST)
+    std::lock_guard<std::mutex> lock(_mtx);
+    return _count >= _capacity;
 #else
     return false;
 #endif
   }
 
+  // 대기 슬롯에 모인 것도 하나로 센다.
   size_t size() {
+    size_t pending = hasPending() ? 1 : 0;
 #if defined(USE_FREERTOS)
-    if (!_queue) return 0;
-    return static_cast<size_t>(uxQueueMessagesWaiting(_queue));
+    if (!_queue) return pending;
+    return static_cast<size_t>(uxQueueMessagesWaiting(_queue)) + pending;
 #elif defined(ARDUINO_ARCH_RP2040)
-    return static_cast<size_t>(queue_get_level(&_queue));
+    return static_cast<size_t>(queue_get_level(&_queue)) + pending;
+#elif defined(RAMJI_HOST)
+    std::lock_guard<std::mutex> lock(_mtx);
+    return _count + pending;
 #else
-    return 0;
+    return pending;
 #endif
   }
 
   size_t capacity() { return _capacity; }
 
+  /**
+   * setOverflowPolicy(policy, merge)
+   * - 큐가 가득 찼을 때 push()/pushN()의 동작을 정한다. 기본은 OVERFLOW_REJECT.
+   * - merge는 OVERFLOW_COALESCE에서만 쓰이고, 그때는 꼭 줘야 한다. pending(대기 슬롯)에 incoming을 합쳤으면 true.
+   *   바이트 비교는 패딩 바이트까지 보고, 포인터 큐에서는 주소만 비교하게 돼서 쓰지 않는다. 필드끼리 비교해서 합친다.
+   *   OVERFLOW_COALESCE인데 merge가 nullptr이면 false를 반환하고 정책은 그대로 둔다.
+   * - 정책을 바꾸기 전에 대기 슬롯에 남아 있던 건 한 번 더 넣어보고, 그래도 안되면 버려진다.
+   */
+  bool setOverflowPolicy(QUEUE_OVERFLOW policy, bool (*merge)(T& pending, const T& incoming) = nullptr) {
+    if (policy == OVERFLOW_COALESCE && !merge) return false;
+    flushPending();
+    if (hasPending()) dropPending();
+    _policy = policy;
+    _merge = merge;
+    return true;
+  }
+
+  QUEUE_OVERFLOW getOverflowPolicy() { return _policy; }
+
+  /**
+   * setDropHandler(fn, ctx)
+   * - 큐에 들어갔거나 들어가려던 아이템이 소비자에게 못 가고 버려질 때마다 불린다.
+   *   (밀려난 오래된 것, KEEP_LATEST로 지워진 것, 대기 슬롯에 합쳐진 새 것, 대기 슬롯에서 버려진 것)
+   * - 포인터를 담는 큐라면 여기서 메모리를 반환해주면 된다. MemoryPoolQueue는 알아서 풀로 돌려준다.
+   * - push()가 false를 반환한 경우(거절)는 호출하지 않는다. 그건 원래처럼 호출한 쪽이 처리한다.
+   */
+  void setDropHandler(void (*fn)(T& dropped, void* ctx), void* ctx = nullptr) {
+    _dropFn = fn;
+    _dropCtx = ctx;
+  }
+
+  // OVERFLOW_COALESCE의 대기 슬롯에 있는 걸 큐에 넣어본다. 생산자 쪽에서.
+  // 큐가 다 비면 소비자의 pop()이 가져가므로 따로 불러주지 않아도 마지막 것이 갇히지는 않는다.
+  // 비어 있거나 소비자가 가져가는 중이면 true. 슬롯에 남아 있으면 false.
+  bool flushPending() {
+    uint8_t state = PENDING_FULL;
+    if (!_pendingState.compare_exchange_strong(state, PENDING_BUSY, std::memory_order_acquire)) return true;
+    if (!pushRaw(_pending, 0)) {
+      _pendingState.store(PENDING_FULL, std::memory_order_release);
+      return false;
+    }
+    _pendingState.store(PENDING_EMPTY, std::memory_order_release);
+    bump(_stats.pushed);
+    return true;
+  }
+
+  bool hasPending() { return _pendingState.load(std::memory_order_acquire) != PENDING_EMPTY; }
+
+  QueueStats getStats() {
+    QueueStats st;
+    st.pushed = _stats.pushed.load(std::memory_order_relaxed);
+    st.rejected = _stats.rejected.load(std::memory_order_relaxed);
+    st.droppedOldest = _stats.droppedOldest.load(std::memory_order_relaxed);
+    st.overwritten = _stats.overwritten.load(std::memory_order_relaxed);
+    st.coalesced = _stats.coalesced.load(std::memory_order_relaxed);
+    return st;
+  }
+  void resetStats() {
+    _stats.pushed.store(0, std::memory_order_relaxed);
+    _stats.rejected.store(0, std::memory_order_relaxed);
+    _stats.droppedOldest.store(0, std::memory_order_relaxed);
+    _stats.overwritten.store(0, std::memory_order_relaxed);
+    _stats.coalesced.store(0, std::memory_order_relaxed);
+  }
+
  private:
   size_t _capacity;
   bool _initialized;
 
+  QUEUE_OVERFLOW _policy = OVERFLOW_REJECT;
+  bool (*_merge)(T& pending, const T& incoming) = nullptr;
+  void (*_dropFn)(T& dropped, void* ctx) = nullptr;
+  void* _dropCtx = nullptr;
+  // OVERFLOW_COALESCE 대기 슬롯. 생산자가 모으고, 큐가 비면 소비자가 가져간다.
+  // 만지는 쪽이 PENDING_BUSY로 잡는다. 상대가 잡고 있으면 기다리지 않는다(한 코어에서 ISR/우선순위가 끼어들어도 안 멈춘다).
+  enum : uint8_t { PENDING_EMPTY, PENDING_FULL, PENDING_BUSY };
+  T _pending;
+  std::atomic<uint8_t> _pendingState{PENDING_EMPTY};
+
+  // QueueStats와 같은 순서. pushFromISR(), 생산자, 소비자(대기 슬롯을 가져갈 때)가 같이 올린다.
+  struct AtomicQueueStats {
+    std::atomic<uint32_t> pushed{0};
+    std::atomic<uint32_t> rejected{0};
+    std::atomic<uint32_t> droppedOldest{0};
+    std::atomic<uint32_t> overwritten{0};
+    std::atomic<uint32_t> coalesced{0};
+  };
+  AtomicQueueStats _stats;
+
+  static void bump(std::atomic<uint32_t>& counter, uint32_t n = 1) {
+    if (n) counter.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  // 소비자 쪽. 큐를 다 비웠을 때 대기 슬롯에 모인 걸 가져온다. 생산자가 만지는 중이면 포기한다.
+  // 생산자는 슬롯이 차 있는 동안 새 걸 큐에 바로 넣지 않으므로, 큐가 비었으면 슬롯이 다음 차례다.
+  bool takePending(T& item) {
+    uint8_t state = PENDING_FULL;
+    if (!_pendingState.compare_exchange_strong(state, PENDING_BUSY, std::memory_order_acquire)) return false;
+    item = _pending;
+    _pendingState.store(PENDING_EMPTY, std::memory_order_release);
+    bump(_stats.pushed);
+    return true;
+  }
+
+  bool pushRaw(const T& item, uint32_t timeout_ms) {
+#if defined(USE_FREERTOS)
+    if (!_queue) return false;
+    TickType_t ticks = (timeout_ms == 0) ? 0 : pdMS_TO_TICKS(timeout_ms);
+    return xQueueSend(_queue, &item, ticks) == pdPASS;
+#elif defined(ARDUINO_ARCH_RP2040)
+    if (timeout_ms == 0) {
+        return queue_try_add(&_queue, &item);  // 반환형 bool
+    } else {
+      // Pico SDK는 timeout 기능이 없음 -> blocking (무한 대기)
+      queue_add_blocking(&_queue, &item);      // 반환형 void
+      return true;
+    }
+#elif defined(RAMJI_HOST)
+    return hostAdd(&item, 1, timeout_ms) == 1;
+#else
+    (void)item; (void)timeout_ms;
+    return false;
+#endif
+  }
+
+  size_t pushNRaw(const T* items, size_t count, uint32_t timeout_ms) {
+#if defined(USE_FREERTOS)
+    if (!_queue) return 0;
+    TickType_t ticks = (timeout_ms == 0) ? 0 : pdMS_TO_TICKS(timeout_ms);
+    if (xQueueSend(_queue, &items[0], ticks) != pdPASS) return 0;
+    size_t n = 1;
+    if (n < count) {
+      vTaskSuspendAll();
+      while (n < count && xQueueSend(_queue, &items[n], 0) == pdPASS) ++n;
+      xTaskResumeAll();
+    }
+    return n;
+#elif defined(ARDUINO_ARCH_RP2040)
+    size_t n = 0;
+    if (timeout_ms != 0) {
+      // push()와 마찬가지로 첫 번째 아이템은 자리가 날 때까지 기다린다(무한 대기).
+      queue_add_blocking(&_queue, &items[0]);
+      n = 1;
+    }
+    return n + bulkAdd(items + n, count - n);
+#elif defined(RAMJI_HOST)
+    return hostAdd(items, count, timeout_ms);
+#else
+    (void)items; (void)count; (void)timeout_ms;
+    return 0;
+#endif
+  }
+
+  bool popRaw(T& item, uint32_t timeout_ms) {
+#if defined(USE_FREERTOS)
+    if (!_queue) return false;
+    TickType_t ticks = (timeout_ms == 0) ? 0 : pdMS_TO_TICKS(timeout_ms);
+    return xQueueReceive(_queue, &item, ticks) == pdPASS;
+#elif defined(ARDUINO_ARCH_RP2040)
+    if (timeout_ms == 0) {
+        return queue_try_remove(&_queue, &item); // bool 반환
+    } else {
+        queue_remove_blocking(&_queue, &item);   // void 반환
+        return true;                             // 성공했다고 가정
+    }
+#elif defined(RAMJI_HOST)
+    return hostRemove(&item, 1, timeout_ms) == 1;
+#else
+    (void)item; (void)timeout_ms;
+    return false;
+#endif
+  }
+
+  size_t popNRaw(T* items, size_t maxCount, uint32_t timeout_ms) {
+    if (!items || maxCount == 0) return 0;
+#if defined(USE_FREERTOS)
+    if (!_queue) return 0;
+    TickType_t ticks = (timeout_ms == 0) ? 0 : pdMS_TO_TICKS(timeout_ms);
+    if (xQueueReceive(_queue, &items[0], ticks) != pdPASS) return 0;
+    size_t n = 1;
+    if (n < maxCount) {
+      vTaskSuspendAll();
+      while (n < maxCount && xQueueReceive(_queue, &items[n], 0) == pdPASS) ++n;
+      xTaskResumeAll();
+    }
+    return n;
+#elif defined(ARDUINO_ARCH_RP2040)
+    size_t n = 0;
+    if (timeout_ms != 0) {
+      queue_remove_blocking(&_queue, &items[0]);
+      n = 1;
+    }
+    return n + bulkRemove(items + n, maxCount - n);
+#elif defined(RAMJI_HOST)
+    return hostRemove(items, maxCount, timeout_ms);
+#else
+    (void)timeout_ms;
+    return 0;
+#endif
+  }
+
+  void drop(T& item) {
+    if (_dropFn) _dropFn(item, _dropCtx);
+  }
+
+  // 생산자 쪽. 정책을 바꿀 때 못 넣은 대기 슬롯을 버린다.
+  void dropPending() {
+    uint8_t state = PENDING_FULL;
+    if (!_pendingState.compare_exchange_strong(state, PENDING_BUSY, std::memory_order_acquire)) return;
+    T dropped = _pending;
+    _pendingState.store(PENDING_EMPTY, std::memory_order_release);
+    bump(_stats.rejected);
+    drop(dropped);
+  }
+
+  // 정책이 REJECT가 아닐 때의 push. 절대 기다리지 않는다.
+  bool pushWithPolicy(const T& item) {
+    // 대기 슬롯이 먼저 들어가야 순서가 안꼬인다.
+    if (flushPending() && pushRaw(item, 0)) {
+      bump(_stats.pushed);
+      return true;
+    }
+    switch (_policy) {
+      case OVERFLOW_DROP_OLDEST: {
+        // 그 사이에 소비자가 꺼내갈 수도 있어서 몇 번 다시 해본다.
+        for (uint8_t tries = 0; tries < 3; ++tries) {
+          T oldest;
+          if (popRaw(oldest, 0)) {
+            bump(_stats.droppedOldest);
+            drop(oldest);
+          }
+          if (pushRaw(item, 0)) {
+            bump(_stats.pushed);
+            return true;
+          }
+        }
+        break;
+      }
+      case OVERFLOW_KEEP_LATEST: {
+#if defined(USE_FREERTOS)
+        if (_capacity == 1 && !_dropFn && _queue) {
+          // 한 칸짜리 큐는 xQueueOverwrite 그대로. 덮어쓴 게 있었는지는 알 수 없어서 1개로 센다.
+          xQueueOverwrite(_queue, &item);
+          bump(_stats.overwritten);
+          bump(_stats.pushed);
+          return true;
+        }
+#endif
+        T old;
+        while (popRaw(old, 0)) {
+          bump(_stats.overwritten);
+          drop(old);
+        }
+        if (pushRaw(item, 0)) {
+          bump(_stats.pushed);
+          return true;
+        }
+        break;
+      }
+      case OVERFLOW_COALESCE:
+        if (coalesce(item)) return true;
+        break;
+      default:
+        break;
+    }
+    bump(_stats.rejected);
+    return false;
+  }
+
+  // OVERFLOW_COALESCE. 큐가 가득 찼거나 대기 슬롯에 모이는 중일 때.
+  bool coalesce(const T& item) {
+    // 소비자와 엇갈리면 몇 번 다시 해본다.
+    for (uint8_t tries = 0; tries < 3; ++tries) {
+      uint8_t state = PENDING_EMPTY;
+      if (_pendingState.compare_exchange_strong(state, PENDING_BUSY, std::memory_order_acquire)) {
+        _pending = item;
+        _pendingState.store(PENDING_FULL, std::memory_order_release);
+        flushPending(); // 그 사이 소비자가 큐를 비웠으면 바로 들어간다.
+        return true;
+      }
+      if (state == PENDING_FULL && _pendingState.compare_exchange_strong(state, PENDING_BUSY, std::memory_order_acquire)) {
+        if (_merge(_pending, item)) {
+          _pendingState.store(PENDING_FULL, std::memory_order_release);
+          bump(_stats.coalesced);
+          T incoming = item;
+          drop(incoming); // 합쳐져서 따로 전달되지 않는 새 것.
+          flushPending();
+          return true;
+        }
+        // 합칠 수 없는 게 왔다. 모인 걸 큐에 넣고(자리가 없으면 가장 오래된 걸 밀어내고) 새 것부터 다시 모은다.
+        bool queued = pushRaw(_pending, 0);
+        if (!queued) {
+          T oldest;
+          if (popRaw(oldest, 0)) {
+            bump(_stats.droppedOldest);
+            drop(oldest);
+          }
+          queued = pushRaw(_pending, 0);
+        }
+        if (queued) {
+          bump(_stats.pushed);
+        } else {
+          bump(_stats.rejected);
+          T lost = _pending;
+          drop(lost);
+        }
+        _pending = item;
+        _pendingState.store(PENDING_FULL, std::memory_order_release);
+        return true;
+      }
+      // 소비자가 대기 슬롯을 가져가는 중. 새 것은 그 뒤 차례라서 큐에 바로 넣으면 된다.
+      if (state == PENDING_BUSY && pushRaw(item, 0)) {
+        bump(_stats.pushed);
+        return true;
+      }
+    }
+    return false;
+  }
+
 #if defined(USE_FREERTOS)
   QueueHandle_t _queue;
 #elif defined(ARDUINO_ARCH_RP2040)
   queue_t _queue;
+
+  // pico-sdk의 queue_add_internal / queue_remove_internal과 같은 방식으로 링버퍼를 직접 다룬다.
+  // queue_t는 (element_count + 1)칸을 쓰고, wptr == rptr이면 비어 있는 것.
+  uint16_t nextIndex(uint16_t index) {
+    return (++index > _queue.element_count) ? 0 : index;
+  }
+
+  size_t bulkAdd(const T* items, size_t count) {
+    if (count == 0) return 0;
+    uint32_t save = spin_lock_blocking(_queue.core.spin_lock);
+    size_t n = 0;
+    while (n < count && queue_get_level_unsafe(&_queue) != _queue.element_count) {
+      memcpy(_queue.data + static_cast<size_t>(_queue.wptr) * _queue.element_size, &items[n], sizeof(T));
+      _queue.wptr = nextIndex(_queue.wptr);
+      ++n;
+    }
+    if (n) lock_internal_spin_unlock_with_notify(&_queue.core, save); // 기다리던 pop 쪽을 깨운다.
+    else spin_unlock(_queue.core.spin_lock, save);
+    return n;
+  }
+
+  size_t bulkRemove(T* items, size_t maxCount) {
+    if (maxCount == 0) return 0;
+    uint32_t save = spin_lock_blocking(_queue.core.spin_lock);
+    size_t n = 0;
+    while (n < maxCount && queue_get_level_unsafe(&_queue) != 0) {
+      memcpy(&items[n], _queue.data + static_cast<size_t>(_queue.rptr) * _queue.element_size, sizeof(T));
+      _queue.rptr = nextIndex(_queue.rptr);
+      ++n;
+    }
+    if (n) lock_internal_spin_unlock_with_notify(&_queue.core, save); // 기다리던 push 쪽을 깨운다.
+    else spin_unlock(_queue.core.spin_lock, save);
+    return n;
+  }
+#elif defined(RAMJI_HOST)
+  uint8_t* _buf = nullptr;
+  bool _ownsBuf = false;
+  size_t _rd = 0;     // 가장 오래된 아이템 자리.
+  size_t _count = 0;
+  std::mutex _mtx;
+  std::condition_variable _notEmpty;
+  std::condition_variable _notFull;
+
+  // FreeRTOS처럼 timeout_ms만큼 기다린다. 0이면 즉시, 0xFFFFFFFF(portMAX_DELAY)면 무한 대기.
+  // 기다리는 건 첫 번째 아이템뿐이고 나머지는 자리 있는 만큼만.
+  template <typename Pred>
+  bool hostWait(std::unique_lock<std::mutex>& lock, std::condition_variable& cv, uint32_t timeout_ms, Pred ready) {
+    if (ready()) return true;
+    if (timeout_ms == 0) return false;
+    if (timeout_ms == 0xFFFFFFFFUL) {
+      cv.wait(lock, ready);
+      return true;
+    }
+    return cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+  }
+
+  size_t hostAdd(const T* items, size_t count, uint32_t timeout_ms) {
+    if (!_buf || count == 0) return 0;
+    std::unique_lock<std::mutex> lock(_mtx);
+    if (!hostWait(lock, _notFull, timeout_ms, [this] { return _count < _capacity; })) return 0;
+    size_t n = 0;
+    while (n < count && _count < _capacity) {
+      memcpy(_buf + ((_rd + _count) % _capacity) * sizeof(T), &items[n], sizeof(T));
+      ++_count;
+      ++n;
+    }
+    lock.unlock();
+    if (n) _notEmpty.notify_all();
+    return n;
+  }
+
+  size_t hostRemove(T* items, size_t maxCount, uint32_t timeout_ms) {
+    if (!_buf || maxCount == 0) return 0;
+    std::unique_lock<std::mutex> lock(_mtx);
+    if (!hostWait(lock, _notEmpty, timeout_ms, [this] { return _count > 0; })) return 0;
+    size_t n = 0;
+    while (n < maxCount && _count > 0) {
+      memcpy(&items[n], _buf + _rd * sizeof(T), sizeof(T));
+      _rd = (_rd + 1) % _capacity;
+      --_count;
+      ++n;
+    }
+    lock.unlock();
+    if (n) _notFull.notify_all();
+    return n;
+  }
+#endif
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// StaticUniversalQueue<T, Capacity>
+// - 용량을 컴파일 시간에 정하고, 저장 공간을 객체 안에 품은 UniversalQueue.
+// - 전역으로 만들면 생성 시점(스케줄러 시작 전일 수도 있음)에도 힙을 전혀 안쓰고, 실패할 일이 없다.
+//   RAM 사용량은 .bss에 그대로 잡혀서 링크할 때 보인다.
+// - FreeRTOS에서는 configSUPPORT_STATIC_ALLOCATION == 1이 필요하다. 아니면 컴파일 에러로 알려준다.
+// - 사용법은 UniversalQueue와 같다. 생성자 인자만 없다.
+//
+// StaticUniversalQueue<int8_t, 10> button1Queue; // int8_t 10칸. xQueueCreate 대신 xQueueCreateStatic.
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// 저장 공간은 UniversalQueue보다 먼저 생성돼야 해서 따로 떼어 먼저 상속한다.
+template <typename T, size_t Capacity>
+struct StaticQueueStorage {
+#if defined(USE_FREERTOS)
+  StaticQueue_t _queueControl;
+  alignas(T) uint8_t _queueStorage[Capacity * sizeof(T)];
+#elif defined(ARDUINO_ARCH_RP2040)
+  // queue_t는 한 칸을 비워서 가득 참/비어 있음을 구분하므로 한 칸 더.
+  alignas(T) uint8_t _queueStorage[(Capacity + 1) * sizeof(T)];
+#elif defined(RAMJI_HOST)
+  alignas(T) uint8_t _queueStorage[Capacity * sizeof(T)];
+#else
+  alignas(T) uint8_t _queueStorage[1];
+#endif
+  void* queueControl() {
+#if defined(USE_FREERTOS)
+    return &_queueControl;
+#else
+    return nullptr;
 #endif
+  }
+};
+
+template <typename T, size_t Capacity>
+class StaticUniversalQueue : private StaticQueueStorage<T, Capacity>, public UniversalQueue<T> {
+  static_assert(Capacity > 0, "StaticUniversalQueue needs a capacity of at least 1.");
+  static_assert(UNIVERSALQUEUE_STATIC_ALLOCATION && sizeof(T) > 0,
+                "StaticUniversalQueue needs configSUPPORT_STATIC_ALLOCATION == 1 in FreeRTOSConfig.h.");
+
+ public:
+  StaticUniversalQueue()
+    : StaticQueueStorage<T, Capacity>(),
+      UniversalQueue<T>(Capacity, this->_queueStorage, this->queueControl()) {}
 };
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 // MemoryPool
 // - 고정 크기 배열 기반 메모리 풀
-// - Thread-safe: FreeRTOS -> semaphore, RP2040 -> mutex
+// - Thread-safe: FreeRTOS -> semaphore, RP2040 -> mutex, 호스트 -> std::mutex
+// - FreeRTOS 정적 할당이 켜져 있으면 뮤텍스도 객체 안의 StaticSemaphore_t로 만든다(xSemaphoreCreateMutexStatic). 힙 사용 없음.
 // - 주의: ISR에서 alloc() 호출하지 마세요(대부분 안전하지 않음)
 //////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -295,7 +934,9 @@ public:
         for (size_t i = 0; i < PoolSize; ++i) {
             _freeFlags[i] = true;
         }
-#if defined(USE_FREERTOS)
+#if defined(USE_FREERTOS) && UNIVERSALQUEUE_STATIC_ALLOCATION
+        _mutex = xSemaphoreCreateMutexStatic(&_mutexBuffer);
+#elif defined(USE_FREERTOS)
         _mutex = xSemaphoreCreateMutex();
 #elif defined(ARDUINO_ARCH_RP2040)
         mutex_init(&_mutex);
@@ -356,6 +997,9 @@ private:
     bool _freeFlags[PoolSize];
 
 #if defined(USE_FREERTOS)
+#if UNIVERSALQUEUE_STATIC_ALLOCATION
+    StaticSemaphore_t _mutexBuffer;
+#endif
     SemaphoreHandle_t _mutex = nullptr;
     void lock() { if (_mutex) xSemaphoreTake(_mutex, portMAX_DELAY); }
     void unlock() { if (_mutex) xSemaphoreGive(_mutex); }
@@ -363,6 +1007,10 @@ private:
     mutex_t _mutex;
     void lock() { mutex_enter_blocking(&_mutex); }
     void unlock() { mutex_exit(&_mutex); }
+#elif defined(RAMJI_HOST)
+    std::mutex _mutex;
+    void lock() { _mutex.lock(); }
+    void unlock() { _mutex.unlock(); }
 #else
     void lock() {}
     void unlock() {}
@@ -401,6 +1049,7 @@ private:
 //
 // 6. 힙 메모리 할당이 전혀 없고, 고정 크기 배열 사용
 // 메모리 단편화가 없고, 예측 가능한 메모리 사용량 유지합니다.
+// 정적 할당이 가능하면(UNIVERSALQUEUE_STATIC_ALLOCATION) 내부 큐와 뮤텍스도 객체 안의 저장 공간을 씁니다.
 //
 // - 주의 사항 및 권장 사항
 //
@@ -489,7 +1138,14 @@ private:
 template <typename T, size_t PoolSize>
 class MemoryPoolQueue { // MemoryPool 사용하는 큐.
 public:
-    MemoryPoolQueue() : _queue(PoolSize) {}
+    MemoryPoolQueue()
+#if !UNIVERSALQUEUE_STATIC_ALLOCATION
+      : _queue(PoolSize)
+#endif
+    {
+        // 오버플로 정책으로 버려지는 포인터는 자동으로 풀에 반환된다.
+        _queue.setDropHandler(releaseToPool, this);
+    }
 
     // allocate: 풀에서 객체 할당. (nullptr 리턴 가능)
     T* allocate() {
@@ -507,6 +1163,21 @@ public:
         return _queue.pop(item, timeout_ms);
     }
 
+    // pushN: 할당된 포인터 여러 개를 한 번에 넣음. 실제로 들어간 개수 반환.
+    // items[반환값] 이후의 포인터들은 큐에 안들어갔으므로 호출한 쪽에서 free() 해줘야 한다.
+    // nullptr이 섞여 있으면 그 앞까지만 넣는다.
+    size_t pushN(T* const* items, size_t count, uint32_t timeout_ms = 0) {
+        if (!items) return 0;
+        size_t valid = 0;
+        while (valid < count && items[valid]) ++valid;
+        return _queue.pushN(items, valid, timeout_ms);
+    }
+
+    // popN: 큐에서 최대 maxCount개를 한 번에 꺼냄. 꺼낸 포인터들 각각 사용 후 반드시 free()로 반환하기.
+    size_t popN(T** items, size_t maxCount, uint32_t timeout_ms = 0) {
+        return _queue.popN(items, maxCount, timeout_ms);
+    }
+
     // pop 후 사용이 끝난 객체를 메모리 풀로 반환하는 함수. 사용 후 반드시 free()로 반환하기.
     void free(T* item) {
         _pool.free(item);
@@ -517,15 +1188,891 @@ public:
     size_t size() { return _queue.size(); }
     size_t capacity() { return _queue.capacity(); }
 
+    // 큐가 가득 찼을 때의 정책. UniversalQueue::setOverflowPolicy()와 같다.
+    // 밀려나거나 합쳐져서 버려지는 포인터는 여기서 알아서 free() 된다. push()가 false면 원래대로 직접 free().
+    // OVERFLOW_COALESCE의 merge는 포인터끼리 받고, 꼭 줘야 한다. 주소가 아니라 가리키는 내용을 비교해서 합친다.
+    // bool mergeBox(EventBox*& pending, EventBox* const& incoming) {
+    //     if (pending->action != incoming->action) return false;
+    //     pending->repeat++; return true;
+    // }
+    bool setOverflowPolicy(QUEUE_OVERFLOW policy, bool (*merge)(T*& pending, T* const& incoming) = nullptr) {
+        return _queue.setOverflowPolicy(policy, merge);
+    }
+    bool flushPending() { return _queue.flushPending(); }
+    QueueStats getStats() { return _queue.getStats(); }
+    void resetStats() { _queue.resetStats(); }
+
     // non-copyable
     MemoryPoolQueue(const MemoryPoolQueue&) = delete;
     MemoryPoolQueue& operator=(const MemoryPoolQueue&) = delete;
 
 private:
     MemoryPool<T, PoolSize> _pool;
+    // 정적 할당이 되면 큐도 힙 없이 만든다.
+#if UNIVERSALQUEUE_STATIC_ALLOCATION
+    StaticUniversalQueue<T*, PoolSize> _queue;
+#else
     UniversalQueue<T*> _queue;
+#endif
+
+    static void releaseToPool(T*& item, void* ctx) {
+        static_cast<MemoryPoolQueue*>(ctx)->_pool.free(item);
+    }
 };
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+// PriorityQueue<T, Levels>
+// - 우선순위 단계마다 UniversalQueue를 하나씩 두고, pop()은 항상 높은 단계(0)부터 꺼낸다.
+// - 꾹 누르고 있는 버튼의 MANYPRESS가 큐를 가득 채워도 CLICK이나 조합 LONGPRESS가 그 뒤에서 기다리지 않는다.
+// - 단계별 큐와 별도로 "초인종" 큐(doorbell)에 단계 번호를 넣어서, 비어 있을 때 pop()이 timeout만큼 기다릴 수 있게 했다.
+//   그래서 FreeRTOS 태스크 간, RP2040 코어 간에도 UniversalQueue와 똑같이 쓸 수 있고, FreeRTOS에서는 ISR 버전도 있다.
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// #include "RamjiButton.h"
+// #include "UniversalQueue.h"
+//
+// struct ButtonEvent { uint8_t source; int8_t action; uint8_t repeat; };
+// PriorityQueue<ButtonEvent> eventQueue(10); // 단계마다 10칸. 단계 수 기본 3 (NUMBER_OF_PRIORITIES).
+//
+// void setup() {
+//     // 반복 단계는 가득 차면 오래된 걸 버린다. 높은 단계는 원래대로 거절.
+//     eventQueue.level(PRIORITY_REPEAT).setOverflowPolicy(OVERFLOW_DROP_OLDEST);
+// }
+//
+// // 감지하는 쪽. actionPriority()가 ACTION과 조합 여부로 단계를 정해준다.
+// int8_t* events = buttonCombo.event();
+// if (events[2]) {
+//     ButtonEvent e = { 2, events[2], buttonCombo.getRepeatCount(2) };
+//     eventQueue.push(e, actionPriority(events[2], true));
+// }
+//
+// // 수행하는 쪽. 가장 높은 단계부터 꺼낸다.
+// ButtonEvent e;
+// while (eventQueue.pop(e)) { ... }
+
+template <typename T, size_t Levels = 3>
+class PriorityQueue {
+  static_assert(Levels > 0 && Levels <= 255, "PriorityQueue needs 1 to 255 levels.");
+
+ public:
+  // capacityPerLevel: 단계마다의 최대 저장 개수.
+  explicit PriorityQueue(size_t capacityPerLevel)
+    : _doorbell(capacityPerLevel * Levels) {
+    for (size_t i = 0; i < Levels; ++i) {
+      new (&_storage[i]) UniversalQueue<T>(capacityPerLevel);
+    }
+  }
+
+  ~PriorityQueue() {
+    for (size_t i = 0; i < Levels; ++i) level(i).~UniversalQueue<T>();
+  }
+
+  // non-copyable
+  PriorityQueue(const PriorityQueue&) = delete;
+  PriorityQueue& operator=(const PriorityQueue&) = delete;
+
+  bool isInitialized() {
+    if (!_doorbell.isInitialized()) return false;
+    for (size_t i = 0; i < Levels; ++i) {
+      if (!level(i).isInitialized()) return false;
+    }
+    return true;
+  }
+
+  // 단계별 큐. 단계마다 다른 오버플로 정책을 줄 때 쓴다. 0이 가장 높은 단계.
+  UniversalQueue<T>& level(size_t index) {
+    if (index >= Levels) index = Levels - 1;
+    return *reinterpret_cast<UniversalQueue<T>*>(&_storage[index]);
+  }
+
+  /**
+   * push(item, priority, timeout_ms)
+   * - priority 단계의 큐에 넣는다. 범위를 넘는 priority는 가장 낮은 단계로 간다.
+   * - timeout_ms는 해당 단계의 큐에 그대로 적용된다.
+   */
+  bool push(T& item, uint8_t priority, uint32_t timeout_ms = 0) {
+    uint8_t p = clampLevel(priority);
+    if (!level(p).push(item, timeout_ms)) return false;
+    if (!_doorbell.push(p)) {
+      // 오버플로 정책으로 버려진 아이템의 초인종이 쌓여서 가득 찼다.
+      // 초인종은 "뭔가 들어왔다"는 신호일 뿐이라 하나 치우고 다시 친다.
+      uint8_t stale;
+      _doorbell.pop(stale, 0);
+      _doorbell.push(p);
+    }
+    // 그래도 못 쳤으면 아이템은 들어가 있고, 기다리던 pop()이 시간이 다 됐을 때 한 번 더 찾아서 가져간다.
+    return true;
+  }
+
+  /**
+   * pop(item, timeout_ms)
+   * - 가장 높은 단계부터 하나 꺼낸다.
+   * - 비어 있으면 timeout_ms 동안 새로 들어오기를 기다린다 (UniversalQueue::pop과 같은 규칙).
+   *   버려진 아이템의 초인종에 깨어나도 처음 준 timeout_ms를 넘겨서 기다리지는 않는다.
+   */
+  bool pop(T& item, uint32_t timeout_ms = 0) {
+    if (popHighest(item)) {
+      uint8_t token;
+      _doorbell.pop(token, 0); // 꺼낸 만큼 초인종도 하나 치운다.
+      return true;
+    }
+    if (timeout_ms == 0) return false;
+    const bool forever = (timeout_ms == 0xFFFFFFFFUL);
+    const uint32_t start = nowMs();
+    uint32_t wait = timeout_ms;
+    for (;;) {
+      uint8_t token;
+      // 초인종을 못 친 push()가 있었을 수 있어서 시간이 다 되면 마지막으로 한 번 더 찾는다.
+      if (!_doorbell.pop(token, wait)) return popHighest(item);
+      // 초인종이 울리면 다시 높은 단계부터 찾는다.
+      if (popHighest(item)) return true;
+      // 버려진 아이템의 초인종이었다. 남은 시간만 다시 기다린다.
+      if (!forever) {
+        uint32_t elapsed = nowMs() - start;
+        if (elapsed >= timeout_ms) return false;
+        wait = timeout_ms - elapsed;
+      }
+    }
+  }
+
+#if defined(USE_FREERTOS)
+  bool pushFromISR(T& item, uint8_t priority, BaseType_t* pxHigherPriorityTaskWoken = nullptr) {
+    uint8_t p = clampLevel(priority);
+    BaseType_t w1 = pdFALSE, w2 = pdFALSE;
+    if (!level(p).pushFromISR(item, &w1)) return false;
+    if (!_doorbell.pushFromISR(p, &w2)) {
+      uint8_t stale; // push()와 같다. 버려진 아이템의 초인종을 하나 치우고 다시 친다.
+      _doorbell.popFromISR(stale, nullptr);
+      _doorbell.pushFromISR(p, &w2);
+    }
+    if (pxHigherPriorityTaskWoken) *pxHigherPriorityTaskWoken = (w1 == pdTRUE || w2 == pdTRUE) ? pdTRUE : pdFALSE;
+    return true;
+  }
+
+  bool popFromISR(T& item, BaseType_t* pxHigherPriorityTaskWoken = nullptr) {
+    BaseType_t xHigher = pdFALSE;
+    bool ok = false;
+    for (size_t i = 0; i < Levels && !ok; ++i) {
+      BaseType_t w = pdFALSE;
+      ok = level(i).popFromISR(item, &w);
+      if (w == pdTRUE) xHigher = pdTRUE;
+    }
+    if (ok) {
+      uint8_t token;
+      BaseType_t w = pdFALSE;
+      _doorbell.popFromISR(token, &w);
+      if (w == pdTRUE) xHigher = pdTRUE;
+    }
+    if (pxHigherPriorityTaskWoken) *pxHigherPriorityTaskWoken = xHigher;
+    return ok;
+  }
+#endif
+
+  bool isEmpty() {
+    for (size_t i = 0; i < Levels; ++i) {
+      if (!level(i).isEmpty()) return false;
+    }
+    return true;
+  }
+
+  size_t size() {
+    size_t total = 0;
+    for (size_t i = 0; i < Levels; ++i) total += level(i).size();
+    return total;
+  }
+
+  size_t levels() { return Levels; }
+
+ private:
+  typename std::aligned_storage<sizeof(UniversalQueue<T>), alignof(UniversalQueue<T>)>::type _storage[Levels];
+  UniversalQueue<uint8_t> _doorbell;
+
+  uint8_t clampLevel(uint8_t priority) {
+    return (priority < Levels) ? priority : static_cast<uint8_t>(Levels - 1);
+  }
+
+  // pop()의 남은 대기 시간을 구할 때만 쓰는 ms 시계.
+  static uint32_t nowMs() {
+#if defined(USE_FREERTOS)
+    return static_cast<uint32_t>(xTaskGetTickCount() * portTICK_PERIOD_MS);
+#elif defined(ARDUINO_ARCH_RP2040)
+    return to_ms_since_boot(get_absolute_time());
+#elif defined(RAMJI_HOST)
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#else
+    return 0; // 지원하지 않는 플랫폼. 큐가 초기화되지 않으므로 기다릴 일도 없다.
+#endif
+  }
+
+  bool popHighest(T& item) {
+    for (size_t i = 0; i < Levels; ++i) {
+      if (level(i).pop(item, 0)) return true;
+    }
+    return false;
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// EventBus<T, Capacity, MaxSubscribers>
+// - 생산자 하나가 이벤트를 링에 한 번만 쓰고, 구독자들은 각자 자기 커서로 따라가며 읽는다. (방송, broadcast)
+//   화면 태스크, 로그 태스크, 제어 태스크가 모두 같은 콤보 이벤트를 받아야 할 때 allocate()해서 복사본을 여러 개 넣을 필요가 없다.
+// - 구독자가 늘어도 생산자가 하는 일은 그대로다. 쓰고, 머리(head) 번호를 하나 올린다. 락도 기다림도 없다.
+// - 대신 생산자는 구독자를 기다려주지 않는다. 느린 구독자가 Capacity개 넘게 밀리면 안 읽은 오래된 것들은 덮어써지고,
+//   그 구독자의 getOverruns()가 놓친 개수만큼 올라간다. 다른 구독자에게는 아무 영향이 없다.
+// - 칸마다 일련번호를 둬서, 읽는 도중에 덮어써졌는지를 읽고 나서 확인한다 (seqlock 방식). 찢어진 값은 주지 않는다.
+// - 생산자는 하나(한 태스크/한 코어)라고 가정한다. 구독자 하나를 여러 태스크가 나눠 읽으면 안된다.
+// - 구독 등록(subscribe)은 setup()에서 해둔다.
+// - RP2040 코어 간, FreeRTOS 태스크 간 모두 쓸 수 있다. FreeRTOS에서는 attachTask()로 구독 태스크를 깨울 수 있다.
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// struct ButtonEvent { uint8_t source; int8_t action; uint8_t repeat; };
+// EventBus<ButtonEvent, 16> bus; // 16칸 링. 구독자 최대 4 (기본).
+//
+// int8_t displaySub, loggerSub;
+// void setup() {
+//     displaySub = bus.subscribe(); // 구독 번호. 자리가 없으면 -1.
+//     loggerSub = bus.subscribe();
+// }
+//
+// // 감지하는 쪽. 한 번만 쓴다.
+// ButtonEvent e = { 2, events[2], buttonCombo.getRepeatCount(2) };
+// bus.publish(e);
+//
+// // 화면 태스크. 복사해서 꺼내기.
+// ButtonEvent e;
+// while (bus.read(displaySub, e)) { ... }
+//
+// // 로그 태스크. 복사 없이 링 안에서 바로 읽기. 다 쓰고 advance()가 false면 쓰는 도중에 덮어써진 것이니 버린다.
+// const ButtonEvent* p;
+// while ((p = bus.peek(loggerSub)) != nullptr) {
+//     ButtonEvent copy = *p; // 또는 p를 바로 사용
+//     if (!bus.advance(loggerSub)) continue; // 덮어써졌다. copy는 믿을 수 없다.
+//     ...
+// }
+// if (bus.getOverruns(loggerSub)) { ... } // 로그가 너무 느려서 놓친 개수.
+
+template <typename T, size_t Capacity, size_t MaxSubscribers = 4>
+class EventBus {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "EventBus supports only trivially copyable types.");
+  static_assert(Capacity > 0, "EventBus needs Capacity > 0.");
+  static_assert(MaxSubscribers > 0 && MaxSubscribers <= 127, "EventBus needs 1 to 127 subscribers.");
+
+ public:
+  EventBus() : _head(0) {
+    for (size_t i = 0; i < Capacity; ++i) _slots[i].seq.store(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < MaxSubscribers; ++i) {
+      _used[i] = false;
+      _cursor[i].store(0, std::memory_order_relaxed);
+      _overruns[i] = 0;
+#if defined(USE_FREERTOS)
+      _tasks[i] = nullptr;
+#endif
+    }
+  }
+
+  // non-copyable
+  EventBus(const EventBus&) = delete;
+  EventBus& operator=(const EventBus&) = delete;
+
+  /**
+   * subscribe()
+   * - 구독 번호를 하나 받는다. 지금부터 publish되는 것부터 읽는다. 자리가 없으면 -1.
+   * - 생산자가 돌기 전에(setup에서) 등록해두는 걸 권장.
+   */
+  int8_t subscribe() {
+    for (size_t i = 0; i < MaxSubscribers; ++i) {
+      if (_used[i]) continue;
+      _used[i] = true;
+      _cursor[i].store(_head.load(std::memory_order_acquire), std::memory_order_relaxed);
+      _overruns[i] = 0;
+      return static_cast<int8_t>(i);
+    }
+    return -1;
+  }
+
+  void unsubscribe(int8_t id) {
+    if (!valid(id)) return;
+    _used[id] = false;
+#if defined(USE_FREERTOS)
+    _tasks[id] = nullptr;
+#endif
+  }
+
+  /**
+   * publish(item)
+   * - 링에 한 번 쓰고 끝. 절대 기다리지 않고 항상 성공한다.
+   * - 가장 느린 구독자가 Capacity개 넘게 밀려 있으면 그 구독자가 안 읽은 가장 오래된 것을 덮어쓴다.
+   */
+  void publish(const T& item) {
+    uint32_t h = _head.load(std::memory_order_relaxed);
+    Slot& s = _slots[h % Capacity];
+    s.seq.store(0, std::memory_order_relaxed); // 쓰는 중 표시. 읽던 구독자는 다 읽고 나서 알아챈다.
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&s.item, &item, sizeof(T));
+    s.seq.store(h + 1, std::memory_order_release);
+    _head.store(h + 1, std::memory_order_release);
+#if defined(USE_FREERTOS)
+    for (size_t i = 0; i < MaxSubscribers; ++i) {
+      if (_tasks[i]) xTaskNotifyGive(_tasks[i]);
+    }
+#endif
+  }
+
+  /**
+   * read(id, out)
+   * - 구독자 id의 다음 이벤트를 out에 복사해서 꺼낸다. 새 게 없으면 false.
+   * - 밀려서 덮어써진 것들은 건너뛰고 getOverruns()에 더한 다음, 남아 있는 것 중 가장 오래된 걸 준다.
+   */
+  bool read(int8_t id, T& out) {
+    if (!valid(id)) return false;
+    for (;;) {
+      const Slot* s = current(id);
+      if (!s) return false;
+      uint32_t cur = _cursor[id].load(std::memory_order_relaxed);
+      std::memcpy(&out, &s->item, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (s->seq.load(std::memory_order_relaxed) == cur + 1) {
+        _cursor[id].store(cur + 1, std::memory_order_release);
+        return true;
+      }
+      // 복사하는 도중에 생산자가 덮어썼다. 다시 따라잡는다.
+    }
+  }
+
+  /**
+   * peek(id)
+   * - 복사 없이 링 안의 다음 이벤트를 가리킨다. 새 게 없으면 nullptr.
+   * - 다 쓰고 나면 advance(id)를 부른다. advance()가 false면 쓰는 도중에 덮어써진 것이라 읽은 값은 버려야 한다.
+   */
+  const T* peek(int8_t id) {
+    if (!valid(id)) return nullptr;
+    const Slot* s = current(id);
+    return s ? &s->item : nullptr;
+  }
+
+  bool advance(int8_t id) {
+    if (!valid(id)) return false;
+    uint32_t cur = _cursor[id].load(std::memory_order_relaxed);
+    if (cur == _head.load(std::memory_order_acquire)) return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    bool intact = _slots[cur % Capacity].seq.load(std::memory_order_relaxed) == cur + 1;
+    if (intact) {
+      _cursor[id].store(cur + 1, std::memory_order_release);
+    } else {
+      catchUp(id); // 놓친 것으로 센다.
+    }
+    return intact;
+  }
+
+  // 구독자 id가 아직 안 읽은 개수. Capacity를 넘으면 그만큼은 이미 놓친 것.
+  size_t available(int8_t id) {
+    if (!valid(id)) return 0;
+    return _head.load(std::memory_order_acquire) - _cursor[id].load(std::memory_order_relaxed);
+  }
+
+  // 구독자 id가 밀려서 놓친 이벤트 개수.
+  uint32_t getOverruns(int8_t id) { return valid(id) ? _overruns[id] : 0; }
+  void resetOverruns(int8_t id) { if (valid(id)) _overruns[id] = 0; }
+
+  // 지금까지 publish된 총 개수 (32비트에서 돌아간다).
+  uint32_t published() { return _head.load(std::memory_order_acquire); }
+
+  size_t capacity() { return Capacity; }
+
+#if defined(USE_FREERTOS)
+  // publish()마다 task에 알림(xTaskNotifyGive)을 보낸다. 구독 태스크는 ulTaskNotifyTake()로 기다린다.
+  // 붙인 태스크 수만큼 생산자 일이 늘어나니, 폴링으로 충분하면 안 붙여도 된다.
+  void attachTask(int8_t id, TaskHandle_t task) { if (valid(id)) _tasks[id] = task; }
+#endif
+
+ private:
+  struct Slot {
+    std::atomic<uint32_t> seq; // 이 칸에 들어 있는 이벤트 번호 + 1. 0이면 비었거나 쓰는 중.
+    T item;
+  };
+
+  Slot _slots[Capacity];
+  std::atomic<uint32_t> _head;                     // 다음에 쓸 이벤트 번호. 생산자만 쓴다.
+  std::atomic<uint32_t> _cursor[MaxSubscribers];   // 구독자마다 다음에 읽을 이벤트 번호. 그 구독자만 쓴다.
+  uint32_t _overruns[MaxSubscribers];
+  bool _used[MaxSubscribers];
+#if defined(USE_FREERTOS)
+  TaskHandle_t _tasks[MaxSubscribers];
+#endif
+
+  bool valid(int8_t id) {
+    return id >= 0 && static_cast<size_t>(id) < MaxSubscribers && _used[id];
+  }
+
+  // 커서가 가리키는 칸. 비어 있으면 nullptr. 밀렸으면 먼저 따라잡는다.
+  const Slot* current(int8_t id) {
+    for (;;) {
+      uint32_t cur = _cursor[id].load(std::memory_order_relaxed);
+      uint32_t head = _head.load(std::memory_order_acquire);
+      if (cur == head) return nullptr;
+      if (head - cur > Capacity) {
+        catchUp(id);
+        continue;
+      }
+      const Slot& s = _slots[cur % Capacity];
+      if (s.seq.load(std::memory_order_acquire) == cur + 1) return &s;
+      catchUp(id); // 이미 다음 바퀴가 덮어썼거나 쓰는 중.
+    }
+  }
+
+  // 링에 아직 남아 있는 가장 오래된 이벤트로 커서를 옮기고, 건너뛴 개수를 놓친 것으로 센다.
+  // 쓰는 중인 칸을 피하려고 Capacity - 1칸만 남긴다.
+  void catchUp(int8_t id) {
+    uint32_t cur = _cursor[id].load(std::memory_order_relaxed);
+    uint32_t head = _head.load(std::memory_order_acquire);
+    uint32_t oldest = head - static_cast<uint32_t>(Capacity - 1);
+    if (static_cast<int32_t>(oldest - cur) <= 0) oldest = cur + 1;
+    _overruns[id] += oldest - cur;
+    _cursor[id].store(oldest, std::memory_order_release);
+  }
+};
+
+#if defined(USE_FREERTOS)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// ActionNotifier (FreeRTOS 전용)
+// - 큐 없이 태스크 알림(task notification)으로 액션을 전달한다. 복사나 큐 관리 비용이 없다.
+// - 버튼(슬롯) 하나당 알림 값의 비트 하나. 최대 32개 버튼이 하나의 수행 태스크로 보낼 수 있다.
+// - 액션 번호와 반복 횟수는 슬롯마다 32비트 워드 하나에 담아두고, 알림에는 "이 슬롯에 새 게 있다"는 비트만 보낸다.
+// - 같은 슬롯에 소비자가 꺼내기 전에 또 게시하면: MANYPRESS끼리는 반복 횟수가 더해지고(최대 255),
+//   그 밖에는 최신 것으로 덮어쓴다(getOverwritten()으로 센다). CLICK 두 번도 하나로 합치지 않는다.
+//   doIt(action, repeat)은 MANYPRESS가 아니면 repeat을 1로 보므로, 합쳐 봐야 한 번만 수행돼서 조용히 사라지기 때문이다.
+//   놓치면 안되는 액션이 많다면 큐를 쓴다.
+// - 비트마스크 알림이라서 ulTaskNotifyTake(카운팅) 대신 xTaskNotifyWait로 비트를 받고 지운다.
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// ActionNotifier notifier; // 슬롯 0: 버튼1, 1: 버튼2, 2: 버튼1, 2 콤보
+//
+// // 수행 태스크. 먼저 자기를 소비자로 등록한다.
+// void Task_buttonExecute(void *pvParameters) {
+//   notifier.setConsumer(xTaskGetCurrentTaskHandle());
+//   for (;;) {
+//     uint32_t bits = notifier.wait(portMAX_DELAY); // 알림이 올 때까지 잔다.
+//     while (bits) {
+//       uint8_t slot = __builtin_ctz(bits); // 가장 낮은 비트부터.
+//       bits &= bits - 1;
+//       uint8_t repeat;
+//       int8_t action = notifier.take(slot, &repeat); // repeat: MANYPRESS면 쌓인 반복 횟수, 아니면 1.
+//       if (slot == 0) button1.doIt(action, repeat);
+//       ...
+//     }
+//   }
+// }
+//
+// // 감지 태스크.
+// if (events[0] != NO_ACTION) notifier.post(0, events[0], buttonCombo.getRepeatCount(0));
+
+class ActionNotifier {
+ public:
+  static const uint8_t MAX_SLOTS = 32;
+  // 반복 횟수를 더해 합치는 액션. enum ACTION의 MANYPRESS(12). 이 헤더는 RamjiButton.h 없이도 쓰이므로 숫자로 두고,
+  // 두 헤더를 같이 쓰는 곳에서는 아래(또는 RamjiButton.h 끝)의 static_assert가 MANYPRESS와 같은지 확인한다.
+  static const uint8_t REPEAT_ACTION = 12;
+
+  explicit ActionNotifier(TaskHandle_t consumer = nullptr) : _consumer(consumer) {
+    for (uint8_t i = 0; i < MAX_SLOTS; ++i) _words[i].store(0, std::memory_order_relaxed);
+  }
+
+  // non-copyable
+  ActionNotifier(const ActionNotifier&) = delete;
+  ActionNotifier& operator=(const ActionNotifier&) = delete;
+
+  // 알림을 받을 태스크. 수행 태스크 안에서 xTaskGetCurrentTaskHandle()로 등록하면 편하다.
+  void setConsumer(TaskHandle_t consumer) { _consumer = consumer; }
+  TaskHandle_t getConsumer() { return _consumer; }
+
+  /**
+   * post(slot, action, repeat)
+   * - slot의 액션 워드를 갱신하고 소비자 태스크에 slot 비트를 보낸다.
+   * - 소비자가 아직 등록 안됐으면 워드만 남기고 false. 등록 후 첫 wait()에서는 비트가 없으니 take()로 직접 확인해야 한다.
+   */
+  bool post(uint8_t slot, int8_t action, uint8_t repeat = 1) {
+    if (!store(slot, action, repeat)) return false;
+    if (!_consumer) return false;
+    xTaskNotify(_consumer, 1UL << slot, eSetBits);
+    return true;
+  }
+
+  bool postFromISR(uint8_t slot, int8_t action, uint8_t repeat = 1, BaseType_t* pxHigherPriorityTaskWoken = nullptr) {
+    if (!store(slot, action, repeat)) return false;
+    if (!_consumer) return false;
+    BaseType_t xHigher = pdFALSE;
+    xTaskNotifyFromISR(_consumer, 1UL << slot, eSetBits, &xHigher);
+    if (pxHigherPriorityTaskWoken) *pxHigherPriorityTaskWoken = xHigher;
+    return true;
+  }
+
+  /**
+   * wait(timeout_ms)
+   * - 소비자 태스크에서만 부른다. 새 게 있는 슬롯들의 비트마스크를 받고 알림 값은 지운다.
+   * - timeout_ms == 0 -> 즉시, portMAX_DELAY를 주면 올 때까지 잔다. 아무것도 없으면 0.
+   */
+  uint32_t wait(uint32_t timeout_ms) {
+    TickType_t ticks = (timeout_ms == 0) ? 0
+                     : (timeout_ms == portMAX_DELAY) ? portMAX_DELAY
+                     : pdMS_TO_TICKS(timeout_ms);
+    uint32_t bits = 0;
+    if (xTaskNotifyWait(0, 0xFFFFFFFFUL, &bits, ticks) != pdTRUE) return 0;
+    return bits;
+  }
+
+  // slot의 액션을 꺼내고 비운다. 없으면 NO_ACTION(0). repeat에는 반복 횟수.
+  int8_t take(uint8_t slot, uint8_t* repeat = nullptr) {
+    if (slot >= MAX_SLOTS) return 0;
+    uint32_t w = _words[slot].exchange(0, std::memory_order_acquire);
+    if (repeat) {
+      uint8_t r = static_cast<uint8_t>((w >> 8) & 0xFF);
+      *repeat = r ? r : 1;
+    }
+    return static_cast<int8_t>(w & 0xFF);
+  }
+
+  // 소비자가 꺼내기 전에 새 게시로 덮어써진 횟수. MANYPRESS끼리 합쳐진 건 세지 않는다.
+  uint32_t getOverwritten() { return _overwritten.load(std::memory_order_relaxed); }
+
+ private:
+  TaskHandle_t _consumer;
+  // [7:0] 액션 번호, [15:8] 반복 횟수. 0이면 비어 있음.
+  std::atomic<uint32_t> _words[MAX_SLOTS];
+  // post()와 postFromISR()가 같이 올린다.
+  std::atomic<uint32_t> _overwritten{0};
+
+  bool store(uint8_t slot, int8_t action, uint8_t repeat) {
+    if (slot >= MAX_SLOTS || action == 0) return false;
+    if (repeat == 0) repeat = 1;
+    uint32_t a = static_cast<uint8_t>(action);
+    uint32_t old = _words[slot].load(std::memory_order_relaxed);
+    uint32_t next;
+    do {
+      uint32_t count = repeat;
+      if (old != 0 && a == REPEAT_ACTION && (old & 0xFF) == a) {
+        // MANYPRESS가 아직 안 꺼내졌으면 반복 횟수를 더한다. 꺼낼 때의 uint8_t에 맞춰 여기서 자른다.
+        count += (old >> 8) & 0xFF;
+        if (count > 0xFF) count = 0xFF;
+      }
+      next = a | (count << 8);
+    } while (!_words[slot].compare_exchange_weak(old, next, std::memory_order_release, std::memory_order_relaxed));
+    if (old != 0 && !(a == REPEAT_ACTION && (old & 0xFF) == a)) _overwritten.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+};
+
+#if defined(RAMJIBUTTON_H) // RamjiButton.h를 먼저 포함했을 때. 반대 순서는 RamjiButton.h 끝에서 확인한다.
+static_assert(ActionNotifier::REPEAT_ACTION == MANYPRESS, "ActionNotifier::REPEAT_ACTION must match MANYPRESS.");
+#endif
+#endif
+
+#if defined(USE_FREERTOS) || defined(RAMJI_HOST)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// ActionExecutor<Workers> (FreeRTOS, 호스트 빌드)
+// - 수행 태스크 하나가 핸들러를 차례로 부르면 느린 핸들러(예: customTwoButtonLongPress) 뒤에 모든 액션이 밀린다.
+//   감지 쪽은 dispatch()로 던져 넣기만 하고, 실제 수행은 Workers개의 작업 태스크가 나눠서 한다.
+// - 같은 key(버튼 번호)로 들어온 액션은 항상 같은 작업 태스크의 전용 큐로 가서 들어온 순서대로 수행된다.
+//   대신 같은 작업 태스크로 가는 다른 버튼은 그 버튼의 느린 핸들러를 기다릴 수 있다. (key % Workers로 나눈다)
+// - key를 EXECUTOR_ANY_KEY로 주면 순서 상관 없는 일로 보고 공용 큐에 넣는다. 먼저 손이 빈 작업 태스크가 가져간다.
+// - setAffinity(action, worker)로 특정 액션을 특정 작업 태스크로 고정할 수 있다. (예: 화면 그리는 LONGPRESS는 한 곳에서만)
+//   고정된 액션은 key 순서보다 고정이 먼저라서, 같은 버튼의 다른 액션과는 순서가 보장되지 않는다.
+// - begin()의 cores로 작업 태스크를 코어에 고정할 수 있다 (ESP32의 xTaskCreatePinnedToCore). 다른 포트에서는 무시된다.
+// - 핸들러는 작업 태스크에서 불리므로, 핸들러끼리 공유하는 데이터는 핸들러 쪽에서 보호해야 한다.
+// - 소멸자는 작업 태스크에 멈추라고 알리고, 각자 하던 핸들러와 큐에 남은 작업을 끝내고 나갈 때까지 기다린다.
+//   핸들러 도중에 vTaskDelete로 끊으면 핸들러가 잡고 있던 뮤텍스나 큐가 엉킬 수 있어서다.
+// - 호스트 빌드(RAMJI_HOST)에서는 작업 태스크 대신 std::thread를 쓰고, begin()에 인자가 없다. 소멸자가 스레드를 멈추고 join한다.
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// void onButtonAction(uint8_t key, int8_t action, uint8_t repeat, void* ctx) {
+//   if (key == 0) for (uint8_t i = 0; i < repeat; i++) button1.doIt(action);
+//   else if (key == 2) buttonCombo.doIt(action, repeat);
+// }
+//
+// ActionExecutor<2> executor(10); // 작업 태스크 2개, 작업 태스크마다 전용 큐 10칸. 공용 큐는 10 * 2칸.
+//
+// void setup() {
+//   executor.setHandler(onButtonAction);
+//   executor.setAffinity(LONGPRESS, 1); // LONGPRESS는 몇 번 버튼이든 작업 태스크 1에서만.
+//   const BaseType_t cores[2] = { 1, 1 }; // 감지 태스크가 코어 0에 있으면 작업은 코어 1로.
+//   executor.begin("ActionWorker", 4096, 1, cores);
+// }
+//
+// // 감지 태스크. 기다리지 않고 넣기만 한다. 가득 차면 false.
+// if (events[0] != NO_ACTION) executor.dispatch(0, events[0], button1.getRepeatCount());
+
+#define EXECUTOR_ANY_KEY 0xFF     // 순서를 지킬 필요 없는 액션. 공용 큐로 간다.
+#define EXECUTOR_ANY_WORKER 0xFF  // 액션 고정 없음.
+#define EXECUTOR_AFFINITY_ACTIONS 16 // setAffinity()를 줄 수 있는 액션 번호 범위. NUMBER_OF_ACTIONS보다 크게.
+
+// 핸들러 모양. key는 dispatch()에 준 버튼 번호, repeat은 수행할 횟수.
+typedef void (*ActionHandler)(uint8_t key, int8_t action, uint8_t repeat, void* ctx);
+
+// 큐에 실리는 작업 하나. 핸들러 포인터와 인자만 담아서 trivially copyable.
+struct ActionJob {
+  ActionHandler handler;
+  void* ctx;
+  uint8_t key;
+  int8_t action;
+  uint8_t repeat;
+};
+
+template <size_t Workers = 2>
+class ActionExecutor {
+  static_assert(Workers > 0 && Workers <= 32, "ActionExecutor needs 1 to 32 workers.");
+
+ public:
+  // capacityPerWorker: 작업 태스크마다 전용 큐 크기. 공용 큐는 capacityPerWorker * Workers.
+  explicit ActionExecutor(size_t capacityPerWorker)
+    : _shared(capacityPerWorker * Workers), _idle(0), _next(0) {
+    for (size_t i = 0; i < Workers; ++i) {
+      new (&_storage[i]) UniversalQueue<ActionJob>(capacityPerWorker);
+#if defined(USE_FREERTOS)
+      _tasks[i] = nullptr;
+#endif
+      _executed[i].store(0, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < EXECUTOR_AFFINITY_ACTIONS; ++i) _affinity[i] = EXECUTOR_ANY_WORKER;
+  }
+
+  ~ActionExecutor() {
+    _stop = true;
+#if defined(USE_FREERTOS)
+    for (size_t i = 0; i < Workers; ++i) wake(static_cast<uint8_t>(i));
+    // 작업 태스크는 workerLoop를 빠져나오면서 자기 비트를 지우고 스스로 지운다.
+    while (_live.load(std::memory_order_acquire) != 0) vTaskDelay(1);
+#else
+    for (size_t i = 0; i < Workers; ++i) {
+      wake(static_cast<uint8_t>(i));
+      if (_threads[i].joinable()) _threads[i].join();
+    }
+#endif
+    for (size_t i = 0; i < Workers; ++i) lane(i).~UniversalQueue<ActionJob>();
+  }
+
+  // non-copyable
+  ActionExecutor(const ActionExecutor&) = delete;
+  ActionExecutor& operator=(const ActionExecutor&) = delete;
+
+  bool isInitialized() {
+    if (!_shared.isInitialized()) return false;
+    for (size_t i = 0; i < Workers; ++i) {
+      if (!lane(i).isInitialized()) return false;
+    }
+    return true;
+  }
+
+#if defined(USE_FREERTOS)
+  /**
+   * begin(name, stackDepth, priority, cores)
+   * - 작업 태스크 Workers개를 만든다. 한 번만 부른다.
+   * - cores가 있으면 작업 태스크 i를 cores[i] 코어에 고정한다 (ESP32). 없으면 tskNO_AFFINITY.
+   * - 하나라도 못 만들면 false. 이미 만든 태스크는 그대로 돈다.
+   */
+  bool begin(const char* name, uint32_t stackDepth, UBaseType_t priority, const BaseType_t* cores = nullptr) {
+    if (!isInitialized()) return false;
+    bool ok = true;
+    for (size_t i = 0; i < Workers; ++i) {
+      if (_tasks[i]) continue;
+      _self[i].owner = this;
+      _self[i].index = static_cast<uint8_t>(i);
+      const uint32_t bit = 1UL << i;
+      _live.fetch_or(bit, std::memory_order_release); // 태스크가 돌자마자 끝날 수도 있어서 만들기 전에 세운다.
+#if defined(ESP_PLATFORM) || defined(ARDUINO_ARCH_ESP32)
+      BaseType_t core = cores ? cores[i] : tskNO_AFFINITY;
+      bool created = xTaskCreatePinnedToCore(workerEntry, name, stackDepth, &_self[i], priority, &_tasks[i], core) == pdPASS;
+#else
+      (void)cores;
+      bool created = xTaskCreate(workerEntry, name, stackDepth, &_self[i], priority, &_tasks[i]) == pdPASS;
+#endif
+      if (!created) {
+        _tasks[i] = nullptr;
+        _live.fetch_and(~bit, std::memory_order_release);
+      }
+      ok &= created;
+    }
+    return ok;
+  }
+#else
+  // 작업 스레드 Workers개를 띄운다. 한 번만 부른다.
+  bool begin() {
+    if (!isInitialized()) return false;
+    for (size_t i = 0; i < Workers; ++i) {
+      if (_threads[i].joinable()) continue;
+      _threads[i] = std::thread(&ActionExecutor::workerLoop, this, static_cast<uint8_t>(i));
+    }
+    return true;
+  }
+#endif
+
+  // dispatch()에서 handler를 안 줬을 때 쓰는 기본 핸들러.
+  void setHandler(ActionHandler handler, void* ctx = nullptr) {
+    _handler = handler;
+    _ctx = ctx;
+  }
+
+  // action을 항상 worker 작업 태스크에서 수행한다. EXECUTOR_ANY_WORKER면 고정 해제.
+  void setAffinity(int8_t action, uint8_t worker) {
+    uint8_t a = static_cast<uint8_t>(action);
+    if (a >= EXECUTOR_AFFINITY_ACTIONS) return;
+    _affinity[a] = (worker < Workers) ? worker : EXECUTOR_ANY_WORKER;
+  }
+
+  uint8_t getAffinity(int8_t action) {
+    uint8_t a = static_cast<uint8_t>(action);
+    return (a < EXECUTOR_AFFINITY_ACTIONS) ? _affinity[a] : EXECUTOR_ANY_WORKER;
+  }
+
+  /**
+   * dispatch(key, action, repeat, timeout_ms)
+   * - 액션을 작업 태스크에 넘긴다. 수행이 끝나길 기다리지 않는다.
+   * - timeout_ms는 큐가 가득 찼을 때만 적용된다. 감지 태스크에서는 0(기본)으로 두는 게 좋다.
+   * - 핸들러가 없거나 큐가 가득 차면 false.
+   */
+  bool dispatch(uint8_t key, int8_t action, uint8_t repeat = 1, uint32_t timeout_ms = 0) {
+    return dispatch(key, action, repeat, _handler, _ctx, timeout_ms);
+  }
+
+  bool dispatch(uint8_t key, int8_t action, uint8_t repeat, ActionHandler handler, void* ctx, uint32_t timeout_ms = 0) {
+    if (!handler || action == 0) return false;
+    ActionJob job = { handler, ctx, key, action, repeat ? repeat : static_cast<uint8_t>(1) };
+    uint8_t w = route(key, action);
+    if (w == EXECUTOR_ANY_WORKER) {
+      if (!_shared.push(job, timeout_ms)) return false;
+      wake(pickIdle());
+      return true;
+    }
+    if (!lane(w).push(job, timeout_ms)) return false;
+    wake(w);
+    return true;
+  }
+
+  // 아직 수행 안된 작업 개수.
+  size_t pending() {
+    size_t total = _shared.size();
+    for (size_t i = 0; i < Workers; ++i) total += lane(i).size();
+    return total;
+  }
+
+  // worker 작업 태스크가 수행한 작업 개수.
+  uint32_t getExecuted(size_t worker) { return (worker < Workers) ? _executed[worker].load(std::memory_order_relaxed) : 0; }
+
+#if defined(USE_FREERTOS)
+  TaskHandle_t getWorkerHandle(size_t worker) { return (worker < Workers) ? _tasks[worker] : nullptr; }
+#endif
+
+  size_t workers() { return Workers; }
+
+ private:
+#if defined(USE_FREERTOS)
+  struct WorkerArg {
+    ActionExecutor* owner;
+    uint8_t index;
+  };
+#else
+  // 태스크 알림 대신. count는 ulTaskNotifyTake의 알림 값과 같은 역할.
+  struct Doorbell {
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t count = 0;
+  };
+#endif
+
+  typename std::aligned_storage<sizeof(UniversalQueue<ActionJob>), alignof(UniversalQueue<ActionJob>)>::type _storage[Workers];
+  UniversalQueue<ActionJob> _shared;
+#if defined(USE_FREERTOS)
+  TaskHandle_t _tasks[Workers];
+  WorkerArg _self[Workers];
+  std::atomic<uint32_t> _live{0}; // 아직 workerLoop 안에 있는 작업 태스크 비트.
+#else
+  std::thread _threads[Workers];
+  Doorbell _bells[Workers];
+#endif
+  std::atomic<bool> _stop{false};
+  // 작업 태스크마다 자기 칸만 올리고 getExecuted()는 다른 태스크에서 읽는다. 개수만 맞으면 되니 relaxed.
+  std::atomic<uint32_t> _executed[Workers];
+  uint8_t _affinity[EXECUTOR_AFFINITY_ACTIONS];
+  ActionHandler _handler = nullptr;
+  void* _ctx = nullptr;
+  std::atomic<uint32_t> _idle; // 자고 있는 작업 태스크 비트.
+  std::atomic<uint32_t> _next; // 다 바쁠 때 깨울 차례.
+
+  UniversalQueue<ActionJob>& lane(size_t index) {
+    return *reinterpret_cast<UniversalQueue<ActionJob>*>(&_storage[index]);
+  }
+
+  // 고정된 액션이면 그 작업 태스크, key가 있으면 key로 나눈 작업 태스크, 아니면 공용 큐.
+  uint8_t route(uint8_t key, int8_t action) {
+    uint8_t a = getAffinity(action);
+    if (a != EXECUTOR_ANY_WORKER) return a;
+    if (key == EXECUTOR_ANY_KEY) return EXECUTOR_ANY_WORKER;
+    return static_cast<uint8_t>(key % Workers);
+  }
+
+  // 공용 큐 작업은 자고 있는 작업 태스크를 깨운다. 다 바쁘면 돌아가면서 하나. 어차피 먼저 끝난 쪽이 가져간다.
+  uint8_t pickIdle() {
+    uint32_t idle = _idle.load(std::memory_order_acquire);
+    if (idle) return static_cast<uint8_t>(__builtin_ctz(idle));
+    return static_cast<uint8_t>(_next.fetch_add(1, std::memory_order_relaxed) % Workers);
+  }
+
+#if defined(USE_FREERTOS)
+  void wake(uint8_t worker) {
+    if (_tasks[worker]) xTaskNotifyGive(_tasks[worker]);
+  }
+
+  // FreeRTOS 태스크 함수는 돌아가면 안 된다. 루프를 나오면 소멸자에 알리고 스스로 지운다.
+  static void workerEntry(void* arg) {
+    WorkerArg* self = static_cast<WorkerArg*>(arg);
+    ActionExecutor* owner = self->owner;
+    uint8_t index = self->index;
+    owner->workerLoop(index);
+    owner->_live.fetch_and(~(1UL << index), std::memory_order_release); // 이 뒤로 owner를 만지지 않는다.
+    vTaskDelete(nullptr);
+  }
+
+  // 소멸자의 알림도 여기서 깨운다.
+  void sleep(uint8_t) { ulTaskNotifyTake(pdTRUE, portMAX_DELAY); }
+#else
+  void wake(uint8_t worker) {
+    Doorbell& bell = _bells[worker];
+    {
+      std::lock_guard<std::mutex> lock(bell.mutex);
+      ++bell.count;
+    }
+    bell.cv.notify_one();
+  }
+
+  void sleep(uint8_t worker) {
+    Doorbell& bell = _bells[worker];
+    std::unique_lock<std::mutex> lock(bell.mutex);
+    bell.cv.wait(lock, [&] { return bell.count > 0 || _stop; });
+    bell.count = 0;
+  }
+
+#endif
+
+  bool running() { return !_stop; }
+
+  // 전용 큐를 먼저 비우고, 비면 공용 큐에서 가져온다. 둘 다 비면 알림이 올 때까지 잔다.
+  void workerLoop(uint8_t index) {
+    const uint32_t bit = 1UL << index;
+    ActionJob job;
+    while (running()) {
+      while (lane(index).pop(job, 0) || _shared.pop(job, 0)) {
+        job.handler(job.key, job.action, job.repeat, job.ctx);
+        _executed[index].fetch_add(1, std::memory_order_relaxed);
+      }
+      _idle.fetch_or(bit, std::memory_order_release);
+      // 잠들기 직전에 들어온 공용 작업은 다른 작업 태스크를 깨웠을 수 있으니 한 번 더 본다.
+      if (_shared.isEmpty() && lane(index).isEmpty()) sleep(index);
+      _idle.fetch_and(~bit, std::memory_order_release);
+    }
+  }
+};
+#endif
+
 #endif //UNIVERSALQUEUE_H
 
 // 추가설명 (중요 포인트)